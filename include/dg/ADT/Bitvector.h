@@ -24,15 +24,9 @@ class SparseBitvectorImpl {
     static ShiftT _shift(IndexT i) { return i - (i % BITS_IN_BUCKET); }
 
     static size_t _countBits(BitsT bits) {
-        size_t num = 0;
-        while (bits) {
-            if (bits & 0x1)
-                ++num;
-
-            bits = bits >> 1;
-        }
-
-        return num;
+        static_assert(sizeof(BitsT) <= sizeof(unsigned long long),
+                      "Unsupported type of bits");
+        return __builtin_popcountll(bits);
     }
 
     void _addBit(IndexT i) {
@@ -0,0 +1,480 @@
+#ifndef DG_CHUNKED_BITVECTOR_H_
+#define DG_CHUNKED_BITVECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace dg {
+namespace ADT {
+
+// Sparse bitvector that keeps its bits in 256-bit blocks stored
+// in a flat vector sorted by the keys of the blocks (the keys are in
+// a parallel vector). Set operations are merge loops over the keys
+// and the blocks are processed a whole at once (using AVX2
+// if the code is compiled with it).
+// There are no empty blocks in the bitvector.
+template <typename IndexT = uint64_t>
+class ChunkedBitvector {
+    static const size_t BITS_IN_WORD = 64;
+    static const size_t WORDS_IN_BLOCK = 4;
+    static const size_t BITS_IN_BLOCK = BITS_IN_WORD * WORDS_IN_BLOCK;
+
+    struct Block {
+        uint64_t words[WORDS_IN_BLOCK]{};
+    };
+
+    std::vector<IndexT> _keys{};
+    std::vector<Block> _blocks{};
+
+    static IndexT _key(IndexT i) { return i / BITS_IN_BLOCK; }
+    static size_t _pos(IndexT i) { return i % BITS_IN_BLOCK; }
+
+    static uint64_t &_word(Block &B, size_t pos) {
+        return B.words[pos / BITS_IN_WORD];
+    }
+    static uint64_t _word(const Block &B, size_t pos) {
+        return B.words[pos / BITS_IN_WORD];
+    }
+    static uint64_t _mask(size_t pos) {
+        return uint64_t{1} << (pos % BITS_IN_WORD);
+    }
+
+#ifdef __AVX2__
+    static __m256i _load(const Block &B) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(B.words));
+    }
+
+    static void _store(Block &B, __m256i v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(B.words), v);
+    }
+
+    // the number of bits in every 64-bit lane of v (Mula's algorithm)
+    static __m256i _countBitsInLanes(__m256i v) {
+        const __m256i lookup =
+                _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3,
+                                 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3,
+                                 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0f);
+        auto lo = _mm256_and_si256(v, low);
+        auto hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+        auto cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                   _mm256_shuffle_epi8(lookup, hi));
+        return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+    }
+
+    // A |= B, return true if A changed
+    static bool _unite(Block &A, const Block &B) {
+        auto a = _load(A);
+        auto b = _load(B);
+        // B is a subset of A
+        if (_mm256_testc_si256(a, b))
+            return false;
+        _store(A, _mm256_or_si256(a, b));
+        return true;
+    }
+
+    // A &= B, return true if A changed
+    static bool _intersect(Block &A, const Block &B) {
+        auto a = _load(A);
+        auto b = _load(B);
+        // A is a subset of B
+        if (_mm256_testc_si256(b, a))
+            return false;
+        _store(A, _mm256_and_si256(a, b));
+        return true;
+    }
+
+    static bool _isSubset(const Block &A, const Block &B) {
+        return _mm256_testc_si256(_load(B), _load(A));
+    }
+
+    static bool _isEmpty(const Block &A) {
+        auto a = _load(A);
+        return _mm256_testz_si256(a, a);
+    }
+
+    static bool _isEqual(const Block &A, const Block &B) {
+        auto x = _mm256_xor_si256(_load(A), _load(B));
+        return _mm256_testz_si256(x, x);
+    }
+#else
+    static bool _unite(Block &A, const Block &B) {
+        uint64_t changed = 0;
+        for (size_t w = 0; w < WORDS_IN_BLOCK; ++w) {
+            changed |= B.words[w] & ~A.words[w];
+            A.words[w] |= B.words[w];
+        }
+        return changed != 0;
+    }
+
+    static bool _intersect(Block &A, const Block &B) {
+        uint64_t changed = 0;
+        for (size_t w = 0; w < WORDS_IN_BLOCK; ++w) {
+            changed |= A.words[w] & ~B.words[w];
+            A.words[w] &= B.words[w];
+        }
+        return changed != 0;
+    }
+
+    static bool _isSubset(const Block &A, const Block &B) {
+        uint64_t rest = 0;
+        for (size_t w = 0; w < WORDS_IN_BLOCK; ++w)
+            rest |= A.words[w] & ~B.words[w];
+        return rest == 0;
+    }
+
+    static bool _isEmpty(const Block &A) {
+        uint64_t bits = 0;
+        for (size_t w = 0; w < WORDS_IN_BLOCK; ++w)
+            bits |= A.words[w];
+        return bits == 0;
+    }
+
+    static bool _isEqual(const Block &A, const Block &B) {
+        uint64_t diff = 0;
+        for (size_t w = 0; w < WORDS_IN_BLOCK; ++w)
+            diff |= A.words[w] ^ B.words[w];
+        return diff == 0;
+    }
+#endif // __AVX2__
+
+    // the position of the block with the key or of the first block
+    // with a greater key
+    size_t _lowerBound(IndexT key) const {
+        return std::lower_bound(_keys.begin(), _keys.end(), key) -
+               _keys.begin();
+    }
+
+    // the same as above, but search only from the position 'from'
+    // and use exponential search, which is fast if the key is near
+    // (sets of different sizes are merged)
+    static size_t _seek(const std::vector<IndexT> &keys, size_t from,
+                        IndexT key) {
+        size_t hi = from;
+        size_t step = 1;
+        while (hi < keys.size() && keys[hi] < key) {
+            from = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        auto end = keys.begin() + (hi < keys.size() ? hi : keys.size());
+        return std::lower_bound(keys.begin() + from, end, key) - keys.begin();
+    }
+
+    // the position of the first block with a greater key than 'key'
+    // among the blocks before the position 'to' (exponential search
+    // backwards from 'to')
+    static size_t _seekBack(const std::vector<IndexT> &keys, size_t to,
+                            IndexT key) {
+        size_t lo = to;
+        size_t hi = to;
+        size_t step = 1;
+        while (lo > 0 && keys[lo - 1] > key) {
+            hi = lo - 1;
+            lo = hi > step ? hi - step : 0;
+            step *= 2;
+        }
+        return std::upper_bound(keys.begin() + lo, keys.begin() + hi, key) -
+               keys.begin();
+    }
+
+    void _erase(size_t idx) {
+        _keys.erase(_keys.begin() + idx);
+        _blocks.erase(_blocks.begin() + idx);
+    }
+
+  public:
+    ChunkedBitvector() = default;
+    ChunkedBitvector(IndexT i) { set(i); } // singleton ctor
+
+    ChunkedBitvector(const ChunkedBitvector &) = default;
+    ChunkedBitvector(ChunkedBitvector &&) = default;
+    ChunkedBitvector &operator=(const ChunkedBitvector &) = default;
+    ChunkedBitvector &operator=(ChunkedBitvector &&) = default;
+
+    void reset() {
+        _keys.clear();
+        _blocks.clear();
+    }
+
+    bool empty() const { return _keys.empty(); }
+
+    void swap(ChunkedBitvector &oth) {
+        _keys.swap(oth._keys);
+        _blocks.swap(oth._blocks);
+    }
+
+    // reserve space for n bits (in the worst case,
+    // every bit is in a different block)
+    void reserve(size_t n) {
+        _keys.reserve(n);
+        _blocks.reserve(n);
+    }
+
+    bool get(IndexT i) const {
+        auto key = _key(i);
+        auto idx = _lowerBound(key);
+        if (idx == _keys.size() || _keys[idx] != key)
+            return false;
+
+        return _word(_blocks[idx], _pos(i)) & _mask(_pos(i));
+    }
+
+    // returns the previous value of the i-th bit
+    bool set(IndexT i) {
+        auto key = _key(i);
+        auto idx = _lowerBound(key);
+        if (idx == _keys.size() || _keys[idx] != key) {
+            _keys.insert(_keys.begin() + idx, key);
+            _blocks.insert(_blocks.begin() + idx, Block());
+        }
+
+        auto &W = _word(_blocks[idx], _pos(i));
+        bool prev = W & _mask(_pos(i));
+        W |= _mask(_pos(i));
+
+        return prev;
+    }
+
+    // union operation, returns true if this bitvector changed
+    bool set(const ChunkedBitvector &rhs) {
+        if (rhs.empty())
+            return false;
+        if (empty()) {
+            *this = rhs;
+            return true;
+        }
+
+        // count the blocks that we do not have
+        size_t missing = 0;
+        size_t i = 0;
+        for (auto key : rhs._keys) {
+            i = _seek(_keys, i, key);
+            if (i == _keys.size() || _keys[i] != key)
+                ++missing;
+        }
+
+        if (missing == 0) {
+            bool changed = false;
+            i = 0;
+            for (size_t j = 0; j < rhs._keys.size(); ++j) {
+                i = _seek(_keys, i, rhs._keys[j]);
+                changed |= _unite(_blocks[i], rhs._blocks[j]);
+            }
+            return changed;
+        }
+
+        // merge from the back so that we do not need any temporary
+        // storage and every our block is moved at most once
+        bool changed = true;
+        i = _keys.size();
+        size_t k = i + missing;
+        _keys.resize(k);
+        _blocks.resize(k);
+        for (size_t j = rhs._keys.size(); j > 0;) {
+            --j;
+            auto key = rhs._keys[j];
+            // move our blocks with greater keys to their place
+            auto p = _seekBack(_keys, i, key);
+            if (k != i) {
+                std::copy_backward(_keys.begin() + p, _keys.begin() + i,
+                                   _keys.begin() + k);
+                std::copy_backward(_blocks.begin() + p, _blocks.begin() + i,
+                                   _blocks.begin() + k);
+            }
+            k -= i - p;
+            i = p;
+
+            --k;
+            if (i > 0 && _keys[i - 1] == key) {
+                --i;
+                _keys[k] = _keys[i];
+                _blocks[k] = _blocks[i];
+                changed |= _unite(_blocks[k], rhs._blocks[j]);
+            } else {
+                _keys[k] = key;
+                _blocks[k] = rhs._blocks[j];
+            }
+        }
+        assert(k == i && "Merging went wrong");
+
+        return changed;
+    }
+
+    // intersection operation, returns true if this bitvector changed
+    bool intersect(const ChunkedBitvector &rhs) {
+        bool changed = false;
+        size_t k = 0;
+        size_t j = 0;
+        for (size_t i = 0; i < _keys.size(); ++i) {
+            j = _seek(rhs._keys, j, _keys[i]);
+            if (j == rhs._keys.size() || rhs._keys[j] != _keys[i]) {
+                changed = true;
+                continue;
+            }
+
+            auto B = _blocks[i];
+            changed |= _intersect(B, rhs._blocks[j]);
+            if (_isEmpty(B))
+                continue;
+
+            _keys[k] = _keys[i];
+            _blocks[k] = B;
+            ++k;
+        }
+
+        _keys.resize(k);
+        _blocks.resize(k);
+        return changed;
+    }
+
+    bool isSubsetOf(const ChunkedBitvector &rhs) const {
+        if (_keys.size() > rhs._keys.size())
+            return false;
+
+        size_t j = 0;
+        for (size_t i = 0; i < _keys.size(); ++i) {
+            j = _seek(rhs._keys, j, _keys[i]);
+            if (j == rhs._keys.size() || rhs._keys[j] != _keys[i] ||
+                !_isSubset(_blocks[i], rhs._blocks[j]))
+                return false;
+        }
+        return true;
+    }
+
+    // returns the previous value of the i-th bit
+    bool unset(IndexT i) {
+        auto key = _key(i);
+        auto idx = _lowerBound(key);
+        if (idx == _keys.size() || _keys[idx] != key) {
+            assert(get(i) == 0);
+            return false;
+        }
+
+        auto &W = _word(_blocks[idx], _pos(i));
+        bool prev = W & _mask(_pos(i));
+        W &= ~_mask(_pos(i));
+        if (_isEmpty(_blocks[idx]))
+            _erase(idx);
+
+        assert(get(i) == 0 && "Failed removing");
+        return prev;
+    }
+
+    size_t size() const {
+#ifdef __AVX2__
+        auto acc = _mm256_setzero_si256();
+        for (const auto &B : _blocks)
+            acc = _mm256_add_epi64(acc, _countBitsInLanes(_load(B)));
+        return _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+               _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+#else
+        size_t num = 0;
+        for (const auto &B : _blocks) {
+            for (auto w : B.words) {
+                if (w != 0)
+                    num += __builtin_popcountll(w);
+            }
+        }
+        return num;
+#endif
+    }
+
+    bool operator==(const ChunkedBitvector &rhs) const {
+        if (_keys != rhs._keys)
+            return false;
+        for (size_t i = 0; i < _blocks.size(); ++i) {
+            if (!_isEqual(_blocks[i], rhs._blocks[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const ChunkedBitvector &rhs) const {
+        return !operator==(rhs);
+    }
+
+    class const_iterator {
+        const ChunkedBitvector *bv{nullptr};
+        size_t blk{0};
+        size_t pos{0};
+
+        const_iterator(const ChunkedBitvector &b, bool end = false)
+                : bv(&b), blk(end ? b._blocks.size() : 0) {
+            // set-up the initial position
+            if (!end && !b.empty())
+                _findClosestBit();
+        }
+
+        // find the first set bit on the position pos or greater
+        // in the current block (there is one as blocks are not empty)
+        void _findClosestBit() {
+            const auto &B = bv->_blocks[blk];
+            auto w = pos / BITS_IN_WORD;
+            auto bits = B.words[w] & (~uint64_t{0} << (pos % BITS_IN_WORD));
+            while (bits == 0) {
+                if (++w == WORDS_IN_BLOCK) {
+                    pos = BITS_IN_BLOCK;
+                    return;
+                }
+                bits = B.words[w];
+            }
+            pos = w * BITS_IN_WORD + __builtin_ctzll(bits);
+        }
+
+      public:
+        const_iterator() = default;
+        const_iterator &operator++() {
+            assert(bv && blk < bv->_blocks.size() &&
+                   "operator++ called on end");
+            if (++pos != BITS_IN_BLOCK)
+                _findClosestBit();
+
+            if (pos == BITS_IN_BLOCK) {
+                pos = 0;
+                if (++blk != bv->_blocks.size())
+                    _findClosestBit();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        IndexT operator*() const {
+            return bv->_keys[blk] * BITS_IN_BLOCK + pos;
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return pos == rhs.pos && blk == rhs.blk;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class ChunkedBitvector;
+    };
+
+    const_iterator begin() const { return const_iterator(*this); }
+    const_iterator end() const {
+        return const_iterator(*this, true /* end */);
+    }
+
+    friend class const_iterator;
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_CHUNKED_BITVECTOR_H_
@@ -125,6 +125,18 @@ class DisjunctiveIntervalMap {
         return changed;
     }
 
+    // replace the value 'old' by 'val' in all intervals
+    bool replace(const ValueT &old, const ValueT &val) {
+        bool changed = false;
+        for (auto &it : _mapping) {
+            if (it.second.erase(old) > 0) {
+                it.second.insert(val);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
     // return true if some intervals from the map
     // has a overlap with I
     bool overlaps(const IntervalT &I) const {
@@ -269,6 +281,11 @@ class DisjunctiveIntervalMap {
 
         while (true) {
             assert(cur.start <= it->first.start);
+            // the rest of the interval is not covered
+            if (it->first.start > I.end) {
+                ret.push_back(cur);
+                break;
+            }
             if (cur.start != it->first.start && cur.start < it->first.start) {
                 assert(it->first.start != 0 && "Underflow");
                 ret.push_back(IntervalT{cur.start, it->first.start - 1});
@@ -0,0 +1,474 @@
+#ifndef DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+#define DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <set>
+#include <utility>
+#include <vector>
+
+#ifndef NDEBUG
+#include <iostream>
+#endif
+
+#include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/Offset.h"
+
+namespace dg {
+namespace ADT {
+
+///
+// A set of values stored in a sorted vector. It is meant
+// for small sets that are often copied and merged.
+template <typename T>
+class SortedVectorSet {
+    std::vector<T> _values;
+
+  public:
+    using value_type = T;
+    using iterator = typename std::vector<T>::const_iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SortedVectorSet() = default;
+    SortedVectorSet(std::initializer_list<T> il) {
+        for (const T &v : il)
+            insert(v);
+    }
+
+    std::pair<iterator, bool> insert(const T &v) {
+        auto it = std::lower_bound(_values.begin(), _values.end(), v);
+        if (it != _values.end() && *it == v)
+            return {it, false};
+        return {_values.insert(it, v), true};
+    }
+
+    // for std::inserter
+    iterator insert(iterator /* hint */, const T &v) { return insert(v).first; }
+
+    template <typename IT>
+    void insert(IT b, IT e) {
+        for (IT it = b; it != e; ++it)
+            insert(*it);
+    }
+
+    // merge the values from 'rhs', return true if some value was added
+    bool merge(const SortedVectorSet &rhs) {
+        if (rhs.empty())
+            return false;
+        if (std::includes(_values.begin(), _values.end(), rhs._values.begin(),
+                          rhs._values.end()))
+            return false;
+
+        std::vector<T> tmp;
+        tmp.reserve(_values.size() + rhs._values.size());
+        std::set_union(_values.begin(), _values.end(), rhs._values.begin(),
+                       rhs._values.end(), std::back_inserter(tmp));
+        _values.swap(tmp);
+        return true;
+    }
+
+    iterator find(const T &v) const {
+        auto it = std::lower_bound(_values.begin(), _values.end(), v);
+        if (it != _values.end() && *it == v)
+            return it;
+        return _values.end();
+    }
+
+    size_t count(const T &v) const { return find(v) != end() ? 1 : 0; }
+
+    size_t erase(const T &v) {
+        auto it = std::lower_bound(_values.begin(), _values.end(), v);
+        if (it == _values.end() || *it != v)
+            return 0;
+        _values.erase(it);
+        return 1;
+    }
+
+    void clear() { _values.clear(); }
+    bool empty() const { return _values.empty(); }
+    size_t size() const { return _values.size(); }
+
+    const_iterator begin() const { return _values.begin(); }
+    const_iterator end() const { return _values.end(); }
+
+    bool operator==(const SortedVectorSet &rhs) const {
+        return _values == rhs._values;
+    }
+    bool operator!=(const SortedVectorSet &rhs) const {
+        return _values != rhs._values;
+    }
+};
+
+///
+// Mapping of disjunctive discrete intervals of values to sets of ValueT,
+// with the same interface as DisjunctiveIntervalMap. The intervals are
+// kept in a vector sorted by their start and the sets of values are
+// sorted vectors. Copying such a map is a copy of a few contiguous
+// arrays, which makes it faster than DisjunctiveIntervalMap for the small
+// maps that are copied and merged all the time (e.g., the definitions
+// in the data dependence analysis). On the other hand, adding a new
+// interval into a big map is linear in the size of the map.
+template <typename ValueT, typename IntervalValueT = Offset>
+class FlatDisjunctiveIntervalMap {
+  public:
+    using IntervalT = DiscreteInterval<IntervalValueT>;
+    using ValuesT = SortedVectorSet<ValueT>;
+    using MappingT = std::vector<std::pair<IntervalT, ValuesT>>;
+    using iterator = typename MappingT::iterator;
+    using const_iterator = typename MappingT::const_iterator;
+
+    ///
+    // Return true if the mapping is updated anyhow
+    // (intervals split, value added).
+    bool add(const IntervalValueT start, const IntervalValueT end,
+             const ValueT &val) {
+        return add(IntervalT(start, end), val);
+    }
+
+    bool add(const IntervalT &I, const ValueT &val) {
+        return _add(I, ValuesT{val}, false);
+    }
+
+    bool add(const IntervalT &I, const ValuesT &vals) {
+        return _add(I, vals, false);
+    }
+
+    template <typename ContT>
+    bool add(const IntervalT &I, const ContT &vals) {
+        ValuesT tmp;
+        tmp.insert(std::begin(vals), std::end(vals));
+        return _add(I, tmp, false);
+    }
+
+    bool update(const IntervalValueT start, const IntervalValueT end,
+                const ValueT &val) {
+        return update(IntervalT(start, end), val);
+    }
+
+    bool update(const IntervalT &I, const ValueT &val) {
+        return _add(I, ValuesT{val}, true);
+    }
+
+    // the same semantics as DisjunctiveIntervalMap::update
+    // (every value rewrites the previous one)
+    template <typename ContT>
+    bool update(const IntervalT &I, const ContT &vals) {
+        bool changed = false;
+        for (const ValueT &val : vals) {
+            changed |= update(I, val);
+        }
+        return changed;
+    }
+
+    // add the value 'val' to all intervals
+    bool addAll(const ValueT &val) {
+        bool changed = false;
+        for (auto &it : _mapping) {
+            changed |= it.second.insert(val).second;
+        }
+        return changed;
+    }
+
+    // replace the value 'old' by 'val' in all intervals
+    bool replace(const ValueT &old, const ValueT &val) {
+        bool changed = false;
+        for (auto &it : _mapping) {
+            if (it.second.erase(old) > 0) {
+                it.second.insert(val);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // return true if some intervals from the map
+    // has a overlap with I
+    bool overlaps(const IntervalT &I) const { return le(I) != end(); }
+
+    bool overlaps(IntervalValueT start, IntervalValueT end) const {
+        return overlaps(IntervalT(start, end));
+    }
+
+    // return true if the map has an entry for
+    // each single byte from the interval I
+    bool overlapsFull(const IntervalT &I) const {
+        auto it = le(I);
+        if (it == end() || it->first.start > I.start)
+            return false;
+
+        while (it->first.end < I.end) {
+            auto last_end = it->first.end;
+            ++it;
+            if (it == end() || it->first.start != last_end + 1)
+                return false;
+        }
+        return true;
+    }
+
+    bool overlapsFull(IntervalValueT start, IntervalValueT end) const {
+        return overlapsFull(IntervalT(start, end));
+    }
+
+    FlatDisjunctiveIntervalMap
+    intersection(const FlatDisjunctiveIntervalMap &rhs) const {
+        FlatDisjunctiveIntervalMap tmp;
+        auto it = _mapping.begin();
+        auto rhsit = rhs._mapping.begin();
+        while (it != _mapping.end() && rhsit != rhs._mapping.end()) {
+            if (it->first.end < rhsit->first.start) {
+                ++it;
+                continue;
+            }
+            if (rhsit->first.end < it->first.start) {
+                ++rhsit;
+                continue;
+            }
+
+            ValuesT vals;
+            std::set_intersection(it->second.begin(), it->second.end(),
+                                  rhsit->second.begin(), rhsit->second.end(),
+                                  std::inserter(vals, vals.end()));
+            if (!vals.empty()) {
+                // the intervals are disjunctive and sorted,
+                // so we can just append the new interval
+                tmp._mapping.emplace_back(
+                        IntervalT{std::max(it->first.start,
+                                           rhsit->first.start),
+                                  std::min(it->first.end, rhsit->first.end)},
+                        std::move(vals));
+            }
+
+            if (it->first.end < rhsit->first.end)
+                ++it;
+            else
+                ++rhsit;
+        }
+        return tmp;
+    }
+
+    ///
+    // Gather all values that are covered by the interval I
+    std::set<ValueT> gather(IntervalValueT start, IntervalValueT end) const {
+        return gather(IntervalT(start, end));
+    }
+
+    std::set<ValueT> gather(const IntervalT &I) const {
+        std::set<ValueT> ret;
+        for (auto it = le(I); it != end() && it->first.start <= I.end; ++it) {
+            ret.insert(it->second.begin(), it->second.end());
+        }
+        return ret;
+    }
+
+    std::vector<IntervalT> uncovered(IntervalValueT start,
+                                     IntervalValueT end) const {
+        return uncovered(IntervalT(start, end));
+    }
+
+    std::vector<IntervalT> uncovered(const IntervalT &I) const {
+        std::vector<IntervalT> ret;
+        IntervalValueT cur = I.start;
+        for (auto it = le(I); it != end() && it->first.start <= I.end; ++it) {
+            if (cur < it->first.start) {
+                ret.emplace_back(cur, it->first.start - 1);
+            }
+            if (it->first.end >= I.end)
+                return ret;
+            cur = it->first.end + 1;
+        }
+
+        ret.emplace_back(cur, I.end);
+        return ret;
+    }
+
+    bool empty() const { return _mapping.empty(); }
+    size_t size() const { return _mapping.size(); }
+
+    iterator begin() { return _mapping.begin(); }
+    const_iterator begin() const { return _mapping.begin(); }
+    iterator end() { return _mapping.end(); }
+    const_iterator end() const { return _mapping.end(); }
+
+    bool operator==(const FlatDisjunctiveIntervalMap &rhs) const {
+        return _mapping == rhs._mapping;
+    }
+
+    // return the iterator to an element that is the first
+    // that overlaps the interval I or end() if there is
+    // no such interval
+    iterator le(const IntervalT &I) {
+        auto it = _find_end_ge(I.start);
+        if (it != _mapping.end() && it->first.start > I.end)
+            return _mapping.end();
+        return it;
+    }
+
+    const_iterator le(const IntervalT &I) const {
+        auto it = _find_end_ge(I.start);
+        if (it != _mapping.end() && it->first.start > I.end)
+            return _mapping.end();
+        return it;
+    }
+
+    iterator le(const IntervalValueT start, const IntervalValueT end) {
+        return le(IntervalT(start, end));
+    }
+
+    const_iterator le(const IntervalValueT start,
+                      const IntervalValueT end) const {
+        return le(IntervalT(start, end));
+    }
+
+#ifndef NDEBUG
+    friend std::ostream &
+    operator<<(std::ostream &os, const FlatDisjunctiveIntervalMap &map) {
+        os << "{";
+        for (const auto &pair : map) {
+            if (pair.second.empty())
+                continue;
+
+            os << "{ ";
+            os << pair.first.start << "-" << pair.first.end;
+            os << ": " << *pair.second.begin();
+            os << " }, ";
+        }
+        os << "}";
+        return os;
+    }
+
+    void dump() const { std::cout << *this << "\n"; }
+#endif
+
+  private:
+    // the first interval that ends at 'v' or later
+    // (the intervals are disjunctive, so the ends are sorted too)
+    iterator _find_end_ge(IntervalValueT v) {
+        return std::lower_bound(
+                _mapping.begin(), _mapping.end(), v,
+                [](const typename MappingT::value_type &it,
+                   IntervalValueT val) { return it.first.end < val; });
+    }
+
+    const_iterator _find_end_ge(IntervalValueT v) const {
+        return std::lower_bound(
+                _mapping.begin(), _mapping.end(), v,
+                [](const typename MappingT::value_type &it,
+                   IntervalValueT val) { return it.first.end < val; });
+    }
+
+    static bool _addValues(ValuesT &to, const ValuesT &vals, bool update) {
+        if (update) {
+            if (to == vals)
+                return false;
+            to = vals;
+            return true;
+        }
+        return to.merge(vals);
+    }
+
+    // If the boolean 'update' is set to true, the values
+    // are not added, but rewritten
+    bool _add(const IntervalT &I, const ValuesT &vals, bool update) {
+        if (vals.empty())
+            return false;
+
+        auto first = _find_end_ge(I.start);
+        // fast path -- the interval is already in the map
+        if (first != _mapping.end() && first->first == I) {
+            return _addValues(first->second, vals, update);
+        }
+
+        auto last = first;
+        while (last != _mapping.end() && last->first.start <= I.end)
+            ++last;
+
+        // we do not have any overlapping interval
+        if (first == last) {
+            _mapping.emplace(first, I, vals);
+            _check();
+            return true;
+        }
+
+        // create the intervals that replace the overlapping intervals
+        // [first, last): the parts of the overlapping intervals outside
+        // of I keep their values, the parts inside of I get the new
+        // values and the gaps in I get the new values only
+        MappingT replacement;
+        IntervalValueT cur = I.start;
+        bool done = false;
+        bool changed = false;
+        for (auto it = first; it != last; ++it) {
+            const auto &interval = it->first;
+            if (interval.start < cur) {
+                assert(it == first && cur == I.start);
+                // (do not use 'cur - 1', Offset::operator- on non-const
+                // object modifies the object)
+                replacement.emplace_back(IntervalT(interval.start, I.start - 1),
+                                         it->second);
+                changed = true;
+            } else if (cur < interval.start) {
+                replacement.emplace_back(IntervalT(cur, interval.start - 1),
+                                         vals);
+                changed = true;
+            }
+
+            auto inner_end = std::min(interval.end, I.end);
+            replacement.emplace_back(
+                    IntervalT(std::max(interval.start, cur), inner_end),
+                    it->second);
+            changed |= _addValues(replacement.back().second, vals, update);
+
+            if (interval.end > I.end) {
+                assert(std::next(it) == last);
+                replacement.emplace_back(IntervalT(I.end + 1, interval.end),
+                                         it->second);
+                changed = true;
+            }
+
+            if (inner_end == I.end) {
+                done = true;
+            } else {
+                cur = inner_end + 1;
+            }
+        }
+
+        // our interval spans to the right
+        // after the last covered interval
+        if (!done) {
+            replacement.emplace_back(IntervalT(cur, I.end), vals);
+            changed = true;
+        }
+
+        // replace [first, last) with the new intervals
+        // (every overlapping interval got at least one new interval)
+        auto num = last - first;
+        assert(replacement.size() >= static_cast<size_t>(num));
+        std::move(replacement.begin(), replacement.begin() + num, first);
+        _mapping.insert(last, std::make_move_iterator(replacement.begin() + num),
+                        std::make_move_iterator(replacement.end()));
+
+        _check();
+        return changed;
+    }
+
+    void _check() const {
+#ifndef NDEBUG
+        // check that the keys are disjunctive and sorted
+        for (size_t i = 0; i < _mapping.size(); ++i) {
+            assert(_mapping[i].first.start <= _mapping[i].first.end);
+            assert(!_mapping[i].second.empty());
+            assert(i == 0 ||
+                   _mapping[i - 1].first.end < _mapping[i].first.start);
+        }
+#endif // NDEBUG
+    }
+
+    MappingT _mapping;
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
@@ -0,0 +1,179 @@
+#ifndef DG_FROZEN_EDGES_H_
+#define DG_FROZEN_EDGES_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "dg/ADT/DGContainer.h"
+
+namespace dg {
+
+// kinds of edges that every node of a dependence graph has
+enum EdgesKind {
+    EDGES_CONTROL = 0,
+    EDGES_REV_CONTROL,
+    EDGES_DATA,
+    EDGES_REV_DATA,
+    EDGES_USE,
+    EDGES_USER,
+    EDGES_INTERFERENCE,
+    EDGES_REV_INTERFERENCE,
+    EDGES_KINDS_NUM
+};
+
+///
+// Iterator over edges of one kind of a node. The edges are either
+// in the node's EdgesContainer or in a contiguous array in FrozenEdges.
+template <typename NodeT>
+class EdgesIterator {
+    using ContainerIterator = typename EdgesContainer<NodeT>::const_iterator;
+
+    ContainerIterator _it{};
+    NodeT *const *_ptr{nullptr};
+    bool _frozen{false};
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = NodeT *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = NodeT *const *;
+    using reference = NodeT *const &;
+
+    EdgesIterator() = default;
+    EdgesIterator(ContainerIterator it) : _it(it) {}
+    EdgesIterator(NodeT *const *ptr) : _ptr(ptr), _frozen(true) {}
+
+    reference operator*() const { return _frozen ? *_ptr : *_it; }
+    pointer operator->() const { return &operator*(); }
+
+    EdgesIterator &operator++() {
+        if (_frozen)
+            ++_ptr;
+        else
+            ++_it;
+        return *this;
+    }
+
+    EdgesIterator operator++(int) {
+        auto tmp = *this;
+        operator++();
+        return tmp;
+    }
+
+    bool operator==(const EdgesIterator &rhs) const {
+        assert(_frozen == rhs._frozen && "Compared iterators of other edges");
+        return _frozen ? _ptr == rhs._ptr : _it == rhs._it;
+    }
+
+    bool operator!=(const EdgesIterator &rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+///
+// Edges of nodes stored in the compressed sparse row (CSR) format.
+//
+// The nodes get dense IDs and the edges of the kind 'k' of the node
+// with ID 'i' are the row 'i * EDGES_KINDS_NUM + k'. The rows are
+// sorted the same way as EdgesContainer and lie in one array, so
+// iterating over them does not chase pointers of a tree.
+// Removing an edge shrinks its row in place (the rows never grow,
+// the node moves the row back to its EdgesContainer when it gets
+// a new edge of that kind). See Node::freeze().
+template <typename NodeT>
+class FrozenEdges {
+    std::vector<NodeT *> _edges;
+    // the row 'r' is _edges[_begins[r]], ..., _edges[_ends[r] - 1]
+    std::vector<unsigned> _begins;
+    std::vector<unsigned> _ends;
+
+    static size_t _row(unsigned id, EdgesKind kind) {
+        return static_cast<size_t>(id) * EDGES_KINDS_NUM + kind;
+    }
+
+  public:
+    ///
+    // Store the edges of the given nodes into a new FrozenEdges object
+    // and make the nodes use it instead of their EdgesContainers.
+    // The nodes must not be frozen already. The returned object
+    // must live as long as the nodes have their edges.
+    template <typename ContainerT>
+    static std::shared_ptr<FrozenEdges> freeze(const ContainerT &nodes) {
+        auto frozen = std::make_shared<FrozenEdges>();
+
+        size_t edgesNum = 0;
+        size_t nodesNum = 0;
+        for (NodeT *n : nodes) {
+            ++nodesNum;
+            for (unsigned k = 0; k < EDGES_KINDS_NUM; ++k)
+                edgesNum += n->getEdgesNum(static_cast<EdgesKind>(k));
+        }
+
+        frozen->_edges.reserve(edgesNum);
+        frozen->_begins.reserve(nodesNum * EDGES_KINDS_NUM);
+        frozen->_ends.reserve(nodesNum * EDGES_KINDS_NUM);
+
+        unsigned id = 0;
+        for (NodeT *n : nodes) {
+            assert(!n->isFrozen() && "The node is already frozen");
+            for (unsigned k = 0; k < EDGES_KINDS_NUM; ++k) {
+                auto kind = static_cast<EdgesKind>(k);
+                frozen->_begins.push_back(frozen->_edges.size());
+                frozen->_edges.insert(frozen->_edges.end(),
+                                      n->edges_begin(kind), n->edges_end(kind));
+                frozen->_ends.push_back(frozen->_edges.size());
+            }
+            // release the containers right away,
+            // so that their memory can be reused
+            n->freeze(frozen.get(), id++);
+        }
+
+        return frozen;
+    }
+
+    NodeT *const *begin(unsigned id, EdgesKind kind) const {
+        return _edges.data() + _begins[_row(id, kind)];
+    }
+
+    NodeT *const *end(unsigned id, EdgesKind kind) const {
+        return _edges.data() + _ends[_row(id, kind)];
+    }
+
+    size_t size(unsigned id, EdgesKind kind) const {
+        auto row = _row(id, kind);
+        return _ends[row] - _begins[row];
+    }
+
+    bool contains(unsigned id, EdgesKind kind, NodeT *n) const {
+        return std::binary_search(begin(id, kind), end(id, kind), n,
+                                  std::less<NodeT *>());
+    }
+
+    // remove the edge from the row, takes linear time in the size of the row
+    bool erase(unsigned id, EdgesKind kind, NodeT *n) {
+        auto row = _row(id, kind);
+        auto B = _edges.begin() + _begins[row];
+        auto E = _edges.begin() + _ends[row];
+        auto it = std::lower_bound(B, E, n, std::less<NodeT *>());
+        if (it == E || *it != n)
+            return false;
+
+        std::copy(it + 1, E, it);
+        --_ends[row];
+        return true;
+    }
+
+    void clear(unsigned id, EdgesKind kind) {
+        auto row = _row(id, kind);
+        _ends[row] = _begins[row];
+    }
+};
+
+} // namespace dg
+
+#endif // DG_FROZEN_EDGES_H_
@@ -1,6 +1,8 @@
 #ifndef DG_BBLOCK_BASE_H_
 #define DG_BBLOCK_BASE_H_
 
+#include <algorithm>
+#include <cassert>
 #include <list>
 #include <vector>
 
@@ -70,6 +72,32 @@ class ElemWithEdges {
         s->_predecessors.push_back(static_cast<ElemT *>(this));
     }
 
+    // Remove the element from the graph and connect
+    // its predecessors to its successors
+    void isolate() {
+        auto *self = static_cast<ElemT *>(this);
+        for (auto *pred : _predecessors) {
+            auto &succs = pred->_successors;
+            succs.erase(std::remove(succs.begin(), succs.end(), self),
+                        succs.end());
+        }
+        for (auto *succ : _successors) {
+            auto &preds = succ->_predecessors;
+            preds.erase(std::remove(preds.begin(), preds.end(), self),
+                        preds.end());
+        }
+
+        for (auto *pred : _predecessors) {
+            for (auto *succ : _successors) {
+                assert(succ != self && pred != self && "Self-loop");
+                pred->addSuccessor(succ);
+            }
+        }
+
+        _successors.clear();
+        _predecessors.clear();
+    }
+
     ElemT *getSinglePredecessor() {
         return _predecessors.size() == 1 ? _predecessors.back() : nullptr;
     }
@@ -59,6 +59,17 @@ class DataDependenceAnalysis {
         return _impl->getDefinitions(use);
     }
 
+    // compute reaching definitions of all uses in the block at once
+    void computeDefinitions(RWBBlock *block) {
+        _impl->computeDefinitions(block);
+    }
+
+    // forget the results that depend on the subgraph 'subg'
+    // (call it before the subgraph is built again)
+    void invalidate(RWSubgraph *subg) { _impl->invalidate(subg); }
+    // update the analysis after the subgraph 'subg' has been built again
+    void update(RWSubgraph *subg) { _impl->update(subg); }
+
     const DataDependenceAnalysisOptions &getOptions() const { return _options; }
 
     DataDependenceAnalysisImpl *getImpl() { return _impl.get(); }
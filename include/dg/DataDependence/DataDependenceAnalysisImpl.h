@@ -52,6 +52,16 @@ class DataDependenceAnalysisImpl {
     // return reaching definitions of a node that represents
     // the given use
     virtual std::vector<RWNode *> getDefinitions(RWNode *use) = 0;
+
+    // compute reaching definitions of all uses in the block at once,
+    // getDefinitions() then returns the computed definitions
+    virtual void computeDefinitions(RWBBlock *block) = 0;
+
+    // forget the results that depend on the subgraph 'subg'
+    // (before the subgraph is changed)
+    virtual void invalidate(RWSubgraph *subg) = 0;
+    // update the analysis after the subgraph 'subg' has been changed
+    virtual void update(RWSubgraph *subg) = 0;
 };
 
 } // namespace dda
@@ -115,6 +115,22 @@ struct DataDependenceAnalysisOptions : AnalysisOptions {
     // or just objects?
     bool fieldInsensitive{false};
 
+    // If greater than 1, the definitions of all uses are computed
+    // right after running the analysis using (at most) this number
+    // of threads. Otherwise, the definitions are computed on demand.
+    unsigned ddaThreads{1};
+
+    // Remove the nodes that write only to memory that is never read
+    // from the graph before running the analysis. The removed nodes
+    // cannot be used as the place of queries for definitions and
+    // the queries for the never-read memory miss the removed writes,
+    // so turn this on only if the definitions of uses are queried.
+    bool removeUselessNodes{false};
+
+    // Collect counters and timers of the analysis for every subgraph
+    // (e.g., to find out which procedures make the analysis slow).
+    bool profile{false};
+
     bool undefinedArePure() const { return undefinedFunsBehavior == dda::PURE; }
     bool undefinedFunsWriteAny() const {
         return undefinedFunsBehavior & dda::WRITE_ANY;
@@ -55,6 +55,12 @@ class DependenceGraphBase {
     virtual void setSlice(uint64_t sid) { slice_id = sid; }
 
     uint64_t getSlice() const { return slice_id; }
+
+    // the graph may postpone computing the control dependencies
+    // of its nodes until someone needs them. Walks over the dependencies
+    // (e.g., marking the slice) call this method when they get
+    // to a node of the graph, before following its edges.
+    virtual void computeControlDependenciesOnDemand() {}
 };
 
 // -------------------------------------------------------------------
@@ -43,7 +43,7 @@ struct Definitions {
     ///
     /// get the definition-sites for the given 'ds'
     ///
-    std::set<RWNode *> get(const DefSite &ds) {
+    std::set<RWNode *> get(const DefSite &ds) const {
         auto retval = definitions.get(ds);
         if (retval.empty()) {
             retval.insert(unknownWrites.begin(), unknownWrites.end());
@@ -3,14 +3,17 @@
 
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #ifndef NDEBUG
 #include <iostream>
 #endif
 
 #include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
 #include "dg/Offset.h"
 #include "dg/ReadWriteGraph/DefSite.h"
+#include "dg/util/cow_shared_ptr.h"
 
 namespace dg {
 namespace dda {
@@ -21,14 +24,47 @@ class ReachingDefinitionsAnalysis;
 /// A data structure that represents a mapping
 /// DefSite -> RWNode, that is, it stores which memory (DefSite)
 /// was defined where.
-template <typename NodeT = RWNode>
+/// The mapping of bytes of a target to the nodes is stored in OffsetsMapT,
+/// that is either ADT::FlatDisjunctiveIntervalMap (the default, cheap
+/// to copy and join) or ADT::DisjunctiveIntervalMap.
+///
+/// The maps are copy-on-write: a copy of the map shares the mapping
+/// with the original map and the maps of offsets of single targets
+/// are shared between maps too. They are copied only when modified
+/// while shared (and adding definitions that are already in the map
+/// does not modify it).
+template <typename NodeT = RWNode,
+          typename OffsetsMapT = ADT::FlatDisjunctiveIntervalMap<NodeT *>>
 class DefinitionsMap {
   public:
-    using OffsetsT = ADT::DisjunctiveIntervalMap<NodeT *>;
+    using OffsetsT = OffsetsMapT;
     using IntervalT = typename OffsetsT::IntervalT;
 
   private:
-    std::unordered_map<NodeT *, OffsetsT> _definitions{};
+    using OffsetsPtrT = cow_shared_ptr<OffsetsT>;
+    using MappingT = std::unordered_map<NodeT *, OffsetsPtrT>;
+
+    // nullptr for an empty map
+    cow_shared_ptr<MappingT> _definitions{};
+
+    const MappingT &_mapping() const {
+        static const MappingT empty;
+        return _definitions ? *_definitions : empty;
+    }
+
+    MappingT &_writableMapping() { return *_definitions.getWritable(); }
+
+    OffsetsT &_writableOffsets(NodeT *target) {
+        return *_writableMapping()[target].getWritable();
+    }
+
+    const OffsetsT *_getOffsets(NodeT *target) const {
+        const auto &mapping = _mapping();
+        auto it = mapping.find(target);
+        if (it == mapping.end())
+            return nullptr;
+        return it->second.get();
+    }
 
     // transform (offset, lenght) from a DefSite into the interval
     static std::pair<Offset, Offset> getInterval(const DefSite &ds) {
@@ -40,31 +76,127 @@ class DefinitionsMap {
         return {ds.offset, ds.offset + (ds.len - 1)};
     }
 
+    // check whether all bytes from I are mapped to all the values
+    // from 'vals' (so adding them would not change the map)
+    template <typename ContT>
+    static bool _includes(const OffsetsT &M, const IntervalT &I,
+                          const ContT &vals) {
+        auto it = M.le(I);
+        if (it == M.end() || it->first.start > I.start)
+            return false;
+
+        for (; it != M.end(); ++it) {
+            for (const auto &v : vals) {
+                if (it->second.count(v) == 0)
+                    return false;
+            }
+            if (it->first.end >= I.end)
+                return true;
+
+            auto next = it;
+            ++next;
+            if (next == M.end() || next->first.start != it->first.end + 1)
+                return false;
+        }
+        return false;
+    }
+
+    template <typename ContT>
+    bool _add(NodeT *target, const IntervalT &I, const ContT &vals) {
+        const auto *offsets = _getOffsets(target);
+        if (offsets && _includes(*offsets, I, vals))
+            return false;
+        return _writableOffsets(target).add(I, vals);
+    }
+
+    bool _add(NodeT *target, const OffsetsPtrT &elems) {
+        if (elems->empty())
+            return false;
+
+        const auto *offsets = _getOffsets(target);
+        if (!offsets) {
+            // share the offsets
+            _writableMapping().emplace(target, elems);
+            return true;
+        }
+
+        if (offsets == elems.get())
+            return false;
+
+        bool changed = false;
+        for (const auto &it : *elems)
+            changed |= _add(target, it.first, it.second);
+        return changed;
+    }
+
   public:
-    void clear() { _definitions.clear(); }
+    class const_iterator {
+        typename MappingT::const_iterator _it;
+
+      public:
+        using value_type = std::pair<NodeT *, const OffsetsT &>;
+
+        const_iterator(typename MappingT::const_iterator it) : _it(it) {}
+
+        const_iterator &operator++() {
+            ++_it;
+            return *this;
+        }
+
+        value_type operator*() const { return {_it->first, *_it->second}; }
+
+        bool operator==(const const_iterator &rhs) const {
+            return _it == rhs._it;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return _it != rhs._it;
+        }
+    };
+
+    void clear() { _definitions.reset(); }
     void swap(DefinitionsMap &rhs) { _definitions.swap(rhs._definitions); }
-    bool empty() const { return _definitions.empty(); }
+    bool empty() const { return _mapping().empty(); }
 
     bool add(const DefSite &ds, NodeT *node) {
         // if the offset is unknown, make it 0, so that the
         // definition get stretched over all possible offsets
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return _definitions[ds.target].add(start, end, node);
+        NodeT *vals[] = {node};
+        return _add(ds.target, IntervalT(start, end), vals);
     }
 
     bool addAll(NodeT *node) {
+        // do not copy the shared offsets that already have the node
+        auto hasNode = [node](const OffsetsT &offsets) {
+            for (const auto &it : offsets) {
+                if (it.second.count(node) == 0)
+                    return false;
+            }
+            return true;
+        };
+
         bool changed = false;
-        for (auto &it : _definitions) {
-            changed |= it.second.addAll(node);
+        for (auto &it : _mapping()) {
+            if (!hasNode(*it.second)) {
+                changed = true;
+                break;
+            }
         }
-        return changed;
+        if (!changed)
+            return false;
+
+        for (auto &it : _writableMapping()) {
+            if (!hasNode(*it.second))
+                it.second.getWritable()->addAll(node);
+        }
+        return true;
     }
 
     bool update(const DefSite &ds, NodeT *node) {
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return _definitions[ds.target].update(start, end, node);
+        return _writableOffsets(ds.target).update(start, end, node);
     }
 
     template <typename ContainerT>
@@ -86,18 +218,54 @@ class DefinitionsMap {
     bool add(NodeT *target, const OffsetsT &elems) {
         bool changed = false;
         for (auto &it : elems)
-            changed |= _definitions[target].add(it.first, it.second);
+            changed |= _add(target, it.first, it.second);
         return changed;
     }
 
-    bool add(const DefinitionsMap<NodeT> &rhs) {
+    bool add(const DefinitionsMap &rhs) {
+        if (empty()) {
+            // share the whole mapping
+            _definitions = rhs._definitions;
+            return !rhs.empty();
+        }
+
         bool changed = false;
-        for (auto &it : rhs) {
-            changed |= add(it.first, it.second);
+        for (auto &it : rhs._mapping()) {
+            changed |= _add(it.first, it.second);
         }
         return changed;
     }
 
+    ///
+    // Add the definitions of 'target' from 'rhs'. If this map does not
+    // define 'target', it shares the definitions with 'rhs'.
+    bool addTarget(NodeT *target, const DefinitionsMap &rhs) {
+        auto it = rhs._mapping().find(target);
+        if (it == rhs._mapping().end())
+            return false;
+        return _add(target, it->second);
+    }
+
+    ///
+    // Replace 'node' by 'with' in the definitions of 'target'
+    bool replace(NodeT *target, NodeT *node, NodeT *with) {
+        const auto *offsets = _getOffsets(target);
+        if (!offsets)
+            return false;
+
+        bool found = false;
+        for (const auto &it : *offsets) {
+            if (it.second.count(node) > 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+
+        return _writableOffsets(target).replace(node, with);
+    }
+
     bool update(const DefSite &ds, const std::vector<NodeT *> &nodes) {
         bool changed = false;
         for (auto n : nodes)
@@ -107,62 +275,49 @@ class DefinitionsMap {
 
     ///
     // Get definitions of the memory described by 'ds'
-    std::set<NodeT *> get(const DefSite &ds) {
-        auto it = _definitions.find(ds.target);
-        if (it == _definitions.end())
+    std::set<NodeT *> get(const DefSite &ds) const {
+        const auto *offsets = _getOffsets(ds.target);
+        if (!offsets)
             return {};
 
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return it->second.gather(start, end);
+        return offsets->gather(start, end);
     }
 
     ///
     // Return intervals of bytes from 'ds' that are not defined by this map
     std::vector<IntervalT> undefinedIntervals(const DefSite &ds) const {
-        auto it = _definitions.find(ds.target);
-        if (it == _definitions.end())
+        const auto *offsets = _getOffsets(ds.target);
+        if (!offsets)
             return {IntervalT(ds.offset, ds.offset + (ds.len - 1))};
 
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return it->second.uncovered(start, end);
+        return offsets->uncovered(start, end);
     }
 
     bool definesTarget(NodeT *target) const {
-        return _definitions.find(target) != _definitions.end();
-    }
-
-    /*
-    template <typename KeyFilt, typename SetFilt>
-    DefinitionsMap<NodeT> filter(KeyFilt keyfilt, SetFilt setfilt) {
-        DefinitionsMap<NodeT> tmp;
-        for (auto& it : _definitions) {
-            if (keyfilt(it.first) && setfilt(it.second)) {
-                tmp._definitions.emplace(it.first, it.second);
-            }
-        }
-        return tmp;
+        return _getOffsets(target) != nullptr;
     }
-    */
 
     template <typename FiltFun>
-    DefinitionsMap<NodeT> filter(FiltFun filt) {
-        DefinitionsMap<NodeT> tmp;
-        for (auto &it : _definitions) {
+    DefinitionsMap filter(FiltFun filt) {
+        DefinitionsMap tmp;
+        for (auto &it : _mapping()) {
             if (filt(it.first)) {
-                tmp._definitions.emplace(it.first, it.second);
+                tmp._writableMapping().emplace(it.first, it.second);
             }
         }
         return tmp;
     }
 
-    DefinitionsMap<NodeT> intersect(const DefinitionsMap<NodeT> &rhs) {
-        DefinitionsMap<NodeT> retval;
-        for (auto &it : _definitions) {
-            auto rhsit = rhs._definitions.find(it.first);
-            if (rhsit != rhs._definitions.end()) {
-                retval.add(it.first, it.second.intersection(rhsit->second));
+    DefinitionsMap intersect(const DefinitionsMap &rhs) {
+        DefinitionsMap retval;
+        for (auto &it : _mapping()) {
+            const auto *rhsoffsets = rhs._getOffsets(it.first);
+            if (rhsoffsets) {
+                retval.add(it.first, it.second->intersection(*rhsoffsets));
             }
         }
         return retval;
@@ -171,34 +326,41 @@ class DefinitionsMap {
     // FIXME: do that as iterators
     std::set<NodeT *> values() const {
         std::set<NodeT *> ret;
-        for (auto &it : _definitions) {
-            for (auto &it2 : it.second) {
+        for (auto &it : _mapping()) {
+            for (auto &it2 : *it.second) {
                 ret.insert(it2.second.begin(), it2.second.end());
             }
         }
         return ret;
     }
 
-    auto begin() const -> decltype(_definitions.begin()) {
-        return _definitions.begin();
-    }
-
-    auto end() const -> decltype(_definitions.end()) {
-        return _definitions.end();
-    }
-
-    bool operator==(const DefinitionsMap<NodeT> &oth) const {
-        return _definitions == oth._definitions;
+    const_iterator begin() const { return _mapping().begin(); }
+    const_iterator end() const { return _mapping().end(); }
+
+    bool operator==(const DefinitionsMap &oth) const {
+        if (_definitions.get() == oth._definitions.get())
+            return true;
+        if (size() != oth.size())
+            return false;
+
+        for (auto &it : _mapping()) {
+            const auto *othoffsets = oth._getOffsets(it.first);
+            if (!othoffsets)
+                return false;
+            if (othoffsets != it.second.get() && !(*othoffsets == *it.second))
+                return false;
+        }
+        return true;
     }
 
-    size_t size() const { return _definitions.size(); }
+    size_t size() const { return _mapping().size(); }
 
 #ifndef NDEBUG
     void dump() const {
-        for (auto &it : _definitions) {
+        for (auto &it : _mapping()) {
             it.first->dump();
             std::cout << " defined at ";
-            it.second.dump();
+            it.second->dump();
         }
     }
 #endif
@@ -1,7 +1,10 @@
 #ifndef DG_MEMORY_SSA_H_
 #define DG_MEMORY_SSA_H_
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -24,9 +27,34 @@ namespace dg {
 namespace dda {
 
 class MemorySSATransformation : public DataDependenceAnalysisImpl {
+  public:
+    ///
+    // Counters collected for every subgraph when profiling
+    // is enabled in the options (see getProfile())
+    struct Profile {
+        // searches for the definitions of uses from the subgraph
+        uint64_t queries{0};
+        // LVN scans of (parts of) the blocks of the subgraph
+        uint64_t lvnScans{0};
+        // phi nodes created in the subgraph, its summary and its calls
+        uint64_t phis{0};
+        // searches that descended into the subgraph from its callers
+        uint64_t descents{0};
+        // searches that continued from the subgraph into its callers
+        uint64_t callerSearches{0};
+        // the largest number of memory objects in the definitions of a block
+        size_t maxDefinitions{0};
+        // the time of the queries (including the searches in other subgraphs)
+        std::chrono::nanoseconds time{0};
+    };
+
+  private:
     class BBlockInfo {
         Definitions definitions{};
         RWNodeCall *call{nullptr};
+        // trivial phi nodes that were removed from the beginning
+        // of the block, each with the only definition that replaced it
+        std::vector<std::pair<RWNode *, RWNode *>> trivialPhis;
 
       public:
         void setCallBlock(RWNodeCall *c) { call = c; }
@@ -36,6 +64,14 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
         Definitions &getDefinitions() { return definitions; }
         const Definitions &getDefinitions() const { return definitions; }
+
+        void addTrivialPhi(RWNode *phi, RWNode *def) {
+            trivialPhis.emplace_back(phi, def);
+        }
+        const std::vector<std::pair<RWNode *, RWNode *>> &
+        getTrivialPhis() const {
+            return trivialPhis;
+        }
     };
 
     class SubgraphInfo {
@@ -78,6 +114,17 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
         // effects of the procedure
         ModRefInfo modref;
 
+        // phi nodes created while searching the definitions in this
+        // subgraph in parallel with other subgraphs. These nodes get
+        // their IDs (and are moved to the graph) after the search.
+        std::vector<std::unique_ptr<RWNode>> _newPhis;
+        bool _collectPhis{false};
+
+        // the number of trivial phi nodes removed from this subgraph
+        unsigned _removedPhis{0};
+
+        Profile profile;
+
         SubgraphInfo(RWSubgraph *s);
 
         friend class MemorySSATransformation;
@@ -94,7 +141,72 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
         }
     };
 
+    ///
+    // The non-phi definitions that reach phi nodes. The set is computed
+    // once for every strongly connected component of phi nodes and
+    // is shared by all the phi nodes in the component. That is correct
+    // because the definitions of a phi node never change after we have
+    // found them (new phi nodes can only use the old phi nodes).
+    class CollapsedPhis {
+        // do not collapse input and output phi nodes,
+        // take them as definitions instead
+        const bool _intraproc;
+        std::unordered_map<const RWNode *, unsigned> _setOf;
+        // the sets of definitions (IDs of nodes, sorted)
+        std::vector<std::vector<unsigned>> _sets;
+
+        bool collapses(const RWNode *n) const {
+            return n->isPhi() && !(_intraproc && n->isInOut());
+        }
+
+        void compute(RWNode *phi);
+
+      public:
+        CollapsedPhis(bool intraproc) : _intraproc(intraproc) {}
+
+        // forget all the sets (some of the phi nodes were removed)
+        void clear() {
+            _setOf.clear();
+            _sets.clear();
+        }
+
+        ///
+        // Add the definitions of 'n' to 'ret': 'n' itself if it is not
+        // a (collapsed) phi node, the definitions of the phi node otherwise
+        template <typename SetT>
+        void addDefinitions(RWNode *n, SetT &ret) {
+            if (!collapses(n)) {
+                assert(n->getID() > 0);
+                ret.set(n->getID());
+                return;
+            }
+
+            auto it = _setOf.find(n);
+            if (it == _setOf.end()) {
+                compute(n);
+                it = _setOf.find(n);
+                assert(it != _setOf.end());
+            }
+            for (auto id : _sets[it->second])
+                ret.set(id);
+        }
+    };
+
+    CollapsedPhis _collapsedPhis{false};
+    CollapsedPhis _collapsedIntraprocPhis{true};
+
+    // replace the phi nodes by their non-phi definitions
+    template <typename ContT>
+    std::vector<RWNode *> gatherNonPhisDefs(const ContT &nodes,
+                                            bool intraproc = false);
+
     void initialize();
+    void initializeSubgraph(RWSubgraph *subg);
+    // remove the phi nodes and forget the definitions in 'subg'
+    void clearSubgraph(RWSubgraph *subg);
+    // get the subgraphs connected with 'subg' by calls and forks
+    // (the summaries of these subgraphs may depend on each other)
+    static std::vector<RWSubgraph *> getCallComponent(RWSubgraph *subg);
 
     ////
     // LVN
@@ -102,10 +214,9 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     // Perform LVN up to a certain point and search only for a certain memory.
     // XXX: we could avoid this by (at least virtually) splitting blocks on
     // uses.
-    static Definitions findDefinitionsInBlock(RWNode *to,
-                                              const RWNode *mem = nullptr);
+    Definitions findDefinitionsInBlock(RWNode *to, const RWNode *mem = nullptr);
     static Definitions findEscapingDefinitionsInBlock(RWNode *to);
-    static void performLvn(Definitions & /*D*/, RWBBlock * /*block*/);
+    void performLvn(Definitions & /*D*/, RWBBlock * /*block*/);
     void updateDefinitions(Definitions &D, RWNode *node);
 
     ///
@@ -118,6 +229,9 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
     // Find definitions for the given node (which is supposed to be a use)
     std::vector<RWNode *> findDefinitions(RWNode *node);
+    // The same as above, but 'D' are already the definitions
+    // from the beginning of the block of 'node' up to 'node'
+    std::vector<RWNode *> findDefinitions(RWNode *node, const Definitions &D);
 
     std::vector<RWNode *> findDefinitionsInPredecessors(RWBBlock *block,
                                                         const DefSite &ds);
@@ -126,7 +240,7 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
                                                const DefSite &ds,
                                                std::vector<RWNode *> &defs);
 
-    void addUncoveredFromPredecessors(RWBBlock *block, Definitions &D,
+    void addUncoveredFromPredecessors(RWBBlock *block, const Definitions &D,
                                       const DefSite &ds,
                                       std::vector<RWNode *> &defs);
 
@@ -190,11 +304,41 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     void computeModRef(RWSubgraph *subg, SubgraphInfo &si);
     bool callMayDefineTarget(RWNodeCall *C, RWNode *target);
 
-    RWNode *createPhi(const DefSite &ds, RWNodeType type = RWNodeType::PHI);
+    ///
+    // Compute modref of 'subgraphs' and of the subgraphs that they may call,
+    // bottom-up over the strongly connected components of the call graph.
+    // The components that do not call each other are processed
+    // in parallel using (at most) 'threads' threads.
+    void computeModRefs(const std::vector<RWSubgraph *> &subgraphs,
+                        unsigned threads);
+    void computeAllModRefs(unsigned threads);
+    void computeSCCModRef(const std::vector<RWSubgraph *> &scc);
+
+    // Check whether searching the definitions for 'use' stays
+    // in the subgraph of 'use' (given the call blocks of the subgraph)
+    bool isLocalUse(RWNode *use, const std::vector<RWNodeCall *> &calls);
+
+    // If 'subg' is given, the phi node is going to be placed into 'subg'
+    RWNode *createPhi(const DefSite &ds, RWNodeType type = RWNodeType::PHI,
+                      RWSubgraph *subg = nullptr);
     RWNode *createPhi(Definitions &D, const DefSite &ds,
-                      RWNodeType type = RWNodeType::PHI);
+                      RWNodeType type = RWNodeType::PHI,
+                      RWSubgraph *subg = nullptr);
     RWNode *createAndPlacePhi(RWBBlock *block, const DefSite &ds);
 
+    // The phi nodes created after there were 'phis' nodes in _phis
+    // and 'newPhis' nodes in the new phis of 'si'
+    std::vector<RWNode *> getPhisCreatedAfter(size_t phis, size_t newPhis,
+                                              const SubgraphInfo &si) const;
+    ///
+    // Remove the phi nodes from 'phis' that have only one definition
+    // (except themselves), possibly after removing other phi nodes.
+    // Every reference to a removed phi node from 'phis' and from the
+    // definitions of blocks is replaced by the definition of the phi node.
+    // Return the mapping from the removed phi nodes to their definitions.
+    std::unordered_map<RWNode *, RWNode *>
+    removeTrivialPhis(const std::vector<RWNode *> &phis);
+
     // insert a (temporary) use into the graph before the node 'where'
     RWNode *insertUse(RWNode *where, RWNode *mem, const Offset &off,
                       const Offset &len);
@@ -206,6 +350,12 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     Definitions &getBBlockDefinitions(RWBBlock *b, const DefSite *ds = nullptr);
 
     SubgraphInfo &getSubgraphInfo(const RWSubgraph *s) {
+        // the infos are created in initialize(), so usually
+        // we do not modify the map here (and that is safe to do
+        // from several threads at once)
+        auto it = _subgraphs_info.find(s);
+        if (it != _subgraphs_info.end())
+            return it->second;
         return _subgraphs_info[s];
     }
     const SubgraphInfo *getSubgraphInfo(const RWSubgraph *s) const {
@@ -228,6 +378,20 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
         return getSubgraphInfo(s).getSummary();
     }
 
+    // the profile of 'subg' or nullptr if profiling is disabled
+    Profile *profile(const RWSubgraph *subg) {
+        if (!options.profile || !subg)
+            return nullptr;
+        return &getSubgraphInfo(subg).profile;
+    }
+    void profileDefinitions(const RWSubgraph *subg, const Definitions &D) {
+        if (auto *p = profile(subg)) {
+            ++p->lvnScans;
+            p->maxDefinitions =
+                    std::max(p->maxDefinitions, D.definitions.size());
+        }
+    }
+
   public:
     MemorySSATransformation(ReadWriteGraph &&graph,
                             const DataDependenceAnalysisOptions &opts)
@@ -243,6 +407,25 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     // when calling getDefinitions())
     void computeAllDefinitions();
 
+    // Compute definitions for all uses at once using (at most) 'threads'
+    // threads. The uses whose search for definitions does not leave their
+    // subgraph are processed in parallel (one subgraph at a time in each
+    // thread), the rest is processed afterwards. The results (including the
+    // IDs of the created phi nodes) do not depend on the number of threads.
+    void computeAllDefinitions(unsigned threads);
+
+    // Forget everything that was computed in 'subg' and in the subgraphs
+    // that it may (transitively) call or be called from.
+    void invalidate(RWSubgraph *subg) override;
+
+    // Update the analysis after the blocks of 'subg' have been built again.
+    // Call invalidate() on 'subg' before changing it.
+    void update(RWSubgraph *subg) override;
+
+    // compute definitions for all uses in the block at once
+    // (with one pass of LVN over the block)
+    void computeDefinitions(RWBBlock *block) override;
+
     // return the reaching definitions of ('mem', 'off', 'len')
     // at the location 'where'
     std::vector<RWNode *> getDefinitions(RWNode *where, RWNode *mem,
@@ -256,6 +439,23 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
         return bi ? &bi->getDefinitions() : nullptr;
     }
 
+    // the number of all phi nodes created by the analysis
+    // (including those that were removed later)
+    size_t getNumOfCreatedPhis() const { return _phis.size(); }
+    // the number of trivial phi nodes removed from the graph
+    size_t getNumOfRemovedPhis() const {
+        size_t num = 0;
+        for (const auto &it : _subgraphs_info)
+            num += it.second._removedPhis;
+        return num;
+    }
+
+    // the counters collected for 'subg' if profiling is enabled
+    const Profile *getProfile(const RWSubgraph *subg) const {
+        const auto *si = getSubgraphInfo(subg);
+        return si ? &si->profile : nullptr;
+    }
+
     const SubgraphInfo::Summary *getSummary(const RWSubgraph *s) const {
         const auto *si = getSubgraphInfo(s);
         if (!si)
@@ -2,6 +2,7 @@
 #define NODE_H_
 
 #include "ADT/DGContainer.h"
+#include "ADT/FrozenEdges.h"
 #include "DGParameters.h"
 #include "legacy/Analysis.h"
 
@@ -31,15 +32,17 @@ class Node {
     using KeyType = KeyT;
     using DependenceGraphType = DependenceGraphT;
 
-    using control_iterator = typename ControlEdgesT::iterator;
-    using const_control_iterator = typename ControlEdgesT::const_iterator;
-    using data_iterator = typename DataEdgesT::iterator;
-    using const_data_iterator = typename DataEdgesT::const_iterator;
-    using use_iterator = typename DataEdgesT::iterator;
-    using const_use_iterator = typename DataEdgesT::const_iterator;
-    using interference_iterator = typename InterferenceEdges::iterator;
-    using const_interference_iterator =
-            typename InterferenceEdges::const_iterator;
+    // the edges may be frozen (see FrozenEdges), so the iterators
+    // go either over EdgesT or over an array in FrozenEdges
+    using edges_iterator = EdgesIterator<NodeT>;
+    using control_iterator = edges_iterator;
+    using const_control_iterator = edges_iterator;
+    using data_iterator = edges_iterator;
+    using const_data_iterator = edges_iterator;
+    using use_iterator = edges_iterator;
+    using const_use_iterator = edges_iterator;
+    using interference_iterator = edges_iterator;
+    using const_interference_iterator = edges_iterator;
 
     Node(const KeyT &k) : key(k) {}
 
@@ -56,60 +59,60 @@ class Node {
     // thus making 'n' control dependend on this node
     bool addControlDependence(NodeT *n) {
         return _addBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                     controlDepEdges, n->revControlDepEdges);
+                                     EDGES_CONTROL, EDGES_REV_CONTROL);
     }
 
     // add data dependence edge 'this'-->'n',
     // thus making 'n' data dependend on this node
     bool addDataDependence(NodeT *n) {
-        return _addBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                     dataDepEdges, n->revDataDepEdges);
+        return _addBidirectionalEdge(static_cast<NodeT *>(this), n, EDGES_DATA,
+                                     EDGES_REV_DATA);
     }
 
     // this node uses (e.g. like an operand) the node 'n'
     bool addUseDependence(NodeT *n) {
-        return _addBidirectionalEdge(static_cast<NodeT *>(this), n, useEdges,
-                                     n->userEdges);
+        return _addBidirectionalEdge(static_cast<NodeT *>(this), n, EDGES_USE,
+                                     EDGES_USER);
     }
 
     bool addInterferenceDependence(NodeT *n) {
         return _addBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                     interferenceDepEdges,
-                                     n->revInterferenceDepEdges);
+                                     EDGES_INTERFERENCE,
+                                     EDGES_REV_INTERFERENCE);
     }
 
     // remove edge 'this'-->'n' from control dependencies
     bool removeControlDependence(NodeT *n) {
         return _removeBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                        controlDepEdges, n->revControlDepEdges);
+                                        EDGES_CONTROL, EDGES_REV_CONTROL);
     }
 
     // remove edge 'this'-->'n' from data dependencies
     bool removeDataDependence(NodeT *n) {
         return _removeBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                        dataDepEdges, n->revDataDepEdges);
+                                        EDGES_DATA, EDGES_REV_DATA);
     }
 
     bool removeUseDependence(NodeT *n) {
-        return _removeBidirectionalEdge(static_cast<NodeT *>(this), n, useEdges,
-                                        n->userEdges);
+        return _removeBidirectionalEdge(static_cast<NodeT *>(this), n,
+                                        EDGES_USE, EDGES_USER);
     }
 
     bool removeInterferenceDependence(NodeT *n) {
         return _removeBidirectionalEdge(static_cast<NodeT *>(this), n,
-                                        interferenceDepEdges,
-                                        n->revInterferenceDepEdges);
+                                        EDGES_INTERFERENCE,
+                                        EDGES_REV_INTERFERENCE);
     }
 
     // remove all control dependencies going from/to this node
     void removeOutcomingCDs() {
-        while (!controlDepEdges.empty())
-            removeControlDependence(*controlDepEdges.begin());
+        while (getEdgesNum(EDGES_CONTROL) > 0)
+            removeControlDependence(*control_begin());
     }
 
     void removeIncomingCDs() {
-        while (!revControlDepEdges.empty()) {
-            NodeT *cd = *revControlDepEdges.begin();
+        while (getEdgesNum(EDGES_REV_CONTROL) > 0) {
+            NodeT *cd = *rev_control_begin();
             // this will remove the reverse control dependence from
             // this node
             cd->removeControlDependence(static_cast<NodeT *>(this));
@@ -122,13 +125,13 @@ class Node {
     }
 
     void removeOutcomingDDs() {
-        while (!dataDepEdges.empty())
-            removeDataDependence(*dataDepEdges.begin());
+        while (getEdgesNum(EDGES_DATA) > 0)
+            removeDataDependence(*data_begin());
     }
 
     void removeIncomingDDs() {
-        while (!revDataDepEdges.empty()) {
-            NodeT *cd = *revDataDepEdges.begin();
+        while (getEdgesNum(EDGES_REV_DATA) > 0) {
+            NodeT *cd = *rev_data_begin();
             // this will remove the reverse control dependence from
             // this node
             cd->removeDataDependence(static_cast<NodeT *>(this));
@@ -142,13 +145,13 @@ class Node {
     }
 
     void removeOutcomingUses() {
-        while (!useEdges.empty())
-            removeUseDependence(*useEdges.begin());
+        while (getEdgesNum(EDGES_USE) > 0)
+            removeUseDependence(*use_begin());
     }
 
     void removeIncomingUses() {
-        while (!userEdges.empty()) {
-            NodeT *cd = *userEdges.begin();
+        while (getEdgesNum(EDGES_USER) > 0) {
+            NodeT *cd = *user_begin();
             // this will remove the reverse control dependence from
             // this node
             cd->removeUseDependence(static_cast<NodeT *>(this));
@@ -195,50 +198,70 @@ class Node {
 #endif
     }
 
-    // control dependency edges iterators
-    control_iterator control_begin() { return controlDepEdges.begin(); }
-    const_control_iterator control_begin() const {
-        return controlDepEdges.begin();
+    // iterators over the edges of the given kind
+    edges_iterator edges_begin(EdgesKind kind) const {
+        if (isFrozen(kind))
+            return edges_iterator(frozen_begin(kind));
+        return edges_iterator(edges[kind].begin());
     }
-    control_iterator control_end() { return controlDepEdges.end(); }
-    const_control_iterator control_end() const { return controlDepEdges.end(); }
 
-    // reverse control dependency edges iterators
-    control_iterator rev_control_begin() { return revControlDepEdges.begin(); }
-    const_control_iterator rev_control_begin() const {
-        return revControlDepEdges.begin();
+    edges_iterator edges_end(EdgesKind kind) const {
+        if (isFrozen(kind))
+            return edges_iterator(frozen_end(kind));
+        return edges_iterator(edges[kind].end());
     }
-    control_iterator rev_control_end() { return revControlDepEdges.end(); }
-    const_control_iterator rev_control_end() const {
-        return revControlDepEdges.end();
+
+    size_t getEdgesNum(EdgesKind kind) const {
+        if (isFrozen(kind))
+            return frozenEdges->size(frozenID, kind);
+        return edges[kind].size();
     }
 
-    // interference dependency edges iteraotrs
-    const_interference_iterator interference_begin() const {
-        return interferenceDepEdges.begin();
+    // is any kind of edges of this node frozen?
+    bool isFrozen() const { return frozenEdges != nullptr; }
+    bool isFrozen(EdgesKind kind) const {
+        return (frozenKinds & (1U << kind)) != 0;
+    }
+
+    // frozen edges of the given kind as a contiguous array
+    NodeT *const *frozen_begin(EdgesKind kind) const {
+        assert(isFrozen(kind) && "The edges are not frozen");
+        return frozenEdges->begin(frozenID, kind);
     }
-    interference_iterator interference_begin() {
-        return interferenceDepEdges.begin();
+
+    NodeT *const *frozen_end(EdgesKind kind) const {
+        assert(isFrozen(kind) && "The edges are not frozen");
+        return frozenEdges->end(frozenID, kind);
+    }
+
+    // control dependency edges iterators
+    control_iterator control_begin() const {
+        return edges_begin(EDGES_CONTROL);
     }
-    const_interference_iterator interference_end() const {
-        return interferenceDepEdges.end();
+    control_iterator control_end() const { return edges_end(EDGES_CONTROL); }
+
+    // reverse control dependency edges iterators
+    control_iterator rev_control_begin() const {
+        return edges_begin(EDGES_REV_CONTROL);
     }
-    interference_iterator interference_end() {
-        return interferenceDepEdges.end();
+    control_iterator rev_control_end() const {
+        return edges_end(EDGES_REV_CONTROL);
     }
 
-    // reverse interference dependency edges iterators
-    const_interference_iterator rev_interference_begin() const {
-        return revInterferenceDepEdges.begin();
+    // interference dependency edges iteraotrs
+    interference_iterator interference_begin() const {
+        return edges_begin(EDGES_INTERFERENCE);
     }
-    interference_iterator rev_interference_begin() {
-        return revInterferenceDepEdges.begin();
+    interference_iterator interference_end() const {
+        return edges_end(EDGES_INTERFERENCE);
     }
-    const_interference_iterator rev_interference_end() const {
-        return revInterferenceDepEdges.end();
+
+    // reverse interference dependency edges iterators
+    interference_iterator rev_interference_begin() const {
+        return edges_begin(EDGES_REV_INTERFERENCE);
     }
-    interference_iterator rev_interference_end() {
-        return revInterferenceDepEdges.end();
+    interference_iterator rev_interference_end() const {
+        return edges_end(EDGES_REV_INTERFERENCE);
     }
 
     /// NOTE: we have two kinds of data dependencies.
@@ -251,40 +274,36 @@ class Node {
     // these dependencies.
 
     // data dependency edges iterators (indirect dependency)
-    data_iterator data_begin() { return dataDepEdges.begin(); }
-    const_data_iterator data_begin() const { return dataDepEdges.begin(); }
-    data_iterator data_end() { return dataDepEdges.end(); }
-    const_data_iterator data_end() const { return dataDepEdges.end(); }
+    data_iterator data_begin() const { return edges_begin(EDGES_DATA); }
+    data_iterator data_end() const { return edges_end(EDGES_DATA); }
 
     // reverse data dependency edges iterators (indirect dependency)
-    data_iterator rev_data_begin() { return revDataDepEdges.begin(); }
-    const_data_iterator rev_data_begin() const {
-        return revDataDepEdges.begin();
+    data_iterator rev_data_begin() const {
+        return edges_begin(EDGES_REV_DATA);
     }
-    data_iterator rev_data_end() { return revDataDepEdges.end(); }
-    const_data_iterator rev_data_end() const { return revDataDepEdges.end(); }
+    data_iterator rev_data_end() const { return edges_end(EDGES_REV_DATA); }
 
     // use dependency edges iterators (indirect data dependency
     // -- uses of this node e.g. in operands)
-    use_iterator use_begin() { return useEdges.begin(); }
-    const_use_iterator use_begin() const { return useEdges.begin(); }
-    use_iterator use_end() { return useEdges.end(); }
-    const_use_iterator use_end() const { return useEdges.end(); }
+    use_iterator use_begin() const { return edges_begin(EDGES_USE); }
+    use_iterator use_end() const { return edges_end(EDGES_USE); }
 
     // user dependency edges iterators (indirect data dependency)
-    use_iterator user_begin() { return userEdges.begin(); }
-    const_use_iterator user_begin() const { return userEdges.begin(); }
-    use_iterator user_end() { return userEdges.end(); }
-    const_use_iterator user_end() const { return userEdges.end(); }
+    use_iterator user_begin() const { return edges_begin(EDGES_USER); }
+    use_iterator user_end() const { return edges_end(EDGES_USER); }
 
-    size_t getControlDependenciesNum() const { return controlDepEdges.size(); }
+    size_t getControlDependenciesNum() const {
+        return getEdgesNum(EDGES_CONTROL);
+    }
     size_t getRevControlDependenciesNum() const {
-        return revControlDepEdges.size();
+        return getEdgesNum(EDGES_REV_CONTROL);
+    }
+    size_t getDataDependenciesNum() const { return getEdgesNum(EDGES_DATA); }
+    size_t getRevDataDependenciesNum() const {
+        return getEdgesNum(EDGES_REV_DATA);
     }
-    size_t getDataDependenciesNum() const { return dataDepEdges.size(); }
-    size_t getRevDataDependenciesNum() const { return revDataDepEdges.size(); }
-    size_t getUseDependenciesNum() const { return useEdges.size(); }
-    size_t getUserDependenciesNum() const { return userEdges.size(); }
+    size_t getUseDependenciesNum() const { return getEdgesNum(EDGES_USE); }
+    size_t getUserDependenciesNum() const { return getEdgesNum(EDGES_USER); }
 
 #ifdef ENABLE_CFG
     BBlock<NodeT> *getBBlock() { return basicBlock; }
@@ -347,14 +366,63 @@ class Node {
     DependenceGraphT *dg{nullptr};
 
   private:
+    friend class FrozenEdges<NodeT>;
+
+    // removing an edge from a frozen row takes linear time,
+    // so longer rows are moved back to EdgesT first
+    static const size_t MAX_FROZEN_ERASE = 256;
+
+    // make the node use the rows of 'frozen' for the edges
+    // (called from FrozenEdges::freeze()). The edges are moved
+    // back to EdgesT one kind at a time once a new edge is added.
+    void freeze(FrozenEdges<NodeT> *frozen, unsigned id) {
+        frozenEdges = frozen;
+        frozenID = id;
+        frozenKinds = 0;
+        for (unsigned k = 0; k < EDGES_KINDS_NUM; ++k) {
+            // the empty kinds do not need to be frozen,
+            // new edges are added to them without moving anything
+            if (frozen->size(id, static_cast<EdgesKind>(k)) > 0)
+                frozenKinds |= 1U << k;
+            // release the memory
+            edges[k].clear();
+        }
+    }
+
+    // move the frozen edges of the given kind back to EdgesT
+    void _thaw(EdgesKind kind) {
+        if (!isFrozen(kind))
+            return;
+
+        for (auto I = frozen_begin(kind), E = frozen_end(kind); I != E; ++I)
+            edges[kind].insert(*I);
+        frozenEdges->clear(frozenID, kind);
+        frozenKinds &= ~(1U << kind);
+    }
+
+    bool _insertEdge(EdgesKind kind, NodeT *n) {
+        _thaw(kind);
+        return edges[kind].insert(n);
+    }
+
+    bool _eraseEdge(EdgesKind kind, NodeT *n) {
+        if (isFrozen(kind)) {
+            if (getEdgesNum(kind) <= MAX_FROZEN_ERASE)
+                return frozenEdges->erase(frozenID, kind, n);
+            _thaw(kind);
+        }
+
+        return edges[kind].erase(n) != 0;
+    }
+
     // add an edge 'ths' --> 'n' to containers of 'ths' and 'n'
-    static bool _addBidirectionalEdge(NodeT *ths, NodeT *n, EdgesT &ths_cont,
-                                      EdgesT &n_cont) {
+    static bool _addBidirectionalEdge(NodeT *ths, NodeT *n, EdgesKind kind,
+                                      EdgesKind revKind) {
 #ifndef NDEBUG
         bool ret1 =
 #endif
-                n_cont.insert(ths);
-        bool ret2 = ths_cont.insert(n);
+                n->_insertEdge(revKind, ths);
+        bool ret2 = ths->_insertEdge(kind, n);
 
         assert(ret1 == ret2 &&
                "Already had one of the edges, but not the other");
@@ -363,13 +431,13 @@ class Node {
     }
 
     // remove edge 'this'-->'n' from control dependencies
-    static bool _removeBidirectionalEdge(NodeT *ths, NodeT *n, EdgesT &ths_cont,
-                                         EdgesT &n_cont) {
-        bool ret1 = n_cont.erase(ths);
+    static bool _removeBidirectionalEdge(NodeT *ths, NodeT *n, EdgesKind kind,
+                                         EdgesKind revKind) {
+        bool ret1 = n->_eraseEdge(revKind, ths);
 #ifndef NDEBUG
         bool ret2 =
 #endif
-                ths_cont.erase(n);
+                ths->_eraseEdge(kind, n);
 
         // must have both or none
         assert(ret1 == ret2 && "An edge without rev. or vice versa");
@@ -377,16 +445,15 @@ class Node {
         return ret1;
     }
 
-    ControlEdgesT controlDepEdges;
-    DataEdgesT dataDepEdges;
-    UseEdgesT useEdges;
-    InterferenceEdges interferenceDepEdges;
+    // the edges of every kind, e.g., edges[EDGES_REV_CONTROL]
+    // are the nodes that have control dependence edge to this node
+    EdgesT edges[EDGES_KINDS_NUM];
 
-    // Nodes that have control/dep edge to this node
-    ControlEdgesT revControlDepEdges;
-    DataEdgesT revDataDepEdges;
-    UseEdgesT userEdges;
-    InterferenceEdges revInterferenceDepEdges;
+    // the rows of FrozenEdges that hold the frozen edges of this node
+    FrozenEdges<NodeT> *frozenEdges{nullptr};
+    unsigned frozenID{0};
+    // bit 'k' is set if the edges of kind 'k' are frozen
+    uint8_t frozenKinds{0};
 
     // a node can have more subgraphs (i. e. function pointers)
     std::set<DependenceGraphT *> subgraphs;
@@ -14,6 +14,8 @@
 namespace dg {
 namespace pta {
 
+class DiffPropagation;
+
 class PointerAnalysis {
     static void initPointerAnalysis() {}
 
@@ -28,6 +30,10 @@ class PointerAnalysis {
 
     const PointerAnalysisOptions options{};
 
+    // the number of nodes that were collapsed into
+    // another node because they were on a cycle
+    unsigned collapsed_nodes_num{0};
+
   public:
     PointerAnalysis(PointerGraph *ps, PointerAnalysisOptions opts)
             : PG(ps), options(std::move(opts)) {
@@ -64,10 +70,16 @@ class PointerAnalysis {
     PointerGraph *getPG() { return PG; }
     const PointerGraph *getPG() const { return PG; }
 
+    unsigned getNumOfCollapsedNodes() const { return collapsed_nodes_num; }
+
     virtual void enqueue(PSNode *n) { changed.push_back(n); }
 
     virtual void preprocess() {}
 
+    // can the analysis be solved by the difference propagation solver?
+    // (see PointerAnalysisOptions::diffPropagation)
+    virtual bool supportsDiffPropagation() const { return false; }
+
     void initialize_queue() {
         assert(to_process.empty());
 
@@ -159,11 +171,19 @@ class PointerAnalysis {
     virtual bool handleJoin(PSNode * /*unused*/) { return false; }
 
   private:
+    friend class DiffPropagation;
+
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
+    bool solveIterative();
+    bool solveDiffPropagation();
+
     bool processNode(PSNode * /*node*/);
     bool processLoad(PSNode *node);
+    bool loadFromPointer(PSNode *node, const Pointer &ptr, PointsToSetT &dst,
+                         std::vector<MemoryObject *> &objects);
+    Pointer gepPointer(PSNodeGep *gep, const Pointer &ptr) const;
     bool processGep(PSNode *node);
     bool processMemcpy(PSNode *node);
     bool processMemcpy(std::vector<MemoryObject *> &srcObjects,
@@ -48,6 +48,8 @@ class PointerAnalysisFI : public PointerAnalysis {
             preprocessGEPs();
     }
 
+    bool supportsDiffPropagation() const override { return true; }
+
     void getMemoryObjects(PSNode *where, const Pointer &pointer,
                           std::vector<MemoryObject *> &objects) override {
         // irrelevant in flow-insensitive
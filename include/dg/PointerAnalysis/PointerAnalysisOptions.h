@@ -18,6 +18,20 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // Solve the analysis using a worklist of nodes and propagate
+    // only the newly added pointers instead of iterating over all
+    // the reachable nodes until a fixpoint is reached.
+    // Used only by the analyses that support it (flow-insensitive).
+    // Note that the solver computes the full fixpoint, so it may be
+    // less precise than the default solver that revisits only nodes
+    // reachable from the changed ones.
+    bool diffPropagation{false};
+
+    // Detect cycles of copy edges (casts, phis, returns) during
+    // solving and collapse the nodes on a cycle into one node.
+    // Has an effect only with diffPropagation.
+    bool collapseCycles{false};
+
     PointerAnalysisOptions &setInvalidateNodes(bool b) {
         invalidateNodes = b;
         return *this;
@@ -26,6 +40,14 @@ struct PointerAnalysisOptions : AnalysisOptions {
         preprocessGeps = b;
         return *this;
     }
+    PointerAnalysisOptions &setDiffPropagation(bool b) {
+        diffPropagation = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setCollapseCycles(bool b) {
+        collapseCycles = b;
+        return *this;
+    }
 
     // Perform maximally this number of iterations.
     // If exceeded, the analysis is terminated and points-to sets
@@ -3,6 +3,7 @@
 
 #include "dg/PointerAnalysis/PointsToSets/AlignedPointerIdPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/AlignedSmallOffsetsPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/HashConsedPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/OffsetsSetPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/PointerIdPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/SeparateOffsetsPointsToSet.h"
@@ -12,7 +13,11 @@
 namespace dg {
 namespace pta {
 
+#ifdef DG_HASH_CONSED_PTSETS
+using PointsToSetT = HashConsedPointsToSet;
+#else
 using PointsToSetT = PointerIdPointsToSet;
+#endif
 using PointsToMapT = std::map<Offset, PointsToSetT>;
 
 } // namespace pta
@@ -0,0 +1,443 @@
+#ifndef DG_HASHCONSEDPOINTSTOSET_H
+#define DG_HASHCONSEDPOINTSTOSET_H
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "LookupTable.h"
+#include "dg/PointerAnalysis/Pointer.h"
+
+namespace dg {
+namespace pta {
+
+class PSNode;
+
+///
+// Points-to set that shares its contents with all other sets
+// with the same elements (hash-consing). The sets are immutable
+// sorted vectors of pointer IDs that are interned in a global table
+// keyed by the hash of their contents. The points-to set object
+// itself is only a handle to the interned set, so copying a set is cheap,
+// two sets are equal iff their handles are equal and unions of two sets
+// are memoized. The interned sets are reference-counted, a set is released
+// (together with the memoized unions that involve it) when the last
+// handle to it is gone.
+// Not thread-safe (the same as the lookup table for pointer IDs).
+class HashConsedPointsToSet {
+  public:
+    using IDsT = std::vector<size_t>;
+
+    struct InternedSet;
+    // nullptr is the empty set
+    using Handle = InternedSet *;
+    using UnionKeyT = std::pair<Handle, Handle>;
+
+    struct UnionKeyHash {
+        size_t operator()(const UnionKeyT &key) const {
+            auto h = std::hash<Handle>()(key.first);
+            return h ^ (std::hash<Handle>()(key.second) + 0x9e3779b9 +
+                        (h << 6) + (h >> 2));
+        }
+    };
+
+    struct InternedSet {
+        const IDsT ids;
+        const size_t hash;
+        // the number of handles that refer to the set
+        size_t refs{0};
+        // the keys of memoized unions with this set as an operand
+        // or as the result
+        std::vector<UnionKeyT> unions;
+
+        InternedSet(IDsT &&i, size_t h) : ids(std::move(i)), hash(h) {}
+    };
+
+  private:
+    static PointerIDLookupTable lookupTable;
+    // hash -> interned sets with this hash
+    static std::unordered_map<size_t, std::vector<std::unique_ptr<InternedSet>>>
+            sets;
+    // memoized results of union operations
+    static std::unordered_map<UnionKeyT, Handle, UnionKeyHash> unions;
+
+    Handle handle{nullptr};
+
+    static size_t getPointerID(const Pointer &ptr) {
+        return lookupTable.getOrCreate(ptr);
+    }
+
+    static const Pointer &getPointer(size_t id) { return lookupTable.get(id); }
+
+    static size_t hash(const IDsT &ids) {
+        size_t h = ids.size();
+        for (auto id : ids)
+            h ^= id + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    // get the unique (shared) copy of the given set
+    static Handle intern(IDsT &&ids) {
+        if (ids.empty())
+            return nullptr;
+
+        auto h = hash(ids);
+        auto &bucket = sets[h];
+        for (auto &S : bucket) {
+            if (S->ids == ids)
+                return S.get();
+        }
+
+        bucket.emplace_back(new InternedSet(std::move(ids), h));
+        return bucket.back().get();
+    }
+
+    static void acquire(Handle h) {
+        if (h)
+            ++h->refs;
+    }
+
+    static void release(Handle h) {
+        if (!h)
+            return;
+        assert(h->refs > 0 && "Releasing unreferenced set");
+        if (--h->refs == 0)
+            drop(h);
+    }
+
+    // remove the set and the memoized unions with it from the tables
+    static void drop(Handle h) {
+        for (const auto &key : h->unions) {
+            auto it = unions.find(key);
+            assert(it != unions.end() && "The union is not memoized");
+            for (auto *S : {key.first, key.second, it->second}) {
+                if (S != h)
+                    S->unions.erase(std::remove(S->unions.begin(),
+                                                S->unions.end(), key),
+                                    S->unions.end());
+            }
+            unions.erase(it);
+        }
+
+        auto it = sets.find(h->hash);
+        assert(it != sets.end() && "The set is not interned");
+        auto &bucket = it->second;
+        bucket.erase(std::find_if(bucket.begin(), bucket.end(),
+                                  [h](const std::unique_ptr<InternedSet> &S) {
+                                      return S.get() == h;
+                                  }));
+        if (bucket.empty())
+            sets.erase(it);
+    }
+
+    static Handle unite(Handle lhs, Handle rhs) {
+        if (lhs == rhs || !rhs)
+            return lhs;
+        if (!lhs)
+            return rhs;
+
+        // union is commutative, use only one order of operands as the key
+        if (rhs < lhs)
+            std::swap(lhs, rhs);
+
+        UnionKeyT key{lhs, rhs};
+        auto it = unions.find(key);
+        if (it != unions.end())
+            return it->second;
+
+        IDsT ids;
+        ids.reserve(lhs->ids.size() + rhs->ids.size());
+        std::set_union(lhs->ids.begin(), lhs->ids.end(), rhs->ids.begin(),
+                       rhs->ids.end(), std::back_inserter(ids));
+        auto *res = intern(std::move(ids));
+        unions.emplace(key, res);
+        lhs->unions.push_back(key);
+        rhs->unions.push_back(key);
+        if (res != lhs && res != rhs)
+            res->unions.push_back(key);
+        return res;
+    }
+
+    // set the handle, return true if it changed
+    bool update(Handle h) {
+        if (h == handle)
+            return false;
+        // acquire first, the new set may be created from the old one
+        acquire(h);
+        release(handle);
+        handle = h;
+        return true;
+    }
+
+    IDsT getIDs() const { return handle ? handle->ids : IDsT(); }
+
+    // Add the pointer to the sorted vector of IDs. Return true
+    // if the IDs changed. A pointer with unknown offset subsumes
+    // all the pointers to the same target.
+    static bool addID(IDsT &ids, const Pointer &ptr) {
+        auto unknown = lookupTable.get({ptr.target, Offset::UNKNOWN});
+        if (unknown != 0 &&
+            std::binary_search(ids.begin(), ids.end(), unknown)) {
+            return false;
+        }
+
+        if (ptr.offset.isUnknown()) {
+            ids.erase(std::remove_if(ids.begin(), ids.end(),
+                                     [&ptr](size_t id) {
+                                         return getPointer(id).target ==
+                                                ptr.target;
+                                     }),
+                      ids.end());
+        }
+
+        auto ptrid = getPointerID(ptr);
+        auto it = std::lower_bound(ids.begin(), ids.end(), ptrid);
+        if (it != ids.end() && *it == ptrid)
+            return false;
+        ids.insert(it, ptrid);
+        return true;
+    }
+
+    // Can adding the pointer change the sorted vector of IDs?
+    // Does not copy the IDs nor create an ID for the pointer.
+    static bool changesIDs(const IDsT &ids, const Pointer &ptr) {
+        auto unknown = lookupTable.get({ptr.target, Offset::UNKNOWN});
+        if (unknown != 0 &&
+            std::binary_search(ids.begin(), ids.end(), unknown)) {
+            return false;
+        }
+
+        auto ptrid = lookupTable.get(ptr);
+        return ptrid == 0 ||
+               !std::binary_search(ids.begin(), ids.end(), ptrid);
+    }
+
+    bool hasID(size_t id) const {
+        return handle && std::binary_search(handle->ids.begin(),
+                                            handle->ids.end(), id);
+    }
+
+  public:
+    HashConsedPointsToSet() = default;
+    explicit HashConsedPointsToSet(const std::initializer_list<Pointer> &elems) {
+        add(elems);
+    }
+
+    HashConsedPointsToSet(const HashConsedPointsToSet &rhs)
+            : handle(rhs.handle) {
+        acquire(handle);
+    }
+
+    HashConsedPointsToSet(HashConsedPointsToSet &&rhs) noexcept
+            : handle(rhs.handle) {
+        rhs.handle = nullptr;
+    }
+
+    HashConsedPointsToSet &operator=(HashConsedPointsToSet rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ~HashConsedPointsToSet() { release(handle); }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        // most of the additions do not change the set,
+        // find it out before copying the IDs
+        if (handle && !changesIDs(handle->ids, ptr))
+            return false;
+
+        auto ids = getIDs();
+        addID(ids, ptr);
+        return update(intern(std::move(ids)));
+    }
+
+    // add all the pointers at once, only the result is interned
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        // skip the pointers that are in the set already
+        // and copy the IDs only if some pointer is new
+        auto it = C.begin();
+        if (handle) {
+            while (it != C.end() && !changesIDs(handle->ids, *it))
+                ++it;
+        }
+        if (it == C.end())
+            return false;
+
+        auto ids = getIDs();
+        for (; it != C.end(); ++it)
+            addID(ids, *it);
+        return update(intern(std::move(ids)));
+    }
+
+    bool add(const HashConsedPointsToSet &S) {
+        return update(unite(handle, S.handle));
+    }
+
+    bool remove(const Pointer &ptr) {
+        auto ptrid = lookupTable.get(ptr);
+        if (ptrid == 0 || !hasID(ptrid))
+            return false;
+
+        IDsT ids;
+        ids.reserve(handle->ids.size() - 1);
+        for (auto id : handle->ids) {
+            if (id != ptrid)
+                ids.push_back(id);
+        }
+        return update(intern(std::move(ids)));
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        if (!handle)
+            return false;
+
+        IDsT ids;
+        ids.reserve(handle->ids.size());
+        for (auto id : handle->ids) {
+            if (getPointer(id).target != target)
+                ids.push_back(id);
+        }
+
+        if (ids.size() == handle->ids.size())
+            return false;
+        return update(intern(std::move(ids)));
+    }
+
+    void clear() { update(nullptr); }
+
+    bool pointsTo(const Pointer &ptr) const {
+        auto ptrid = lookupTable.get(ptr);
+        return ptrid != 0 && hasID(ptrid);
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        return pointsTo(ptr) || pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        for (const auto &ptr : *this) {
+            if (ptr.target == target) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isSingleton() const { return size() == 1; }
+
+    bool empty() const { return handle == nullptr; }
+
+    size_t count(const Pointer &ptr) const { return pointsTo(ptr); }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        for (const auto &ptr : *this) {
+            if (ptr.target == NULLPTR && *ptr.offset != 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return handle ? handle->ids.size() : 0; }
+
+    void swap(HashConsedPointsToSet &rhs) { std::swap(handle, rhs.handle); }
+
+    // sets with the same elements share the same handle
+    bool operator==(const HashConsedPointsToSet &rhs) const {
+        return handle == rhs.handle;
+    }
+
+    bool operator!=(const HashConsedPointsToSet &rhs) const {
+        return !operator==(rhs);
+    }
+
+    Handle getHandle() const { return handle; }
+
+    static size_t getNumOfInternedSets() {
+        size_t num = 0;
+        for (const auto &it : sets)
+            num += it.second.size();
+        return num;
+    }
+
+    static size_t getNumOfMemoizedUnions() { return unions.size(); }
+
+    // the number of pointer IDs in all interned sets
+    static size_t getNumOfInternedIDs() {
+        size_t num = 0;
+        for (const auto &it : sets) {
+            for (const auto &S : it.second)
+                num += S->ids.size();
+        }
+        return num;
+    }
+
+    class const_iterator {
+        IDsT::const_iterator container_it;
+
+        const_iterator(Handle handle, bool end = false) {
+            static const IDsT empty{};
+            const auto &ids = handle ? handle->ids : empty;
+            container_it = end ? ids.end() : ids.begin();
+        }
+
+      public:
+        const_iterator &operator++() {
+            container_it++;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const { return {lookupTable.get(*container_it)}; }
+
+        bool operator==(const const_iterator &rhs) const {
+            return container_it == rhs.container_it;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class HashConsedPointsToSet;
+    };
+
+    const_iterator begin() const { return {handle}; }
+    const_iterator end() const { return {handle, true /* end */}; }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_HASHCONSEDPOINTSTOSET_H
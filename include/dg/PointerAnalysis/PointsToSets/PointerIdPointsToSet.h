@@ -6,7 +6,7 @@
 #include <vector>
 
 #include "LookupTable.h"
-#include "dg/ADT/Bitvector.h"
+#include "dg/ADT/ChunkedBitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
 
 namespace dg {
@@ -17,11 +17,7 @@ class PSNode;
 class PointerIdPointsToSet {
     static PointerIDLookupTable lookupTable;
 
-#if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
-    using PointersT = ADT::SparseBitvectorHashImpl;
-#else
-    using PointersT = ADT::SparseBitvector;
-#endif
+    using PointersT = ADT::ChunkedBitvector<>;
     PointersT pointers;
 
     // if the pointer doesn't have ID, it's assigned one
@@ -78,7 +74,6 @@ class PointerIdPointsToSet {
 
     bool removeAny(PSNode *target) {
         decltype(pointers) tmp;
-        tmp.reserve(pointers.size());
         bool removed = false;
         for (const auto &ptrID : pointers) {
             if (lookupTable.get(ptrID).target != target) {
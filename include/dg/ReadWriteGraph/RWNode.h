@@ -95,6 +95,21 @@ class RWNode : public SubgraphNode<RWNode> {
 
         bool initialized() const { return _init; }
 
+        // forget the definitions (they will be searched again)
+        void clear() {
+            defuse.clear();
+            _init = false;
+        }
+
+        // replace every definition 'd' by 'f(d)'
+        template <typename FunT>
+        void rewrite(FunT f) {
+            T old;
+            old.swap(defuse);
+            for (RWNode *d : old)
+                add(f(d));
+        }
+
         operator std::vector<RWNode *>() { return defuse; }
 
         T::iterator begin() { return defuse.begin(); }
@@ -449,6 +464,13 @@ class RWNodeCall : public RWNode {
     }
     const InputsT &getInputs() const { return inputs; }
 
+    // forget the phi nodes representing the inputs and outputs
+    void clearInputsAndOutputs() {
+        inputs.clear();
+        outputs.clear();
+        unknownInput = nullptr;
+    }
+
 #ifndef NDEBUG
     void dump() const override;
 #endif
@@ -1,6 +1,7 @@
 #ifndef DG_READ_WRITE_SUBRAPH_H_
 #define DG_READ_WRITE_SUBRAPH_H_
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -85,6 +86,16 @@ class RWSubgraph {
     }
 
     void splitBBlocksOnCalls();
+    // remove all the blocks of the subgraph (e.g., to build it again)
+    // and unregister its calls from the called subgraphs. The nodes stay
+    // in the graph, they just do not have any block.
+    void clear();
+    // register the calls of the subgraph in the called subgraphs
+    void registerCalls();
+    // remove the blocks without nodes (the entry block is kept)
+    // and return the number of removed blocks
+    unsigned removeEmptyBBlocks();
+
     void addCaller(RWNode *c) {
         assert(c->getType() == RWNodeType::CALL);
         if (hasCaller(c)) {
@@ -93,6 +104,16 @@ class RWSubgraph {
         _callers.push_back(c);
     }
 
+    void removeCaller(RWNode *c) {
+        _callers.erase(std::remove(_callers.begin(), _callers.end(), c),
+                       _callers.end());
+    }
+
+    void removeForker(RWNode *f) {
+        _forkers.erase(std::remove(_forkers.begin(), _forkers.end(), f),
+                       _forkers.end());
+    }
+
     void addForker(RWNode *f) {
         assert(f->getType() == RWNodeType::FORK);
         if (hasForker(f)) {
@@ -22,6 +22,8 @@ class ReadWriteGraph {
     NodesT _nodes;
     SubgraphsT _subgraphs;
     RWSubgraph *_entry{nullptr};
+    // nodes removed by removeUselessNodes()
+    std::vector<RWNode *> _removedNodes;
 
     // iterator over the bsubgraphs that returns the bsubgraph,
     // not the unique_ptr to the bsubgraph
@@ -57,9 +59,25 @@ class ReadWriteGraph {
     const RWSubgraph *getEntry() const { return _entry; }
     void setEntry(RWSubgraph *e) { _entry = e; }
 
-    void removeUselessNodes();
+    // Take out of the basic blocks the nodes that only write to memory
+    // that is never read in the program. Return the number of removed
+    // nodes. The removed nodes are still owned by the graph, they just
+    // do not have any basic block anymore.
+    unsigned removeUselessNodes();
 
-    void optimize() { removeUselessNodes(); }
+    // Remove basic blocks without nodes (except the entry blocks)
+    // and return the number of removed blocks.
+    unsigned removeEmptyBBlocks();
+
+    // remove useless nodes and blocks from the graph
+    void optimize();
+
+    // Check whether the nodes created after the graph had 'num' nodes
+    // may read memory that only the removed useless nodes write
+    // (so the nodes were not useless, in fact).
+    bool readsRemovedMemory(size_t num) const;
+
+    size_t getNumOfNodes() const { return _nodes.size(); }
 
     RWNode *getNode(unsigned id) {
         assert(id - 1 < _nodes.size());
@@ -90,6 +108,15 @@ class ReadWriteGraph {
         return *_nodes.back().get();
     }
 
+    // Take the ownership of a node that was created outside of the graph
+    // (with ID 0) and give it the next ID, as if it was created by create()
+    RWNode &adopt(std::unique_ptr<RWNode> node) {
+        assert(node->getID() == 0 && "The node already has an ID");
+        node->setID(++lastNodeID);
+        _nodes.push_back(std::move(node));
+        return *_nodes.back().get();
+    }
+
     RWSubgraph &createSubgraph() {
         _subgraphs.emplace_back(new RWSubgraph());
         return *_subgraphs.back().get();
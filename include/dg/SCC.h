@@ -2,6 +2,7 @@
 #define DG_SCC_H_
 
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "dg/ADT/Queue.h"
@@ -9,17 +10,28 @@
 
 namespace dg {
 
+// the default edges that are followed when computing SCCs
+template <typename NodeT>
+struct SCCSuccessors {
+    auto operator()(NodeT *n) const -> decltype(n->successors()) {
+        return n->successors();
+    }
+};
+
 // implementation of tarjan's algorithm for
 // computing strongly connected components
 // for a directed graph that has a starting vertex
-// from which are all other vertices reachable
-template <typename NodeT>
+// from which are all other vertices reachable.
+// The edges of the graph are given by the EdgesT functor
+// that returns the successors of a node (CFG successors by default).
+template <typename NodeT, typename EdgesT = SCCSuccessors<NodeT>>
 class SCC {
   public:
     using SCC_component_t = std::vector<NodeT *>;
     using SCC_t = std::vector<SCC_component_t>;
 
-    SCC<NodeT>() = default;
+    SCC() = default;
+    SCC(EdgesT edges) : _edges(std::move(edges)) {}
 
     // returns a vector of vectors - every inner vector
     // contains the nodes contained in one SCC
@@ -30,6 +42,20 @@ class SCC {
         return scc;
     }
 
+    // compute SCCs of a graph that does not have a single starting
+    // vertex: every node from 'nodes' that was not visited yet
+    // starts a new search
+    template <typename NodesT>
+    SCC_t &computeAll(NodesT &&nodes) {
+        for (NodeT *n : nodes) {
+            if (_info[n].dfs_id == 0)
+                _compute(n);
+            assert(stack.empty());
+        }
+
+        return scc;
+    }
+
     const SCC_t &getSCC() const { return scc; }
 
     SCC_component_t &operator[](unsigned idx) {
@@ -44,6 +70,7 @@ class SCC {
         bool on_stack{false};
     };
 
+    EdgesT _edges{};
     ADT::QueueLIFO<NodeT *> stack;
     CachingHashMap<NodeT *, NodeInfo> _info;
     unsigned index{0};
@@ -60,7 +87,7 @@ class SCC {
         info.on_stack = true;
         stack.push(n);
 
-        for (auto *succ : n->successors()) {
+        for (auto *succ : _edges(n)) {
             auto &succ_info = _info[succ];
             if (succ_info.dfs_id == 0) {
                 assert(!succ_info.on_stack);
@@ -0,0 +1,161 @@
+#ifndef DG_SLICE_REACHABILITY_H_
+#define DG_SLICE_REACHABILITY_H_
+
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/DependenceGraph.h"
+#include "dg/util/parallel.h"
+
+#ifdef ENABLE_CFG
+#include "dg/BBlock.h"
+#endif
+
+namespace dg {
+
+///
+// Compute backward slices w.r.t. many sets of slicing criteria
+// without modifying the dependence graph.
+//
+// On construction, the nodes that are backward reachable from any of the
+// given criteria get dense IDs and their dependencies are stored into
+// compact arrays. The dependencies are the same that WalkAndMark follows
+// in backward slicing (reverse control and data dependencies, users,
+// interference and the entry node of the node's graph). Every slice is
+// then a walk over the compact arrays with its own visited bitset, so the
+// slices can be computed concurrently. WalkAndMark, on the other hand,
+// writes the slice id into the nodes and the walks must run one by one.
+//
+// Control dependencies that the graph computes on demand are computed
+// during the construction (that runs in one thread), so the graph
+// must not change after the construction.
+template <typename NodeT>
+class SliceReachability {
+    std::vector<NodeT *> _nodes;
+    std::unordered_map<NodeT *, unsigned> _ids;
+    // the dependencies of the node with ID 'i' are
+    // the nodes _deps[_offsets[i]], ..., _deps[_offsets[i + 1] - 1]
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _deps;
+
+    unsigned _getID(NodeT *n) {
+        assert(n && "Got no node");
+        auto it = _ids.emplace(n, _nodes.size());
+        if (it.second)
+            _nodes.push_back(n);
+        return it.first->second;
+    }
+
+    template <typename IT>
+    void _addDeps(IT begin, IT end) {
+        for (IT I = begin; I != end; ++I)
+            _deps.push_back(_getID(*I));
+    }
+
+    void _addDeps(NodeT *n, EdgesKind kind) {
+        if (n->isFrozen(kind))
+            _addDeps(n->frozen_begin(kind), n->frozen_end(kind));
+        else
+            _addDeps(n->edges_begin(kind), n->edges_end(kind));
+    }
+
+    void _addDeps(NodeT *n) {
+        if (DependenceGraph<NodeT> *dg = n->getDG())
+            dg->computeControlDependenciesOnDemand();
+
+        _addDeps(n, EDGES_REV_CONTROL);
+#ifdef ENABLE_CFG
+        if (BBlock<NodeT> *BB = n->getBBlock()) {
+            for (BBlock<NodeT> *CD : BB->revControlDependence())
+                _deps.push_back(_getID(CD->getLastNode()));
+        }
+#endif // ENABLE_CFG
+        _addDeps(n, EDGES_REV_DATA);
+        _addDeps(n, EDGES_USER);
+        _addDeps(n, EDGES_INTERFERENCE);
+        _addDeps(n, EDGES_REV_INTERFERENCE);
+
+        // keeping a node keeps its graph and
+        // thus also the call-sites of the graph
+        if (DependenceGraph<NodeT> *dg = n->getDG()) {
+            assert(dg->getEntry() && "No entry node in dg");
+            _deps.push_back(_getID(dg->getEntry()));
+        }
+    }
+
+  public:
+    template <typename ContainerT>
+    SliceReachability(const std::vector<ContainerT> &criteria) {
+        for (const auto &C : criteria) {
+            for (NodeT *n : C)
+                _getID(n);
+        }
+
+        // the nodes are processed in the order in which they got
+        // their IDs, so the dependencies are stored in the order of IDs
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            _offsets.push_back(_deps.size());
+            _addDeps(_nodes[i]);
+        }
+        _offsets.push_back(_deps.size());
+    }
+
+    // the nodes that are in some slice
+    const std::vector<NodeT *> &nodes() const { return _nodes; }
+    size_t size() const { return _nodes.size(); }
+
+    bool contains(NodeT *n) const { return _ids.count(n) > 0; }
+
+    ///
+    // Get the nodes of the backward slice w.r.t. 'criteria'. The nodes
+    // must have been among the criteria given to the constructor.
+    // This method can be called from several threads at once.
+    template <typename ContainerT>
+    std::vector<NodeT *> slice(const ContainerT &criteria) const {
+        std::vector<bool> visited(_nodes.size());
+        std::vector<unsigned> worklist;
+        std::vector<NodeT *> result;
+
+        for (NodeT *n : criteria) {
+            auto it = _ids.find(n);
+            assert(it != _ids.end() && "Unknown slicing criterion");
+            if (!visited[it->second]) {
+                visited[it->second] = true;
+                worklist.push_back(it->second);
+            }
+        }
+
+        while (!worklist.empty()) {
+            unsigned id = worklist.back();
+            worklist.pop_back();
+            result.push_back(_nodes[id]);
+
+            for (unsigned i = _offsets[id]; i < _offsets[id + 1]; ++i) {
+                unsigned dep = _deps[i];
+                if (!visited[dep]) {
+                    visited[dep] = true;
+                    worklist.push_back(dep);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    ///
+    // Get the backward slices w.r.t. every set of criteria,
+    // computing them in (at most) 'threads' threads.
+    template <typename ContainerT>
+    std::vector<std::vector<NodeT *>>
+    slices(const std::vector<ContainerT> &criteria, unsigned threads) const {
+        std::vector<std::vector<NodeT *>> result(criteria.size());
+        parallelFor(criteria.size(), threads,
+                    [&](size_t i) { result[i] = slice(criteria[i]); });
+        return result;
+    }
+};
+
+} // namespace dg
+
+#endif // DG_SLICE_REACHABILITY_H_
@@ -80,6 +80,11 @@ class WalkAndMark
         uint32_t slice_id = data->slice_id;
         n->setSlice(slice_id);
 
+        // the walk follows the control dependencies of 'n' right
+        // after this function returns, make sure they are computed
+        if (DependenceGraph<NodeT> *dg = n->getDG())
+            dg->computeControlDependenciesOnDemand();
+
 #ifdef ENABLE_CFG
         // when we marked a node, we need to mark even
         // the basic block - if there are basic blocks
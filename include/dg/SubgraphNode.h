@@ -51,6 +51,8 @@ class SubgraphNode {
     unsigned int scc_id{0};
 
   protected:
+    void setID(IDType i) { id = i; }
+
     // XXX: make those private!
     NodesVec _successors;
     NodesVec _predecessors;
@@ -0,0 +1,242 @@
+#ifndef DG_SDG_MULTI_SLICE_REACHABILITY_H_
+#define DG_SDG_MULTI_SLICE_REACHABILITY_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "dg/ADT/Queue.h"
+#include "dg/SystemDependenceGraph/DGArgumentPair.h"
+#include "dg/SystemDependenceGraph/DGBBlock.h"
+#include "dg/SystemDependenceGraph/DGNode.h"
+#include "dg/SystemDependenceGraph/DGNodeCall.h"
+#include "dg/SystemDependenceGraph/DGParameters.h"
+#include "dg/SystemDependenceGraph/DependenceGraph.h"
+#include "dg/SystemDependenceGraph/SystemDependenceGraph.h"
+
+namespace dg {
+namespace sdg {
+
+///
+// Compute backward slices w.r.t. up to 64 * Words slicing criteria at once.
+//
+// Every element of the SDG gets a bitmask where the i-th bit says that
+// the element is in the slice w.r.t. the i-th criterion. The masks are
+// propagated backwards along the dependencies in one fixpoint computation,
+// so every edge is traversed (about) once for all the criteria together,
+// instead of once for every criterion.
+//
+// The elements are indexed by their IDs (that are dense in every graph)
+// and the dependencies are stored into compact arrays on construction.
+// An element depends on:
+//  - its operands, the elements it reads memory from and the elements
+//    it is control dependent on (for a block, also on its terminator),
+//  - its basic block (that bears the control dependencies of the block),
+//  - the return and noreturn nodes of the called graphs (for calls),
+//  - the call-sites of its graph.
+// Parameter edges are not followed, actual parameters are in the slice
+// as the operands of the call-sites.
+//
+// The graph must not change while this object is used.
+template <unsigned Words = 1>
+class MultiSliceReachability {
+  public:
+    using MaskT = std::array<uint64_t, Words>;
+
+    static constexpr unsigned maxCriteria() { return 64 * Words; }
+
+  private:
+    // the elements by their index, nullptr for indices that do not
+    // belong to any DepDGElement (argument pairs, the nodes of graphs)
+    std::vector<DepDGElement *> _elems;
+    // the index of the element with ID 0 from the graph with the given ID
+    std::vector<unsigned> _graphBase;
+    // the index of the node for the graph with ID 1, the node
+    // stands for the graph and depends on the call-sites of the graph
+    unsigned _graphsStart{0};
+    // the dependencies of the element with index 'i' are
+    // _deps[_offsets[i]], ..., _deps[_offsets[i + 1] - 1]
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _deps;
+    std::vector<MaskT> _masks;
+
+    unsigned _index(const DGElement *e) const {
+        assert(e->getDG().getID() < _graphBase.size());
+        return _graphBase[e->getDG().getID()] + e->getID();
+    }
+
+    unsigned _graphIndex(const DependenceGraph &g) const {
+        assert(g.getID() > 0);
+        return _graphsStart + g.getID() - 1;
+    }
+
+    static void _addArguments(DGParameters &params,
+                              std::vector<DepDGElement *> &elems) {
+        for (auto &pair : params) {
+            elems.push_back(&pair.getInputArgument());
+            elems.push_back(&pair.getOutputArgument());
+        }
+    }
+
+    static std::vector<DepDGElement *> _getElements(DependenceGraph &g) {
+        std::vector<DepDGElement *> elems;
+        for (auto *nd : g.getNodes()) {
+            elems.push_back(nd);
+            if (auto *C = DGNodeCall::get(nd))
+                _addArguments(C->getParameters(), elems);
+        }
+        for (auto *B : g.getBBlocks())
+            elems.push_back(B);
+        _addArguments(g.getParameters(), elems);
+        return elems;
+    }
+
+    void _addDeps(DepDGElement *e) {
+        for (auto *dep : e->users())
+            _deps.push_back(_index(dep));
+        for (auto *dep : e->memdep())
+            _deps.push_back(_index(dep));
+        for (auto *dep : e->control_deps()) {
+            _deps.push_back(_index(dep));
+            // depending on a block means depending on its terminator
+            auto *B = DGBBlock::get(dep);
+            if (B && !B->getNodes().empty())
+                _deps.push_back(_index(B->back()));
+        }
+
+        if (auto *nd = DGNode::get(e)) {
+            if (auto *B = nd->getBBlock())
+                _deps.push_back(_index(B));
+        }
+
+        if (auto *C = DGNodeCall::get(e)) {
+            for (auto *callee : C->getCallees()) {
+                auto &params = callee->getParameters();
+                if (auto *ret = params.getReturn())
+                    _deps.push_back(_index(ret));
+                if (auto *noret = params.getNoReturn())
+                    _deps.push_back(_index(noret));
+            }
+        }
+
+        _deps.push_back(_graphIndex(e->getDG()));
+    }
+
+    // returns true if the mask 'M' changed
+    static bool _join(MaskT &M, const MaskT &rhs) {
+        bool changed = false;
+        for (unsigned w = 0; w < Words; ++w) {
+            auto old = M[w];
+            M[w] |= rhs[w];
+            changed |= (M[w] != old);
+        }
+        return changed;
+    }
+
+  public:
+    MultiSliceReachability(SystemDependenceGraph &sdg) {
+        // the IDs of elements are unique (and dense) only in a graph,
+        // so place the elements of the graphs one after another
+        std::vector<std::vector<DepDGElement *>> elements(sdg.size() + 1);
+        _graphBase.resize(sdg.size() + 1);
+        unsigned base = 0;
+        for (auto *g : sdg) {
+            assert(g->getID() <= sdg.size());
+            auto &elems = elements[g->getID()];
+            elems = _getElements(*g);
+
+            unsigned maxID = 0;
+            for (auto *e : elems)
+                maxID = std::max(maxID, e->getID());
+            _graphBase[g->getID()] = base;
+            base += maxID + 1;
+        }
+
+        _graphsStart = base;
+        _elems.resize(base + sdg.size());
+        for (const auto &elems : elements) {
+            for (auto *e : elems)
+                _elems[_index(e)] = e;
+        }
+
+        _offsets.reserve(_elems.size() + 1);
+        for (unsigned idx = 0; idx < _graphsStart; ++idx) {
+            _offsets.push_back(_deps.size());
+            if (_elems[idx])
+                _addDeps(_elems[idx]);
+        }
+        for (auto *g : sdg) {
+            assert(_offsets.size() == _graphIndex(*g));
+            _offsets.push_back(_deps.size());
+            for (auto *C : g->getCallers())
+                _deps.push_back(_index(C));
+        }
+        _offsets.push_back(_deps.size());
+    }
+
+    ///
+    // Compute the slices w.r.t. the given criteria, the i-th set
+    // of criteria gets the i-th bit in the masks.
+    template <typename ContainerT>
+    void compute(const std::vector<ContainerT> &criteria) {
+        assert(criteria.size() <= maxCriteria() && "Too many criteria");
+
+        const size_t N = _offsets.size() - 1;
+        _masks.assign(N, MaskT{});
+        std::vector<bool> queued(N);
+        ADT::QueueFIFO<unsigned> queue;
+
+        for (size_t i = 0; i < criteria.size(); ++i) {
+            for (const DGElement *e : criteria[i]) {
+                auto idx = _index(e);
+                _masks[idx][i / 64] |= (uint64_t{1} << (i % 64));
+                if (!queued[idx]) {
+                    queued[idx] = true;
+                    queue.push(idx);
+                }
+            }
+        }
+
+        // an element is processed again only when it got new bits
+        while (!queue.empty()) {
+            auto idx = queue.pop();
+            queued[idx] = false;
+            const MaskT M = _masks[idx];
+            for (unsigned i = _offsets[idx]; i < _offsets[idx + 1]; ++i) {
+                auto dep = _deps[i];
+                if (_join(_masks[dep], M) && !queued[dep]) {
+                    queued[dep] = true;
+                    queue.push(dep);
+                }
+            }
+        }
+    }
+
+    // the criteria (bits) whose slices contain the element
+    const MaskT &getMask(const DGElement *e) const {
+        assert(!_masks.empty() && "Must call compute() first");
+        return _masks[_index(e)];
+    }
+
+    bool isInSlice(const DGElement *e, unsigned criterion) const {
+        assert(criterion < maxCriteria());
+        return (getMask(e)[criterion / 64] >> (criterion % 64)) & 1;
+    }
+
+    // the elements in the slice w.r.t. the given criterion
+    std::vector<DepDGElement *> getSlice(unsigned criterion) const {
+        std::vector<DepDGElement *> slice;
+        for (auto *e : _elems) {
+            if (e && isInSlice(e, criterion))
+                slice.push_back(e);
+        }
+        return slice;
+    }
+};
+
+} // namespace sdg
+} // namespace dg
+
+#endif // DG_SDG_MULTI_SLICE_REACHABILITY_H_
@@ -1,6 +1,7 @@
 #ifndef DG_LEGACY_NODES_WALK_H_
 #define DG_LEGACY_NODES_WALK_H_
 
+#include "dg/ADT/FrozenEdges.h"
 #include "dg/DGParameters.h"
 #include "dg/legacy/Analysis.h"
 
@@ -81,7 +82,7 @@ class NodesWalk : public NodesWalkBase<NodeT> {
 
             // add unprocessed vertices
             if (options & NODES_WALK_CD) {
-                processEdges(n->control_begin(), n->control_end());
+                processEdges(n, EDGES_CONTROL);
 #ifdef ENABLE_CFG
                 // we can have control dependencies in BBlocks
                 processBBlockCDs(n);
@@ -89,7 +90,7 @@ class NodesWalk : public NodesWalkBase<NodeT> {
             }
 
             if (options & NODES_WALK_REV_CD) {
-                processEdges(n->rev_control_begin(), n->rev_control_end());
+                processEdges(n, EDGES_REV_CONTROL);
 
 #ifdef ENABLE_CFG
                 // we can have control dependencies in BBlocks
@@ -98,23 +99,22 @@ class NodesWalk : public NodesWalkBase<NodeT> {
             }
 
             if (options & NODES_WALK_DD)
-                processEdges(n->data_begin(), n->data_end());
+                processEdges(n, EDGES_DATA);
 
             if (options & NODES_WALK_REV_DD)
-                processEdges(n->rev_data_begin(), n->rev_data_end());
+                processEdges(n, EDGES_REV_DATA);
 
             if (options & NODES_WALK_USE)
-                processEdges(n->use_begin(), n->use_end());
+                processEdges(n, EDGES_USE);
 
             if (options & NODES_WALK_USER)
-                processEdges(n->user_begin(), n->user_end());
+                processEdges(n, EDGES_USER);
 
             if (options & NODES_WALK_ID)
-                processEdges(n->interference_begin(), n->interference_end());
+                processEdges(n, EDGES_INTERFERENCE);
 
             if (options & NODES_WALK_REV_ID)
-                processEdges(n->rev_interference_begin(),
-                             n->rev_interference_end());
+                processEdges(n, EDGES_REV_INTERFERENCE);
 
 #ifdef ENABLE_CFG
             if (options & NODES_WALK_BB_CFG)
@@ -163,6 +163,14 @@ class NodesWalk : public NodesWalkBase<NodeT> {
         }
     }
 
+    void processEdges(NodeT *n, EdgesKind kind) {
+        // frozen edges are a contiguous array, walk it directly
+        if (n->isFrozen(kind))
+            processEdges(n->frozen_begin(kind), n->frozen_end(kind));
+        else
+            processEdges(n->edges_begin(kind), n->edges_end(kind));
+    }
+
 #ifdef ENABLE_CFG
     // we can have control dependencies in BBlocks
     void processBBlockRevCDs(NodeT *n) {
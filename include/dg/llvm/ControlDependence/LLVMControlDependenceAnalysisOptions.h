@@ -10,9 +10,14 @@ struct LLVMControlDependenceAnalysisOptions : public LLVMAnalysisOptions,
                                               ControlDependenceAnalysisOptions {
     bool _nodePerInstruction{false};
     bool _icfg{false};
+    // the number of threads used to compute intraprocedural
+    // control dependencies of different functions
+    unsigned _cdaThreads{1};
 
     void setNodePerInstruction(bool b) { _nodePerInstruction = b; }
     bool nodePerInstruction() const { return _nodePerInstruction; }
+    void setCDAThreads(unsigned n) { _cdaThreads = n == 0 ? 1 : n; }
+    unsigned cdaThreads() const { return _cdaThreads; }
     bool ICFG() const { return _icfg; }
 };
 
@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/Support/raw_os_ostream.h>
@@ -20,6 +21,49 @@ namespace dda {
 
 class LLVMReadWriteGraphBuilder;
 
+///
+// Definitions of several uses stored in one vector. The definitions
+// of the i-th use are the values from 'offsets[i]' to 'offsets[i + 1]'.
+class LLVMDefinitionsBatch {
+    std::vector<const llvm::Value *> _uses;
+    std::vector<size_t> _offsets{0};
+    std::vector<llvm::Value *> _values;
+    std::unordered_map<const llvm::Value *, size_t> _index;
+
+  public:
+    // start the definitions of a new use
+    void addUse(const llvm::Value *use) {
+        _index.emplace(use, _uses.size());
+        _uses.push_back(use);
+        _offsets.push_back(_values.size());
+    }
+
+    // add a definition of the last added use
+    void addDefinition(llvm::Value *def) {
+        assert(!_uses.empty() && "No use added");
+        _values.push_back(def);
+        ++_offsets.back();
+    }
+
+    size_t size() const { return _uses.size(); }
+    bool empty() const { return _uses.empty(); }
+
+    const llvm::Value *getUse(size_t i) const { return _uses[i]; }
+
+    llvm::ArrayRef<llvm::Value *> getDefinitions(size_t i) const {
+        assert(i < size());
+        return {_values.data() + _offsets[i], _offsets[i + 1] - _offsets[i]};
+    }
+
+    // return the definitions of 'use' (nothing if 'use' is not in the batch)
+    llvm::ArrayRef<llvm::Value *> getDefinitions(const llvm::Value *use) const {
+        auto it = _index.find(use);
+        if (it == _index.end())
+            return {};
+        return getDefinitions(it->second);
+    }
+};
+
 class LLVMDataDependenceAnalysis {
     const llvm::Module *m;
     dg::LLVMPointerAnalysis *pta;
@@ -30,6 +74,9 @@ class LLVMDataDependenceAnalysis {
     LLVMReadWriteGraphBuilder *createBuilder();
     DataDependenceAnalysis *createDDA();
 
+    void addLLVMDefinitions(LLVMDefinitionsBatch &batch,
+                            const llvm::BasicBlock &B);
+
   public:
     LLVMDataDependenceAnalysis(const llvm::Module *m,
                                dg::LLVMPointerAnalysis *pta,
@@ -55,6 +102,19 @@ class LLVMDataDependenceAnalysis {
         DDA->run();
     }
 
+    // build the graph again and run the analysis from scratch
+    void rebuild();
+
+    ///
+    // Update the analysis after the function 'F' has been changed.
+    // Only the subgraph of 'F' is built again and only the results
+    // in the subgraphs connected with 'F' by calls are recomputed.
+    // The pointer analysis must already reflect the change.
+    // If the change cannot be handled incrementally (e.g., 'F' now calls
+    // a function that we have not built), the whole analysis is run again.
+    // Return true if the update was incremental.
+    bool update(const llvm::Function *F);
+
     const LLVMDataDependenceAnalysisOptions &getOptions() const {
         return _options;
     }
@@ -107,6 +167,11 @@ class LLVMDataDependenceAnalysis {
                                                   const Offset &off,
                                                   const Offset &len);
 
+    // return instructions that define the uses in the block (function).
+    // The definitions of all the uses from one block are searched at once.
+    LLVMDefinitionsBatch getLLVMDefinitionsBatch(const llvm::BasicBlock &B);
+    LLVMDefinitionsBatch getLLVMDefinitionsBatch(const llvm::Function &F);
+
     DataDependenceAnalysis *getDDA() { return DDA.get(); }
     const DataDependenceAnalysis *getDDA() const { return DDA.get(); }
 };
@@ -2,6 +2,7 @@
 #define LLVM_DEPENDENCE_GRAPH_H_
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
@@ -20,10 +21,7 @@ class Function;
 namespace dg {
 
 class LLVMPointerAnalysis;
-
-// namespace llvmdg {
-// class LLVMControlDependenceAnalysis;
-//}
+class LLVMControlDependenceAnalysis;
 
 // FIXME: why PTA is only in the namespace dg
 // and this is that nested? Make it consistent...
@@ -33,7 +31,6 @@ class LLVMDataDependenceAnalysis;
 }
 
 using dda::LLVMDataDependenceAnalysis;
-// using llvmdg::LLVMControlDependenceAnalysis;
 
 using LLVMBBlock = dg::BBlock<LLVMNode>;
 
@@ -116,8 +113,35 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
     void
     addNoreturnDependencies(const LLVMControlDependenceAnalysisOptions &opts);
 
+    // Compute control dependencies of all constructed functions.
+    // If 'onDemand' is true, the dependencies of a function are computed
+    // only when a walk over the graph (e.g., marking the slice) reaches
+    // a node of the function for the first time. Only standard CD and
+    // NTSCD can be computed on demand, the other algorithms are always
+    // run for the whole module.
     void computeControlDependencies(
-            const LLVMControlDependenceAnalysisOptions &opts);
+            const LLVMControlDependenceAnalysisOptions &opts,
+            bool onDemand = false);
+    // Fill in the control dependencies computed by an analysis
+    // that was run on the module independently of this graph
+    // (e.g., concurrently with the pointer analysis).
+    // Only NTSCD is supported this way.
+    void computeControlDependencies(LLVMControlDependenceAnalysis &CDA);
+
+    /* virtual */
+    void computeControlDependenciesOnDemand() override;
+    // compute the control dependencies of the functions
+    // that were not computed on demand yet
+    static void computePendingControlDependencies();
+    // the number of functions whose control dependencies
+    // were not computed on demand (yet)
+    static unsigned getPendingControlDependenciesNum();
+
+    // Store the edges of the nodes of all constructed functions
+    // into compact arrays (see FrozenEdges). The graph can be still
+    // modified afterwards, but adding edges to the nodes that already
+    // have edges of the same kind is slower and takes more memory.
+    void freeze();
 
     bool verify() const;
 
@@ -146,8 +170,24 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
 
   private:
     void computePostDominators(bool addPostDomFrontiers = false);
+    // compute post-dominators of the function of this graph
+    void computePostDominators(llvm::Function &F, bool addPostDomFrontiers);
     void computeNonTerminationControlDependencies();
     void computeNTSCD(const LLVMControlDependenceAnalysisOptions &opts);
+    void addControlDependenceEdges(LLVMControlDependenceAnalysis &CDA);
+    // add the edges for the function of this graph
+    void addControlDependenceEdges(LLVMControlDependenceAnalysis &CDA,
+                                   llvm::Function &F);
+
+    // the state of the computation of control dependencies on demand
+    // shared by the graphs of all functions, nullptr if the dependencies
+    // of this function are already computed (or are computed eagerly)
+    struct OnDemandCD;
+    std::shared_ptr<OnDemandCD> onDemandCD{};
+
+    // the storage of the edges frozen by freeze(),
+    // shared by the graphs of all functions
+    std::shared_ptr<FrozenEdges<LLVMNode>> frozenEdges{};
 
     void computeInterferenceDependentEdges(
             const std::set<const llvm::Instruction *> &loads,
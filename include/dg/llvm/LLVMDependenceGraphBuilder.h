@@ -1,8 +1,10 @@
 #ifndef DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 #define DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 
+#include <chrono>
 #include <ctime> // std::clock
 #include <string>
+#include <thread>
 
 #include <llvm/IR/Module.h>
 
@@ -41,6 +43,17 @@ struct LLVMDependenceGraphOptions {
     bool verifyGraph{true};
     bool threads{false};
     bool preserveDbg{true};
+    // run the control dependence analysis concurrently with
+    // the pointer and data dependence analysis (if the selected
+    // control dependence analysis does not need the graph itself)
+    bool pipelined{false};
+    // compute control dependencies of a function only when a walk
+    // over the graph (e.g., marking the slice) reaches the function
+    // (see LLVMDependenceGraph::computeControlDependencies)
+    bool CDOnDemand{false};
+    // store the edges of the graph into compact arrays once
+    // all dependencies are computed (see LLVMDependenceGraph::freeze)
+    bool freezeEdges{true};
 
     std::string entryFunction{"main"};
 
@@ -59,7 +72,13 @@ class LLVMDependenceGraphBuilder {
     std::unique_ptr<LLVMDependenceGraph> _dg{};
     std::unique_ptr<ControlFlowGraph> _controlFlowGraph{};
     llvm::Function *_entryFunction{nullptr};
+    // the thread that runs _CDA in the pipelined mode
+    std::thread _cdaThread;
 
+    // CPU times are in clock ticks (as returned by std::clock),
+    // wall-clock times are in microseconds. Note that in the pipelined mode
+    // the CPU times of PTA and DDA include also the time spent by
+    // the control dependence analysis running at the same moment.
     struct Statistics {
         uint64_t cdaTime{0};
         uint64_t ptaTime{0};
@@ -67,11 +86,33 @@ class LLVMDependenceGraphBuilder {
         uint64_t inferaTime{0};
         uint64_t joinsTime{0};
         uint64_t critsecTime{0};
+
+        uint64_t cdaWallTime{0};
+        uint64_t ptaWallTime{0};
+        uint64_t rdaWallTime{0};
+        // the time for which the construction waited for the concurrently
+        // running control dependence analysis
+        uint64_t cdaWaitWallTime{0};
+        // the time of the whole construction of the graph
+        uint64_t buildWallTime{0};
     } _statistics;
 
+    using WallClock = std::chrono::steady_clock;
+
+    static uint64_t _wallTimeSince(WallClock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                       WallClock::now() - start)
+                .count();
+    }
+
     std::clock_t _time_start;
-    void _timerStart() { _time_start = std::clock(); }
+    WallClock::time_point _wall_time_start;
+    void _timerStart() {
+        _time_start = std::clock();
+        _wall_time_start = WallClock::now();
+    }
     uint64_t _timerEnd() const { return (std::clock() - _time_start); }
+    uint64_t _wallTimerEnd() const { return _wallTimeSince(_wall_time_start); }
 
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
@@ -79,6 +120,7 @@ class LLVMDependenceGraphBuilder {
         _timerStart();
         _PTA->run();
         _statistics.ptaTime = _timerEnd();
+        _statistics.ptaWallTime = _wallTimerEnd();
     }
 
     void _runDataDependenceAnalysis() {
@@ -87,16 +129,64 @@ class LLVMDependenceGraphBuilder {
         _timerStart();
         _DDA->run();
         _statistics.rdaTime = _timerEnd();
+        _statistics.rdaWallTime = _wallTimerEnd();
+    }
+
+    // Can we compute control dependencies without the graph,
+    // i.e., before or while running pointer analysis?
+    // The legacy algorithms work directly on the blocks of the graph
+    // and ICFG-based algorithms need the results of pointer analysis.
+    bool _canPipelineCDA() const {
+        const auto &opts = _options.CDAOptions;
+        // in the on-demand mode, we do not want to compute
+        // the dependencies of all functions
+        return _options.pipelined && !_options.CDOnDemand && !opts.ICFG() &&
+               (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscdRanganathCD());
+    }
+
+    // Start computing control dependencies in a new thread.
+    // The analysis reads only the module (it does not need the graph
+    // nor the results of pointer analysis), so it can run
+    // at the same time as the pointer and data dependence analysis.
+    void _startControlDependenceAnalysis() {
+        assert(_canPipelineCDA());
+        assert(!_cdaThread.joinable() && "CDA already started");
+
+        _cdaThread = std::thread([this]() {
+            auto start = WallClock::now();
+            auto cpuStart = std::clock();
+            _CDA->compute();
+            // std::clock measures the time of the whole process,
+            // so this is only an approximation
+            _statistics.cdaTime = std::clock() - cpuStart;
+            _statistics.cdaWallTime = _wallTimeSince(start);
+        });
     }
 
     void _runControlDependenceAnalysis() {
+        if (_cdaThread.joinable()) {
+            // the dependencies are being computed in the pipelined mode,
+            // wait for them and just fill in the edges
+            auto start = WallClock::now();
+            _cdaThread.join();
+            _statistics.cdaWaitWallTime = _wallTimeSince(start);
+
+            _timerStart();
+            _dg->computeControlDependencies(*_CDA);
+            _statistics.cdaTime += _timerEnd();
+            _statistics.cdaWallTime += _wallTimerEnd();
+            return;
+        }
+
         _timerStart();
         //_CDA->run();
         // FIXME: until we get rid of the legacy code,
         // use the old way of inserting CD edges directly
         // into the dg
-        _dg->computeControlDependencies(_options.CDAOptions);
+        _dg->computeControlDependencies(_options.CDAOptions,
+                                        _options.CDOnDemand);
         _statistics.cdaTime = _timerEnd();
+        _statistics.cdaWallTime = _wallTimerEnd();
     }
 
     void _runInterferenceDependenceAnalysis() {
@@ -141,6 +231,13 @@ class LLVMDependenceGraphBuilder {
         assert(_entryFunction && "The entry function not found");
     }
 
+    ~LLVMDependenceGraphBuilder() {
+        // the graph was not finished, but we must not leave
+        // the analysis running
+        if (_cdaThread.joinable())
+            _cdaThread.join();
+    }
+
     LLVMPointerAnalysis *createPTA() {
 #ifdef HAVE_SVF
         if (_options.PTAOptions.isSVF())
@@ -157,6 +254,11 @@ class LLVMDependenceGraphBuilder {
 
     // construct the whole graph with all edges
     std::unique_ptr<LLVMDependenceGraph> &&build() {
+        auto start = WallClock::now();
+
+        if (_canPipelineCDA())
+            _startControlDependenceAnalysis();
+
         // compute data dependencies
         _runPointerAnalysis();
         _runDataDependenceAnalysis();
@@ -188,6 +290,11 @@ class LLVMDependenceGraphBuilder {
             return std::move(_dg);
         }
 
+        if (_options.freezeEdges)
+            _dg->freeze();
+
+        _statistics.buildWallTime = _wallTimeSince(start);
+
         return std::move(_dg);
     }
 
@@ -197,7 +304,15 @@ class LLVMDependenceGraphBuilder {
     // later.
     // NOTE: this function still runs pointer analysis as it is needed
     // for sound construction of CFG in the presence of function pointer calls.
+    // In the pipelined mode, this function also starts computing control
+    // dependencies in the background, so that they are ready
+    // in computeDependencies().
     std::unique_ptr<LLVMDependenceGraph> &&constructCFGOnly() {
+        auto start = WallClock::now();
+
+        if (_canPipelineCDA())
+            _startControlDependenceAnalysis();
+
         // data dependencies
         _runPointerAnalysis();
 
@@ -208,6 +323,8 @@ class LLVMDependenceGraphBuilder {
             _controlFlowGraph->buildFunction(_entryFunction);
         }
 
+        _statistics.buildWallTime = _wallTimeSince(start);
+
         // verify if the graph is built correctly
         if (_options.verifyGraph && !_dg->verify()) {
             _dg.reset();
@@ -224,6 +341,8 @@ class LLVMDependenceGraphBuilder {
     // Then it returns the ownership back to the caller.
     std::unique_ptr<LLVMDependenceGraph> &&
     computeDependencies(std::unique_ptr<LLVMDependenceGraph> &&dg) {
+        auto start = WallClock::now();
+
         // get the ownership
         _dg = std::move(dg);
 
@@ -240,6 +359,11 @@ class LLVMDependenceGraphBuilder {
             _runCriticalSectionAnalysis();
         }
 
+        if (_options.freezeEdges)
+            _dg->freeze();
+
+        _statistics.buildWallTime += _wallTimeSince(start);
+
         return std::move(_dg);
     }
 };
@@ -12,6 +12,11 @@ struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions,
 
     bool threads{false};
 
+    // If not empty, store the results of the analysis into this directory
+    // and load them from there instead of running the analysis
+    // when the same module is analyzed with the same options again.
+    std::string cacheDir{};
+
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
@@ -81,21 +81,31 @@ class LLVMPointerAnalysis {
     virtual ~LLVMPointerAnalysis() = default;
 };
 
+// the calls via function pointers in the order in which they were
+// resolved by the analysis (callsite, called function)
+using FunctionPointerCallsT = std::vector<std::pair<PSNode *, PSNode *>>;
+
 template <typename PTType>
 class DGLLVMPointerAnalysisImpl : public PTType {
     LLVMPointerGraphBuilder *builder;
+    // if not null, record the resolved calls via function pointers here
+    FunctionPointerCallsT *funptrCalls{nullptr};
 
   public:
     DGLLVMPointerAnalysisImpl(PointerGraph *PS, LLVMPointerGraphBuilder *b)
             : PTType(PS), builder(b) {}
 
     DGLLVMPointerAnalysisImpl(PointerGraph *PS, LLVMPointerGraphBuilder *b,
-                              const LLVMPointerAnalysisOptions &opts)
-            : PTType(PS, opts), builder(b) {}
+                              const LLVMPointerAnalysisOptions &opts,
+                              FunctionPointerCallsT *calls = nullptr)
+            : PTType(PS, opts), builder(b), funptrCalls(calls) {}
 
     // build new subgraphs on calls via pointer
     bool functionPointerCall(PSNode *callsite, PSNode *called) override {
         using namespace pta;
+        if (funptrCalls)
+            funptrCalls->emplace_back(callsite, called);
+
         const llvm::Function *F = llvm::dyn_cast<llvm::Function>(
                 called->getUserData<llvm::Value>());
         // with vararg it may happen that we get pointer that
@@ -176,6 +186,9 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     PointerGraph *PS = nullptr;
     std::unique_ptr<pta::PointerAnalysis> PTA{}; // dg pointer analysis object
     std::unique_ptr<LLVMPointerGraphBuilder> _builder;
+    // the calls via function pointers resolved by the analysis,
+    // used to rebuild the same graph when loading the results from cache
+    FunctionPointerCallsT _funptrCalls;
 
     static LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                                     uint64_t field_sensitivity,
@@ -309,27 +322,62 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
 
         buildSubgraph();
 
+        // we need to know the resolved function pointer calls
+        // only if we store the results
+        auto *calls = usesCache() ? &_funptrCalls : nullptr;
         if (options.isFS()) {
             // FIXME: make a interface with run() method
             PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisFS>(
-                    PS, _builder.get(), options));
+                    PS, _builder.get(), options, calls));
         } else if (options.isFI()) {
             PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisFI>(
-                    PS, _builder.get(), options));
+                    PS, _builder.get(), options, calls));
         } else if (options.isFSInv()) {
             PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisFSInv>(
-                    PS, _builder.get(), options));
+                    PS, _builder.get(), options, calls));
         } else {
             assert(0 && "Wrong pointer analysis");
             abort();
         }
     }
 
+    // Are the results stored to (and loaded from) a cache?
+    // Analysis of threaded programs modifies the graph also on forks and
+    // joins, which we do not record, so it is not cached.
+    bool usesCache() const {
+        return !options.cacheDir.empty() && !options.threads;
+    }
+
+    // The file in the cache directory for the results of this analysis.
+    // The name is a hash of the module and of the options.
+    std::string getCacheFile() const;
+
+    // Load the results of the analysis from the given file.
+    // Must be called after initialize() instead of running the analysis.
+    // Returns false if the file does not exist or if it does not match
+    // the pointer graph (in which case the graph must be built again).
+    bool loadFromCache(const std::string &file);
+    // Store the results of the analysis into the given file.
+    bool storeToCache(const std::string &file) const;
+
     bool run() override {
         if (!PTA) {
             initialize();
         }
-        return PTA->run();
+
+        if (!usesCache())
+            return PTA->run();
+
+        const auto file = getCacheFile();
+        if (loadFromCache(file))
+            return true;
+
+        bool ret = PTA->run();
+        if (!storeToCache(file)) {
+            llvm::errs() << "[PTA] Failed storing the results to " << file
+                         << "\n";
+        }
+        return ret;
     }
 };
 
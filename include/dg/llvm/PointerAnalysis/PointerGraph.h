@@ -203,6 +203,7 @@ class LLVMPointerGraphBuilder {
 
   public:
     const PointerGraph *getPS() const { return &PS; }
+    const llvm::Module *getModule() const { return M; }
 
     inline bool threads() const { return threads_; }
 
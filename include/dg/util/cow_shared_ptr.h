@@ -5,77 +5,44 @@
 #include <memory>
 
 ///
-// Shared pointer with copy-on-write support
+// Shared pointer with copy-on-write support. Copies of the pointer
+// share the object until someone asks for a writable object. Then the
+// object is copied, unless the pointer is the only one that refers to
+// the object. Reading the object never copies it.
 template <typename T>
-class cow_shared_ptr : public std::shared_ptr<T> {
-    // am I the owner of the copy?
-    bool owner{true};
+class cow_shared_ptr {
+    std::shared_ptr<T> ptr{nullptr};
 
   public:
     cow_shared_ptr() = default;
-    cow_shared_ptr(T *p) : std::shared_ptr<T>(p) {}
-    cow_shared_ptr(cow_shared_ptr &&) = delete;
-    cow_shared_ptr(const cow_shared_ptr &rhs)
-            : std::shared_ptr<T>(rhs), owner(false) {}
+    explicit cow_shared_ptr(T *p) : ptr(p) {}
 
-    void reset(T *p) {
-        owner = true;
-        std::shared_ptr<T>::reset(p);
-    }
+    void reset(T *p = nullptr) { ptr.reset(p); }
+    void swap(cow_shared_ptr &rhs) { ptr.swap(rhs.ptr); }
 
-    const T *get() const { return std::shared_ptr<T>::get(); }
+    const T *get() const { return ptr.get(); }
     const T *operator->() const { return get(); }
-    const T *operator*() const { return get(); }
-
-    T *getWritable() {
-        if (owner)
-            return std::shared_ptr<T>::get();
-
-        // create a copy of the object and claim the ownership
-        assert(!owner);
-        if (get() != nullptr) {
-            reset(new T(*get()));
-        } else {
-            reset(new T());
-        }
-        assert(owner); // set in reset() method
-        return std::shared_ptr<T>::get();
+    const T &operator*() const {
+        assert(ptr && "Dereferencing nullptr");
+        return *ptr;
     }
-};
 
-/*
-template <typename T>
-class cow_shared_ptr {
-    std::shared_ptr<T> ptr{nullptr};
-    // am I the owner of the copy?
-    bool owner{false};
-
-    public:
-    cow_shared_ptr() = default;
-    cow_shared_ptr(T *p) : ptr(p), owner(true) {}
-    cow_shared_ptr(cow_shared_ptr&&) = delete;
-    cow_shared_ptr(const cow_shared_ptr& rhs)
-        : ptr(rhs.ptr), owner(false) {}
-
-    const T *get() const { return ptr.get(); }
+    explicit operator bool() const { return ptr != nullptr; }
 
     T *getWritable() {
-        if (owner)
-            return ptr.get();
-        // create a copy of the object and claim the ownership
-        if (ptr) {
-            ptr.reset(new T(*get()));
-        } else {
-            ptr.reset(new T());
+        if (!ptr) {
+            ptr = std::make_shared<T>();
+        } else if (ptr.use_count() > 1) {
+            // create a copy of the object and claim the ownership
+            ptr = std::make_shared<T>(*ptr);
         }
-        owner = true;
+        assert(ptr.use_count() == 1);
         return ptr.get();
     }
 
-    auto use_count() const -> decltype(ptr.use_count()) {
-        return ptr.use_count();
-    }
+    // does someone else refer to the object?
+    bool isShared() const { return ptr.use_count() > 1; }
+    long use_count() const { return ptr.use_count(); }
 };
-*/
 
 #endif // COW_SHARED_PTR_H_
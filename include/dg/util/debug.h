@@ -13,7 +13,9 @@ namespace debug {
 #ifdef DEBUG_ENABLED
 
 extern unsigned _debug_lvl;
-extern unsigned _ind;
+// the indentation of sections is per thread, so that the sections
+// opened in the workers of parallelFor() do not race
+extern thread_local unsigned _ind;
 
 namespace {
 inline unsigned &_getDebugLvl() { return _debug_lvl; }
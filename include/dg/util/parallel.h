@@ -0,0 +1,47 @@
+#ifndef DG_UTIL_PARALLEL_H_
+#define DG_UTIL_PARALLEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace dg {
+
+///
+// Call fun(i) for every i in [0, n) using (at most) 'threads' threads.
+// The items are handed out to the threads one by one, so the items
+// may take very different time. Returns after all the items are done.
+// With 'threads' <= 1 the items are processed in order in this thread.
+template <typename FunT>
+void parallelFor(size_t n, unsigned threads, const FunT &fun) {
+    if (threads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            fun(i);
+        return;
+    }
+
+    if (threads > n)
+        threads = static_cast<unsigned>(n);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&next, n, &fun]() {
+        size_t i;
+        while ((i = next.fetch_add(1, std::memory_order_relaxed)) < n)
+            fun(i);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(worker);
+    // this thread works too
+    worker();
+
+    for (auto &w : workers)
+        w.join();
+}
+
+} // namespace dg
+
+#endif // DG_UTIL_PARALLEL_H_
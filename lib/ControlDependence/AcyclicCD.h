@@ -0,0 +1,150 @@
+#ifndef DG_ACYCLIC_CD_H_
+#define DG_ACYCLIC_CD_H_
+
+#include <cassert>
+#include <vector>
+
+#include "dg/SCC.h"
+#include "dg/util/debug.h"
+
+#include "CDGraph.h"
+#include "CDRelation.h"
+
+namespace dg {
+
+/////
+/// Control dependencies in the acyclic part of a CDGraph, that is,
+/// of nodes from which no cycle is reachable. From such a node all
+/// maximal paths are finite, so non-termination sensitive control
+/// dependencies on it coincide with the standard control
+/// dependencies given by post-dominators.
+///
+/// Moreover, from a node that reaches a cycle there is an infinite
+/// path that avoids all nodes of the acyclic part. Therefore:
+///  - a node from the acyclic part depends on a predicate 'p' iff it
+///    post-dominates a successor of 'p' and it does not post-dominate
+///    all the successors of 'p' (if 'p' reaches a cycle, the latter
+///    holds trivially),
+///  - a node that reaches a cycle depends only on predicates that
+///    reach a cycle too, and the nodes of the acyclic part are never
+///    on all maximal paths from such a node.
+/// So the expensive algorithms need to be run only for the nodes that
+/// reach a cycle.
+/////
+class AcyclicCD {
+    // indexed by IDs of nodes, 0 is the virtual exit node
+    std::vector<bool> _reachesCycle;
+    // immediate post-dominators of the nodes from the acyclic part
+    std::vector<unsigned> _ipdom;
+    std::vector<unsigned> _depth;
+    // the nodes from the acyclic part in reverse topological order
+    std::vector<CDNode *> _acyclic;
+
+    // the nearest common post-dominator
+    unsigned nca(unsigned a, unsigned b) const {
+        while (a != b) {
+            while (_depth[a] > _depth[b])
+                a = _ipdom[a];
+            while (_depth[b] > _depth[a])
+                b = _ipdom[b];
+            if (a != b) {
+                a = _ipdom[a];
+                b = _ipdom[b];
+            }
+        }
+        return a;
+    }
+
+    void computeAcyclicPart(CDGraph &graph) {
+        SCC<CDNode> scc;
+        auto &components = scc.computeAll(graph);
+
+        // SCC numbers the components in the reverse topological order,
+        // so the components of successors are processed before
+        // the component of a node
+        _reachesCycle.assign(graph.size() + 1, false);
+        for (auto &component : components) {
+            bool reaches = component.size() > 1;
+            for (auto *nd : component) {
+                for (auto *succ : nd->successors()) {
+                    if (succ == nd || _reachesCycle[succ->getID()]) {
+                        reaches = true;
+                    }
+                }
+            }
+
+            if (reaches) {
+                for (auto *nd : component) {
+                    _reachesCycle[nd->getID()] = true;
+                }
+            } else {
+                assert(component.size() == 1);
+                _acyclic.push_back(component[0]);
+            }
+        }
+    }
+
+    void computePostDominators(CDGraph &graph) {
+        _ipdom.assign(graph.size() + 1, 0);
+        _depth.assign(graph.size() + 1, 0);
+
+        for (auto *nd : _acyclic) {
+            const auto &succs = nd->successors();
+            unsigned ipdom = 0;
+            if (!succs.empty()) {
+                ipdom = succs[0]->getID();
+                for (auto *succ : succs) {
+                    assert(!_reachesCycle[succ->getID()]);
+                    ipdom = nca(ipdom, succ->getID());
+                }
+            }
+
+            _ipdom[nd->getID()] = ipdom;
+            _depth[nd->getID()] = _depth[ipdom] + 1;
+        }
+    }
+
+  public:
+    void compute(CDGraph &graph) {
+        DBG_SECTION_BEGIN(cda, "Computing the acyclic part of the graph "
+                                       << graph.getName());
+        computeAcyclicPart(graph);
+        computePostDominators(graph);
+        DBG_SECTION_END(cda, "The acyclic part has " << _acyclic.size()
+                                                     << " of " << graph.size()
+                                                     << " nodes");
+    }
+
+    bool reachesCycle(const CDNode *nd) const {
+        assert(nd->getID() < _reachesCycle.size());
+        return _reachesCycle[nd->getID()];
+    }
+
+    size_t size() const { return _acyclic.size(); }
+
+    // add the dependencies of the nodes from the acyclic part
+    void computeDependencies(CDGraph &graph, CDRelation &CD,
+                             CDRelation &revCD) const {
+        for (auto *p : graph.predicates()) {
+            // the nodes on the path from a successor to the immediate
+            // post-dominator of 'p' in the post-dominator tree depend
+            // on 'p'. If 'p' reaches a cycle, we go up to the root.
+            auto stop = reachesCycle(p) ? 0 : _ipdom[p->getID()];
+            for (auto *succ : p->successors()) {
+                if (reachesCycle(succ))
+                    continue;
+
+                for (auto id = succ->getID(); id != stop; id = _ipdom[id]) {
+                    assert(id != 0 && "Did not find the post-dominator");
+                    auto *nd = graph.getNode(id);
+                    CD.add(nd, p);
+                    revCD.add(p, nd);
+                }
+            }
+        }
+    }
+};
+
+} // namespace dg
+
+#endif // DG_ACYCLIC_CD_H_
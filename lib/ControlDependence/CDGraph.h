@@ -25,10 +25,14 @@ class CDNode : public ElemWithEdges<CDNode> {
     friend class CDGraph;
 
     unsigned _id;
+    unsigned _scc_id{0};
     CDNode(unsigned id) : _id(id) {}
 
   public:
     unsigned getID() const { return _id; }
+
+    void setSCCId(unsigned id) { _scc_id = id; }
+    unsigned getSCCId() const { return _scc_id; }
 };
 
 /////
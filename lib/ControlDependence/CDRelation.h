@@ -0,0 +1,81 @@
+#ifndef DG_CDRELATION_H_
+#define DG_CDRELATION_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "dg/ADT/ChunkedBitvector.h"
+
+#include "CDGraph.h"
+
+namespace dg {
+
+/////
+/// CDRelation - a binary relation over the nodes of a CDGraph
+/// (e.g., control dependencies or reverse control dependencies).
+/// CDGraph assigns dense IDs to nodes, so the related nodes are kept
+/// in a bitvector of IDs and these bitvectors are stored in a vector
+/// indexed by the ID of the node.
+/////
+class CDRelation {
+  public:
+    using NodesT = ADT::ChunkedBitvector<>;
+
+  private:
+    // _nodes[0] is unused, IDs start from 1
+    std::vector<NodesT> _nodes;
+
+    const NodesT &_get(size_t id) const {
+        static const NodesT empty;
+        return id < _nodes.size() ? _nodes[id] : empty;
+    }
+
+  public:
+    CDRelation() = default;
+    explicit CDRelation(const CDGraph &graph) : _nodes(graph.size() + 1) {}
+
+    // returns true if the pair was not in the relation before
+    bool add(const CDNode *nd, const CDNode *dep) {
+        auto id = nd->getID();
+        if (id >= _nodes.size())
+            _nodes.resize(id + 1);
+        return !_nodes[id].set(dep->getID());
+    }
+
+    // the IDs of nodes that are related to 'nd'
+    const NodesT &get(const CDNode *nd) const { return _get(nd->getID()); }
+
+    bool has(const CDNode *nd, const CDNode *dep) const {
+        return get(nd).get(dep->getID());
+    }
+
+    // the number of pairs in the relation
+    size_t size() const {
+        size_t num = 0;
+        for (const auto &nds : _nodes)
+            num += nds.size();
+        return num;
+    }
+
+    bool empty() const {
+        for (const auto &nds : _nodes)
+            if (!nds.empty())
+                return false;
+        return true;
+    }
+
+    bool operator==(const CDRelation &rhs) const {
+        auto n = std::max(_nodes.size(), rhs._nodes.size());
+        for (size_t i = 0; i < n; ++i) {
+            if (_get(i) != rhs._get(i))
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const CDRelation &rhs) const { return !operator==(rhs); }
+};
+
+} // namespace dg
+
+#endif // DG_CDRELATION_H_
@@ -1,16 +1,18 @@
 #ifndef DG_DOD_H_
 #define DG_DOD_H_
 
+#include <algorithm>
 #include <functional>
-#include <map>
 #include <set>
-#include <unordered_map>
+#include <vector>
 
 #include <dg/ADT/Bitvector.h>
+#include <dg/ADT/ChunkedBitvector.h>
 #include <dg/ADT/Queue.h>
 #include <dg/ADT/SetQueue.h>
 
 #include "CDGraph.h"
+#include "CDRelation.h"
 
 namespace dg {
 
@@ -19,38 +21,40 @@ namespace dg {
 // but we remember the results of calls to compute()
 class AllMaxPath {
   public:
-    using ResultT = std::map<CDNode *, const ADT::SparseBitvector &>;
+    // mapping CDNode ID -> IDs of nodes on all max paths from the node
+    using ResultT = std::vector<ADT::ChunkedBitvector<>>;
 
   private:
-    struct Info {
-        ADT::SparseBitvector colors;
-        unsigned short counter;
-    };
-
-    std::unordered_map<CDNode *, Info> data;
+    ResultT colors;
+    // the counters are in a separate array, so that they can be reset
+    // for every target by a single sweep over the memory
+    std::vector<unsigned short> successorsNum;
+    std::vector<unsigned short> counter;
 
-    void compute(CDGraph &graph, CDNode *target) {
+    void compute(CDNode *target, ADT::QueueLIFO<CDNode *> &queue) {
         // initialize nodes
-        for (auto *nd : graph) {
-            data[nd].counter = nd->successors().size();
-        }
+        std::copy(successorsNum.begin(), successorsNum.end(), counter.begin());
 
         // initialize the search
-        data[target].colors.set(target->getID());
-        ADT::QueueLIFO<CDNode *> queue;
+        colors[target->getID()].set(target->getID());
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
             auto *node = queue.pop();
-            assert(data[node].colors.get(target->getID()) &&
+            assert(colors[node->getID()].get(target->getID()) &&
                    "A non-colored node in queue");
 
             for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
-                --D.counter;
-                if (D.counter == 0) {
-                    D.colors.set(target->getID());
+                // the target is colored from the beginning, do not
+                // color it (and its predecessors) again when we get
+                // to it through a cycle
+                if (pred == target)
+                    continue;
+                auto &C = counter[pred->getID()];
+                --C;
+                if (C == 0) {
+                    colors[pred->getID()].set(target->getID());
                     queue.push(pred);
                 }
             }
@@ -58,19 +62,22 @@ class AllMaxPath {
     }
 
   public:
-    // returns mapping CDNode -> Set of CDNodes (where the set is implemented as
-    // a bitvector)
+    // returns mapping CDNode ID -> Set of CDNodes IDs (where the set is
+    // implemented as a bitvector)
     ResultT compute(CDGraph &graph) {
-        ResultT res;
-
-        data.reserve(graph.size());
+        colors.assign(graph.size() + 1, {});
+        successorsNum.assign(graph.size() + 1, 0);
+        for (auto *nd : graph) {
+            successorsNum[nd->getID()] = nd->successors().size();
+        }
+        counter.resize(successorsNum.size());
 
+        ADT::QueueLIFO<CDNode *> queue;
         for (auto *nd : graph) {
-            compute(graph, nd);
-            res.emplace(nd, data[nd].colors);
+            compute(nd, queue);
         }
 
-        return res;
+        return std::move(colors);
     }
 };
 
@@ -83,7 +90,7 @@ class DOD {
     // the ternary relation. However, the effect on the results of slicing
     // is usually small. There is a flag that computes the relation
     // as ternary.
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRelation;
     using ColoringT = ADT::SparseBitvector;
 
   private:
@@ -92,26 +99,30 @@ class DOD {
         ColoringT blues;
         ColoringT reds;
 
-        // mapping G -> Ap
-        std::unordered_map<CDNode *, CDNode *> _mapping{};
-        // mapping Ap -> G
-        std::unordered_map<CDNode *, CDNode *> _rev_mapping{};
+        // mapping G -> Ap (indexed by IDs of nodes from G)
+        std::vector<CDNode *> _mapping{};
+        // mapping Ap -> G (indexed by IDs of nodes from Ap)
+        std::vector<CDNode *> _rev_mapping{};
 
         CDNode *createNode(CDNode *gnode) {
             auto *nd = &Ap.createNode();
-            _mapping[gnode] = nd;
-            _rev_mapping[nd] = gnode;
+            if (gnode->getID() >= _mapping.size())
+                _mapping.resize(gnode->getID() + 1);
+            _mapping[gnode->getID()] = nd;
+            if (nd->getID() >= _rev_mapping.size())
+                _rev_mapping.resize(nd->getID() + 1);
+            _rev_mapping[nd->getID()] = gnode;
             return nd;
         }
 
         CDNode *getNode(CDNode *gnode) {
-            auto it = _mapping.find(gnode);
-            return it == _mapping.end() ? nullptr : it->second;
+            auto id = gnode->getID();
+            return id < _mapping.size() ? _mapping[id] : nullptr;
         }
 
         CDNode *getGNode(CDNode *apnode) {
-            auto it = _rev_mapping.find(apnode);
-            return it == _rev_mapping.end() ? nullptr : it->second;
+            auto id = apnode->getID();
+            return id < _rev_mapping.size() ? _rev_mapping[id] : nullptr;
         }
 
         ColoredAp() = default;
@@ -146,10 +157,11 @@ class DOD {
     }
 
     // Create the Ap graph (nodes and edges)
-    ColoredAp createAp(const ADT::SparseBitvector &nodes, CDGraph &graph,
+    ColoredAp createAp(const ADT::ChunkedBitvector<> &nodes, CDGraph &graph,
                        CDNode *node) {
         ColoredAp CAp;
         CDGraph &Ap = CAp.Ap;
+        CAp._mapping.resize(graph.size() + 1);
 
         // create nodes of graph
         for (auto *n : graph) {
@@ -188,13 +200,11 @@ class DOD {
     }
 
     // create the Ap graph (calls createAp) and color the nodes in the Ap graph
-    ColoredAp createColoredAp(AllMaxPath::ResultT &allpaths, CDGraph &graph,
+    ColoredAp createColoredAp(const AllMaxPath::ResultT &allpaths,
+                              CDGraph &graph,
                               CDNode *node) {
-        auto it = allpaths.find(node);
-        if (it == allpaths.end()) {
-            return {};
-        }
-        const auto &nodes = it->second;
+        assert(node->getID() < allpaths.size());
+        const auto &nodes = allpaths[node->getID()];
 
         ColoredAp CAp = createAp(nodes, graph, node);
         if (CAp.Ap.empty()) {
@@ -386,10 +396,10 @@ class DOD {
                 //                                     << gncur->getID() <<
                 //                                     "}");
 
-                CD[gcur].insert(p);
-                CD[gncur].insert(p);
-                revCD[p].insert(gcur);
-                revCD[p].insert(gncur);
+                CD.add(gcur, p);
+                CD.add(gncur, p);
+                revCD.add(p, gcur);
+                revCD.add(p, gncur);
 
                 ncur = ncur->getSingleSuccessor();
             } while (!(CAp.isBlue(ncur) || CAp.isRed(ncur)));
@@ -409,8 +419,8 @@ class DOD {
         do {
             auto *gcur = CAp.getGNode(cur);
             assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
+            CD.add(gcur, p);
+            revCD.add(p, gcur);
             // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
             cur = cur->getSingleSuccessor();
         } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
@@ -421,8 +431,8 @@ class DOD {
         do {
             auto *gcur = CAp.getGNode(cur);
             assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
+            CD.add(gcur, p);
+            revCD.add(p, gcur);
             // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
             cur = cur->getSingleSuccessor();
         } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
@@ -433,7 +443,7 @@ class DOD {
   protected:
     // make this public, so that we can use it in NTSCD+DOD algorithm
     template <typename OnAllPaths>
-    void computeDOD(CDNode *p, CDGraph &graph, OnAllPaths &allpaths,
+    void computeDOD(CDNode *p, CDGraph &graph, const OnAllPaths &allpaths,
                     ResultT &CD, ResultT &revCD) {
         assert(p->successors().size() == 2 &&
                "We work with at most 2 successors");
@@ -455,8 +465,8 @@ class DOD {
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph);
+        ResultT revCD(graph);
 
         DBG_SECTION_BEGIN(cda, "Computing DOD for all predicates");
 
@@ -475,7 +485,7 @@ class DOD {
         }
 
         DBG_SECTION_END(cda, "Finished computing DOD for all predicates");
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -485,14 +495,11 @@ class DODRanganath {
     // NOTE: although DOD is a ternary relation, we treat it as binary
     // by breaking a->(b, c) to (a, b) and (a, c). It is less precise,
     // but our API is not prepared for the ternary relation.
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRelation;
     enum class Color { WHITE, BLACK, UNCOLORED };
 
-    struct Info {
-        Color color{Color::UNCOLORED};
-    };
-
-    std::unordered_map<CDNode *, Info> data;
+    // colors of nodes indexed by their IDs
+    std::vector<Color> colors;
 
     void coloredDAG(CDGraph &graph, CDNode *n, std::set<CDNode *> &visited) {
         if (visited.insert(n).second) {
@@ -504,23 +511,21 @@ class DODRanganath {
                 coloredDAG(graph, q, visited);
             }
             auto *s = *(successors.begin());
-            auto c = data[s].color;
+            auto c = colors[s->getID()];
             for (auto *q : successors) {
-                if (data[q].color != c) {
+                if (colors[q->getID()] != c) {
                     c = Color::UNCOLORED;
                     break;
                 }
             }
-            data[n].color = c;
+            colors[n->getID()] = c;
         }
     }
 
     bool dependence(CDNode *n, CDNode *m, CDNode *p, CDGraph &G) {
-        for (auto *n : G) {
-            data[n].color = Color::UNCOLORED;
-        }
-        data[m].color = Color::WHITE;
-        data[p].color = Color::BLACK;
+        std::fill(colors.begin(), colors.end(), Color::UNCOLORED);
+        colors[m->getID()] = Color::WHITE;
+        colors[p->getID()] = Color::BLACK;
 
         std::set<CDNode *> visited;
         visited.insert(m);
@@ -532,9 +537,9 @@ class DODRanganath {
         bool blackChild = false;
 
         for (auto *q : n->successors()) {
-            if (data[q].color == Color::WHITE)
+            if (colors[q->getID()] == Color::WHITE)
                 whiteChild = true;
-            if (data[q].color == Color::BLACK)
+            if (colors[q->getID()] == Color::BLACK)
                 blackChild = true;
         }
 
@@ -568,28 +573,26 @@ class DODRanganath {
             bool onstack{false};
             bool visited{false};
         };
-        std::unordered_map<CDNode *, NodeInf> data;
-
-        data.reserve(G.size());
+        std::vector<NodeInf> data(G.size() + 1);
 
         const std::function<bool(CDNode *, CDNode *)> onallpths =
                 [&](CDNode *node, CDNode *target) -> bool {
             if (node == target)
                 return true;
 
-            data[node].visited = true;
+            data[node->getID()].visited = true;
 
             if (!node->hasSuccessors())
                 return false;
 
             for (auto *s : node->successors()) {
-                if (data[s].onstack)
+                if (data[s->getID()].onstack)
                     return false;
-                if (!data[s].visited) {
-                    data[s].onstack = true;
+                if (!data[s->getID()].visited) {
+                    data[s->getID()].onstack = true;
                     if (!onallpths(s, target))
                         return false;
-                    data[s].onstack = false;
+                    data[s->getID()].onstack = false;
                 }
             }
             // if we have successors and got here,
@@ -597,7 +600,7 @@ class DODRanganath {
             return true;
         };
 
-        data[from].onstack = true;
+        data[from->getID()].onstack = true;
         // DBG(tmp, "on all paths:" << from->getID() << ", " << n->getID() << ":
         // " << r );
         return onallpths(from, n);
@@ -605,12 +608,12 @@ class DODRanganath {
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph);
+        ResultT revCD(graph);
 
         DBG(cda, "Computing DOD (Ranganath)");
 
-        data.reserve(graph.size());
+        colors.assign(graph.size() + 1, Color::UNCOLORED);
 
         for (auto *n : graph.predicates()) {
             for (auto *m : graph) {
@@ -624,16 +627,16 @@ class DODRanganath {
                         // DBG(cda, "DOD: " << n->getID() << " -> {"
                         //                 << p->getID() << ", " << m->getID()
                         //                 << "}");
-                        CD[m].insert(n);
-                        CD[p].insert(n);
-                        revCD[n].insert(m);
-                        revCD[n].insert(n);
+                        CD.add(m, n);
+                        CD.add(p, n);
+                        revCD.add(n, m);
+                        revCD.add(n, n);
                     }
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
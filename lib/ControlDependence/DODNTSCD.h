@@ -1,7 +1,6 @@
 #ifndef DG_DODNTSCD_H_
 #define DG_DODNTSCD_H_
 
-#include <dg/ADT/Bitvector.h>
 #include <dg/ADT/Queue.h>
 #include <dg/ADT/SetQueue.h>
 
@@ -23,28 +22,28 @@ class DODNTSCD : public DOD {
         auto *s2 = *(++succit);
         assert(++succit == succs.end());
 
-        auto it1 = onallpaths.find(s1);
-        if (it1 == onallpaths.end())
-            return;
-        auto it2 = onallpaths.find(s2);
-        if (it2 == onallpaths.end())
-            return;
-
-        const auto &nodes1 = it1->second;
-        const auto &nodes2 = it2->second;
-        // FIXME: we could do that faster
-        for (auto *n : graph) {
-            if (nodes1.get(n->getID()) ^ nodes2.get(n->getID())) {
-                CD[n].insert(p);
-                revCD[p].insert(n);
+        const auto &nodes1 = onallpaths[s1->getID()];
+        const auto &nodes2 = onallpaths[s2->getID()];
+        // the nodes that are on all max paths from one successor
+        // but not from the other
+        for (auto id : nodes1) {
+            if (!nodes2.get(id)) {
+                CD.add(graph.getNode(id), p);
+                revCD.add(p, graph.getNode(id));
+            }
+        }
+        for (auto id : nodes2) {
+            if (!nodes1.get(id)) {
+                CD.add(graph.getNode(id), p);
+                revCD.add(p, graph.getNode(id));
             }
         }
     }
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph);
+        ResultT revCD(graph);
 
         DBG_SECTION_BEGIN(cda, "Computing DOD for all predicates");
 
@@ -64,7 +63,7 @@ class DODNTSCD : public DOD {
         }
 
         DBG_SECTION_END(cda, "Finished computing DOD for all predicates");
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
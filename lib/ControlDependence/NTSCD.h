@@ -1,35 +1,51 @@
 #ifndef DG_NTSCD_H
 #define DG_NTSCD_H
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
 #include <set>
 #include <unordered_map>
 #include <vector>
 
+#include "AcyclicCD.h"
 #include "CDGraph.h"
+#include "CDRelation.h"
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/SetQueue.h"
 
 namespace dg {
 
 class NTSCD {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRelation;
 
-    struct Info {
-        unsigned color{0};
-    };
+    // the color of a node is the ID of the last target that colored it
+    // (so we do not need to reset the colors for every target)
+    std::vector<unsigned> color;
+    // the round of the search in which the node was put to a frontier
+    std::vector<unsigned> queued;
+    unsigned round{0};
 
-    std::unordered_map<CDNode *, Info> data;
+    bool isColored(const CDNode *nd, const CDNode *target) const {
+        return color[nd->getID()] == target->getID();
+    }
+
+    void enqueue(CDNode *nd, std::vector<CDNode *> &frontier) {
+        if (queued[nd->getID()] != round) {
+            queued[nd->getID()] = round;
+            frontier.push_back(nd);
+        }
+    }
 
     void compute(CDGraph &graph, CDNode *target, ResultT &CD, ResultT &revCD) {
-        std::set<CDNode *> frontier;
-        std::set<CDNode *> new_frontier;
+        std::vector<CDNode *> frontier;
+        std::vector<CDNode *> new_frontier;
 
         // color the target node
-        data[target].color = target->getID();
+        color[target->getID()] = target->getID();
+        ++round;
         for (auto *pred : target->predecessors()) {
-            if (data[pred].color != target->getID()) {
-                frontier.insert(pred);
+            if (!isColored(pred, target)) {
+                enqueue(pred, frontier);
             }
         }
 
@@ -37,13 +53,14 @@ class NTSCD {
         do {
             progress = false;
             new_frontier.clear();
+            ++round;
 
             for (auto *nd : frontier) {
                 assert(!nd->successors().empty());
                 // do all successors have the right color?
                 bool colorit = true;
                 for (auto *succ : nd->successors()) {
-                    if (data[succ].color != target->getID()) {
+                    if (!isColored(succ, target)) {
                         colorit = false;
                         break;
                     }
@@ -51,16 +68,16 @@ class NTSCD {
 
                 // color the node and enqueue its predecessors
                 if (colorit) {
-                    data[nd].color = target->getID();
+                    color[nd->getID()] = target->getID();
                     for (auto *pred : nd->predecessors()) {
-                        if (data[pred].color != target->getID()) {
-                            new_frontier.insert(pred);
+                        if (!isColored(pred, target)) {
+                            enqueue(pred, new_frontier);
                         }
                     }
                     progress = true;
                 } else {
                     // re-queue the node as nothing happend
-                    new_frontier.insert(nd);
+                    enqueue(nd, new_frontier);
                 }
             }
 
@@ -69,75 +86,104 @@ class NTSCD {
 
         // iterate over frontier set, not over predicates -- only
         // the predicates that are in the frontier set may have colored
-        // and uncolored successors
+        // and uncolored successors. The target is not in the frontier,
+        // but it can depend on itself if it is a predicate on a cycle.
+        frontier.push_back(target);
         for (auto *predicate : frontier) {
             if (!graph.isPredicate(*predicate))
                 continue;
             bool has_colored = false;
             bool has_uncolored = false;
             for (auto *succ : predicate->successors()) {
-                if (data[succ].color == target->getID())
+                if (isColored(succ, target))
                     has_colored = true;
-                if (data[succ].color != target->getID())
+                else
                     has_uncolored = true;
             }
 
             if (has_colored && has_uncolored) {
-                CD[target].insert(predicate);
-                revCD[predicate].insert(target);
+                CD.add(target, predicate);
+                revCD.add(predicate, target);
             }
         }
     }
 
   public:
-    // returns control dependencies and reverse control dependencies
-    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+    // returns control dependencies and reverse control dependencies.
+    // If acyclicFastPath is set, the dependencies of nodes that do not
+    // reach any cycle are computed from post-dominators (see AcyclicCD)
+    std::pair<ResultT, ResultT> compute(CDGraph &graph,
+                                        bool acyclicFastPath = true) {
+        ResultT CD(graph);
+        ResultT revCD(graph);
+
+        AcyclicCD acyclic;
+        if (acyclicFastPath) {
+            acyclic.compute(graph);
+            acyclic.computeDependencies(graph, CD, revCD);
+        }
 
-        data.reserve(graph.size());
+        // IDs of nodes start from 1, so 0 is no color
+        color.assign(graph.size() + 1, 0);
+        queued.assign(graph.size() + 1, 0);
+        round = 0;
 
         for (auto *nd : graph) {
+            if (acyclicFastPath && !acyclic.reachesCycle(nd))
+                continue;
             compute(graph, nd, CD, revCD);
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
 class NTSCD2 {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
-
-    struct Info {
-        unsigned colored{false};
-        unsigned short counter;
-    };
+    using ResultT = CDRelation;
+    using WordT = uint64_t;
+    static const size_t BITS_IN_WORD = sizeof(WordT) * 8;
+
+    // the per-node state is kept in separate arrays indexed by IDs
+    // of nodes, so that it can be reset for every target by a single
+    // sweep over the memory
+    std::vector<unsigned short> successorsNum;
+    std::vector<unsigned short> counter;
+    std::vector<WordT> colored;
+
+    bool isColored(const CDNode *nd) const {
+        auto id = nd->getID();
+        return colored[id / BITS_IN_WORD] & (WordT{1} << (id % BITS_IN_WORD));
+    }
 
-    std::unordered_map<CDNode *, Info> data;
+    void setColored(const CDNode *nd) {
+        auto id = nd->getID();
+        colored[id / BITS_IN_WORD] |= WordT{1} << (id % BITS_IN_WORD);
+    }
 
-    void compute(CDGraph &graph, CDNode *target) {
+    void compute(CDNode *target, ADT::QueueLIFO<CDNode *> &queue) {
         // initialize nodes
-        for (auto *nd : graph) {
-            auto &D = data[nd];
-            D.colored = false;
-            D.counter = nd->successors().size();
-        }
+        std::copy(successorsNum.begin(), successorsNum.end(), counter.begin());
+        std::fill(colored.begin(), colored.end(), 0);
 
         // initialize the search
-        data[target].colored = true;
-        ADT::QueueLIFO<CDNode *> queue;
+        setColored(target);
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
             auto *node = queue.pop();
-            assert(data[node].colored && "A non-colored node in queue");
+            assert(isColored(node) && "A non-colored node in queue");
 
             for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
-                --D.counter;
-                if (D.counter == 0) {
-                    D.colored = true;
+                // the target is colored from the beginning, do not
+                // color it (and its predecessors) again when we get
+                // to it through a cycle
+                if (pred == target)
+                    continue;
+                auto &C = counter[pred->getID()];
+                --C;
+                if (C == 0) {
+                    setColored(pred);
                     queue.push(pred);
                 }
             }
@@ -145,34 +191,62 @@ class NTSCD2 {
     }
 
   public:
-    // returns control dependencies and reverse control dependencies
-    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+    // returns control dependencies and reverse control dependencies.
+    // If acyclicFastPath is set, the dependencies of nodes that do not
+    // reach any cycle are computed from post-dominators (see AcyclicCD)
+    std::pair<ResultT, ResultT> compute(CDGraph &graph,
+                                        bool acyclicFastPath = true) {
+        ResultT CD(graph);
+        ResultT revCD(graph);
+
+        AcyclicCD acyclic;
+        std::vector<CDNode *> predicates;
+        if (acyclicFastPath) {
+            acyclic.compute(graph);
+            acyclic.computeDependencies(graph, CD, revCD);
+            // the nodes that reach a cycle depend only on predicates
+            // that reach a cycle
+            for (auto *predicate : graph.predicates()) {
+                if (acyclic.reachesCycle(predicate))
+                    predicates.push_back(predicate);
+            }
+        } else {
+            predicates.assign(graph.predicates_begin(),
+                              graph.predicates_end());
+        }
 
-        data.reserve(graph.size());
+        successorsNum.assign(graph.size() + 1, 0);
+        for (auto *nd : graph) {
+            successorsNum[nd->getID()] = nd->successors().size();
+        }
+        counter.resize(successorsNum.size());
+        colored.resize(successorsNum.size() / BITS_IN_WORD + 1);
 
+        ADT::QueueLIFO<CDNode *> queue;
         for (auto *nd : graph) {
-            compute(graph, nd);
+            if (acyclicFastPath && !acyclic.reachesCycle(nd))
+                continue;
 
-            for (auto *predicate : graph.predicates()) {
+            compute(nd, queue);
+
+            for (auto *predicate : predicates) {
                 bool has_colored = false;
                 bool has_uncolored = false;
                 for (auto *succ : predicate->successors()) {
-                    if (data[succ].colored)
+                    if (isColored(succ))
                         has_colored = true;
-                    if (!data[succ].colored)
+                    else
                         has_uncolored = true;
                 }
 
                 if (has_colored && has_uncolored) {
-                    CD[nd].insert(predicate);
-                    revCD[predicate].insert(nd);
+                    CD.add(nd, predicate);
+                    revCD.add(predicate, nd);
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -181,7 +255,7 @@ class NTSCD2 {
 /// can compute incorrect results (it behaves differently when
 /// LIFO or FIFO or some other type of queue is used).
 class NTSCDRanganath {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRelation;
 
     // symbol t_{mn}
     struct Symbol : public std::pair<CDNode *, CDNode *> {
@@ -248,8 +322,8 @@ class NTSCDRanganath {
     // the workbag and so on.
     std::pair<ResultT, ResultT> compute(CDGraph &graph,
                                         bool doFixpoint = true) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph);
+        ResultT revCD(graph);
 
         S.reserve(2 * graph.predicates().size());
 
@@ -295,13 +369,13 @@ class NTSCDRanganath {
                 //    symb.second->getID() << ")");
                 //}
                 if (!Snp.empty() && Snp.size() < p->successors().size()) {
-                    CD[n].insert(p);
-                    revCD[p].insert(n);
+                    CD.add(n, p);
+                    revCD.add(p, n);
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -3,7 +3,7 @@ namespace dg {
 namespace debug {
 
 unsigned _debug_lvl = 0;
-unsigned _ind = 0;
+thread_local unsigned _ind = 0;
 
 } // namespace debug
 } // namespace dg
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <chrono>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "dg/ADT/Bitvector.h"
@@ -6,6 +9,7 @@
 //#include "dg/BBlocksBuilder.h"
 
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
 
 namespace dg {
 namespace dda {
@@ -14,17 +18,38 @@ namespace dda {
 // class MemorySSATransformation
 /// ------------------------------------------------------------------
 
+namespace {
+// count a query for definitions and measure its time
+class QueryProfiler {
+    using Clock = std::chrono::steady_clock;
+    MemorySSATransformation::Profile *_profile;
+    Clock::time_point _start;
+
+  public:
+    QueryProfiler(MemorySSATransformation::Profile *profile)
+            : _profile(profile) {
+        if (_profile) {
+            ++_profile->queries;
+            _start = Clock::now();
+        }
+    }
+
+    ~QueryProfiler() {
+        if (_profile)
+            _profile->time += Clock::now() - _start;
+    }
+
+    QueryProfiler(const QueryProfiler &) = delete;
+    QueryProfiler &operator=(const QueryProfiler &) = delete;
+};
+} // anonymous namespace
+
 // find definitions of a given node
 std::vector<RWNode *> MemorySSATransformation::findDefinitions(RWNode *node) {
     DBG_SECTION_BEGIN(dda, "Searching definitions for node " << node->getID());
 
     assert(node->isUse() && "Searching definitions for non-use node");
 
-    // handle reads from unknown memory
-    if (node->usesUnknown()) {
-        return findAllDefinitions(node);
-    }
-
     auto *block = node->getBBlock();
     if (!block) {
         // no basic block means that this node is either
@@ -35,12 +60,36 @@ std::vector<RWNode *> MemorySSATransformation::findDefinitions(RWNode *node) {
         return {};
     }
 
+    QueryProfiler profiler(profile(block->getSubgraph()));
+
+    // handle reads from unknown memory
+    if (node->usesUnknown()) {
+        return findAllDefinitions(node);
+    }
+
     // gather all definitions from the beginning of the block
     // to the node (we must do that always, because adding PHI
     // nodes changes the definitions)
-    auto D = findDefinitionsInBlock(node);
-    std::vector<RWNode *> defs;
+    auto defs = findDefinitions(node, findDefinitionsInBlock(node));
+
+    DBG_SECTION_END(dda,
+                    "Done searching definitions for node " << node->getID());
+    return defs;
+}
+
+// find definitions of a given node, 'D' are the definitions
+// from the beginning of the block of the node up to the node
+std::vector<RWNode *>
+MemorySSATransformation::findDefinitions(RWNode *node, const Definitions &D) {
+    auto *block = node->getBBlock();
+    assert(block && "Need bblock");
 
+    // remember which phi nodes existed before the search
+    const auto &si = getSubgraphInfo(block->getSubgraph());
+    auto phisNum = _phis.size();
+    auto newPhisNum = si._newPhis.size();
+
+    std::vector<RWNode *> defs;
     for (const auto &ds : node->getUses()) {
         assert(ds.target && "Target is null");
 
@@ -55,11 +104,150 @@ std::vector<RWNode *> MemorySSATransformation::findDefinitions(RWNode *node) {
         addUncoveredFromPredecessors(block, D, ds, defs);
     }
 
-    DBG_SECTION_END(dda,
-                    "Done searching definitions for node " << node->getID());
+    auto replaced = removeTrivialPhis(
+            getPhisCreatedAfter(phisNum, newPhisNum, si));
+    for (auto &def : defs) {
+        auto it = replaced.find(def);
+        if (it != replaced.end())
+            def = it->second;
+    }
+
     return defs;
 }
 
+///
+// Find definitions of all uses in the block that do not have them yet.
+// This is the same as calling findDefinitions() for each of the uses,
+// but the LVN is performed only once for the whole block. Only when
+// the search for a use places phi nodes into the block (or removes them),
+// the LVN for the next use starts again from the beginning of the block.
+void MemorySSATransformation::computeDefinitions(RWBBlock *block) {
+    const auto &bi = getBBlockInfo(block);
+    Definitions D;
+    // D are the definitions from the beginning of the block up to 'node'
+    bool valid = false;
+
+    for (auto *node : block->getNodes()) {
+        if (node->isUse() && !node->defuse.initialized()) {
+            QueryProfiler profiler(profile(block->getSubgraph()));
+            auto numNodes = block->size();
+            auto numTrivialPhis = bi.getTrivialPhis().size();
+            if (node->usesUnknown()) {
+                node->addDefUse(findAllDefinitions(node));
+            } else {
+                if (!valid) {
+                    D = findDefinitionsInBlock(node);
+                    valid = true;
+                }
+                node->addDefUse(findDefinitions(node, D));
+            }
+            assert(node->defuse.initialized());
+
+            if (block->size() != numNodes ||
+                bi.getTrivialPhis().size() != numTrivialPhis) {
+                valid = false;
+            }
+        }
+
+        if (valid)
+            D.update(node);
+    }
+}
+
+std::vector<RWNode *>
+MemorySSATransformation::getPhisCreatedAfter(size_t phis, size_t newPhis,
+                                             const SubgraphInfo &si) const {
+    std::vector<RWNode *> ret(_phis.begin() + phis, _phis.end());
+    for (auto i = newPhis; i < si._newPhis.size(); ++i)
+        ret.push_back(si._newPhis[i].get());
+    return ret;
+}
+
+///
+// A phi node is trivial if it has only one definition except itself
+// (e.g., a phi node at the header of a loop that does not write the memory).
+// Removing a trivial phi node can make other phi nodes trivial, so we repeat
+// the search until nothing changes. We remove only the phi nodes placed
+// at the beginning of blocks, the input and output phi nodes of calls
+// and procedures are referenced from the summaries.
+std::unordered_map<RWNode *, RWNode *>
+MemorySSATransformation::removeTrivialPhis(const std::vector<RWNode *> &phis) {
+    std::unordered_map<RWNode *, RWNode *> replaced;
+    auto resolve = [&replaced](RWNode *n) {
+        auto it = replaced.find(n);
+        while (it != replaced.end()) {
+            n = it->second;
+            it = replaced.find(n);
+        }
+        return n;
+    };
+
+    bool changed;
+    do {
+        changed = false;
+        for (auto *phi : phis) {
+            if (phi->getType() != RWNodeType::PHI || replaced.count(phi) > 0)
+                continue;
+
+            RWNode *same = nullptr;
+            bool trivial = true;
+            for (auto *def : phi->defuse) {
+                def = resolve(def);
+                if (def == phi || def == same)
+                    continue;
+                if (same) {
+                    trivial = false;
+                    break;
+                }
+                same = def;
+            }
+
+            // phi nodes without definitions are not trivial,
+            // they represent the undefined memory
+            if (trivial && same) {
+                replaced[phi] = same;
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    if (replaced.empty())
+        return replaced;
+
+    for (auto &it : replaced) {
+        auto *phi = it.first;
+        it.second = resolve(it.second);
+
+        auto *block = phi->getBBlock();
+        assert(block && "Removing a phi node that is not in a block");
+        auto &nodes = block->getNodes();
+        nodes.erase(std::find(nodes.begin(), nodes.end(), phi));
+        phi->setBBlock(nullptr);
+
+        // the phi node is still in the definitions of the block
+        // and it still covers the memory, so that we do not create
+        // a new phi node for the memory again
+        auto &bi = getBBlockInfo(block);
+        bi.addTrivialPhi(phi, it.second);
+        auto &D = bi.getDefinitions();
+        for (const auto &ds : phi->getOverwrites()) {
+            D.definitions.replace(ds.target, phi, it.second);
+            D.kills.replace(ds.target, phi, it.second);
+        }
+
+        ++getSubgraphInfo(block->getSubgraph())._removedPhis;
+        DBG(dda, "Removed trivial PHI " << phi->getID() << " (replaced by "
+                                        << it.second->getID() << ")");
+    }
+
+    for (auto *phi : phis) {
+        if (replaced.count(phi) == 0)
+            phi->defuse.rewrite(resolve);
+    }
+
+    return replaced;
+}
+
 // find definitions of a given node
 std::vector<RWNode *>
 MemorySSATransformation::findDefinitions(RWNode *node, const DefSite &ds) {
@@ -91,11 +279,23 @@ MemorySSATransformation::findDefinitions(RWNode *node, const DefSite &ds) {
     return defs;
 }
 
-RWNode *MemorySSATransformation::createPhi(const DefSite &ds, RWNodeType type) {
+RWNode *MemorySSATransformation::createPhi(const DefSite &ds, RWNodeType type,
+                                           RWSubgraph *subg) {
     // This phi is the definition that we are looking for.
-    _phis.emplace_back(&graph.create(type));
-    auto *phi = _phis.back();
+    RWNode *phi;
+    auto *si = subg ? &getSubgraphInfo(subg) : nullptr;
+    if (si && si->_collectPhis) {
+        // other threads may be creating phi nodes in other subgraphs,
+        // so we cannot create the node in the graph now
+        si->_newPhis.emplace_back(new RWNode(0, type));
+        phi = si->_newPhis.back().get();
+    } else {
+        _phis.emplace_back(&graph.create(type));
+        phi = _phis.back();
+    }
     assert(phi->isPhi() && "Got wrong type");
+    if (auto *p = profile(subg))
+        ++p->phis;
 
     phi->addOverwrites(ds);
 
@@ -104,8 +304,8 @@ RWNode *MemorySSATransformation::createPhi(const DefSite &ds, RWNodeType type) {
 }
 
 RWNode *MemorySSATransformation::createPhi(Definitions &D, const DefSite &ds,
-                                           RWNodeType type) {
-    auto *phi = createPhi(ds, type);
+                                           RWNodeType type, RWSubgraph *subg) {
+    auto *phi = createPhi(ds, type, subg);
 
     // update definitions in the block -- this
     // phi node defines previously uncovered memory
@@ -132,7 +332,7 @@ RWNode *MemorySSATransformation::createAndPlacePhi(RWBBlock *block,
                                                    const DefSite &ds) {
     // create PHI node and find definitions for the PHI node
     auto &D = getBBlockDefinitions(block, &ds);
-    auto *phi = createPhi(D, ds);
+    auto *phi = createPhi(D, ds, RWNodeType::PHI, block->getSubgraph());
     block->prepend(phi);
     return phi;
 }
@@ -159,9 +359,9 @@ void MemorySSATransformation::findDefinitionsInMultiplePredecessors(
         // this is the entry block, so we add a PHI node
         // representing "input" into this procedure
         // (but only if the input can be used from the called procedure)
-        phi = createPhi(getBBlockDefinitions(block, &ds), ds,
-                        /* type = */ RWNodeType::INARG);
         auto *subg = block->getSubgraph();
+        phi = createPhi(getBBlockDefinitions(block, &ds), ds,
+                        /* type = */ RWNodeType::INARG, subg);
         auto &summary = getSubgraphSummary(subg);
         summary.addInput(ds, phi);
 
@@ -220,7 +420,7 @@ void MemorySSATransformation::findPhiDefinitions(RWNode *phi) {
 }
 
 void MemorySSATransformation::addUncoveredFromPredecessors(
-        RWBBlock *block, Definitions &D, const DefSite &ds,
+        RWBBlock *block, const Definitions &D, const DefSite &ds,
         std::vector<RWNode *> &defs) {
     auto uncovered = D.uncovered(ds);
     for (auto &interval : uncovered) {
@@ -284,6 +484,8 @@ void MemorySSATransformation::findDefinitionsInSubgraph(RWNode *phi,
     auto &summary = getSubgraphSummary(subg);
     auto &si = getSubgraphInfo(subg);
     computeModRef(subg, si);
+    if (auto *p = profile(subg))
+        ++p->descents;
     assert(si.modref.isInitialized());
 
     // Add the definitions that we have found in previous exploration
@@ -303,8 +505,8 @@ void MemorySSATransformation::findDefinitionsInSubgraph(RWNode *phi,
         // before the call.
         if (!si.modref.mayDefine(ds.target)) {
             if (si.modref.mayDefineUnknown()) {
-                auto *subgphi =
-                        createPhi(subgds, /* type = */ RWNodeType::OUTARG);
+                auto *subgphi = createPhi(
+                        subgds, /* type = */ RWNodeType::OUTARG, subg);
                 summary.addOutput(subgds, subgphi);
                 for (const auto &it : si.modref.getMayDef(UNKNOWN_MEMORY)) {
                     subgphi->addDefUse(it);
@@ -316,7 +518,8 @@ void MemorySSATransformation::findDefinitionsInSubgraph(RWNode *phi,
             continue;
         }
 
-        auto *subgphi = createPhi(subgds, /* type = */ RWNodeType::OUTARG);
+        auto *subgphi =
+                createPhi(subgds, /* type = */ RWNodeType::OUTARG, subg);
         summary.addOutput(subgds, subgphi);
         phi->addDefUse(subgphi);
 
@@ -365,7 +568,8 @@ void MemorySSATransformation::fillDefinitionsFromCall(Definitions &D,
                 DefSite{ds.target, interval.start, interval.length()};
         // this phi will merge the definitions from all the
         // possibly called subgraphs
-        auto *phi = createPhi(D, uncoveredds, RWNodeType::CALLOUT);
+        auto *phi = createPhi(D, uncoveredds, RWNodeType::CALLOUT,
+                              C->getBBlock()->getSubgraph());
         C->getBBlock()->append(phi);
         C->addOutput(phi);
 
@@ -388,6 +592,9 @@ void MemorySSATransformation::fillDefinitionsFromCall(Definitions &D,
 void MemorySSATransformation::findDefinitionsFromCalledFun(RWNode *phi,
                                                            RWSubgraph *subg,
                                                            const DefSite &ds) {
+    if (auto *p = profile(subg))
+        ++p->callerSearches;
+
     for (auto *callsite : subg->getCallers()) {
         auto *C = RWNodeCall::get(callsite);
         assert(C && "Callsite is not a call");
@@ -396,7 +603,8 @@ void MemorySSATransformation::findDefinitionsFromCalledFun(RWNode *phi,
         assert(bblock && getBBlockInfo(bblock).isCallBlock());
 
         // create input PHI for this call
-        auto *callphi = createPhi(ds, RWNodeType::CALLIN);
+        auto *callphi =
+                createPhi(ds, RWNodeType::CALLIN, bblock->getSubgraph());
         bblock->insertBefore(callphi, C);
         C->addInput(callphi);
 
@@ -412,7 +620,8 @@ void MemorySSATransformation::findDefinitionsFromCalledFun(RWNode *phi,
         assert(bblock);
 
         // not sure if CALLIN is the thing to use, but it works
-        auto *callphi = createPhi(ds, RWNodeType::CALLIN);
+        auto *callphi =
+                createPhi(ds, RWNodeType::CALLIN, bblock->getSubgraph());
         bblock->insertBefore(callphi, F);
 
         phi->addDefUse(callphi);
@@ -467,6 +676,7 @@ void MemorySSATransformation::performLvn(Definitions &D, RWBBlock *block) {
     }
 
     D.setProcessed();
+    profileDefinitions(block->getSubgraph(), D);
     DBG_SECTION_END(dda, "LVN of block " << block->getID() << " finished");
 }
 
@@ -478,6 +688,15 @@ Definitions MemorySSATransformation::findDefinitionsInBlock(RWNode *to,
     auto *block = to->getBBlock();
     // perform LVN up to the node
     Definitions D;
+    // the removed trivial phi nodes were at the beginning of the block
+    for (const auto &it : getBBlockInfo(block).getTrivialPhis()) {
+        if (!mem || it.first->defines(mem)) {
+            for (const auto &ds : it.first->getOverwrites()) {
+                D.kills.add(ds, it.second);
+                D.definitions.update(ds, it.second);
+            }
+        }
+    }
     for (RWNode *node : block->getNodes()) {
         if (node == to)
             break;
@@ -486,6 +705,7 @@ Definitions MemorySSATransformation::findDefinitionsInBlock(RWNode *to,
         }
     }
 
+    profileDefinitions(block->getSubgraph(), D);
     return D;
 }
 
@@ -512,14 +732,20 @@ MemorySSATransformation::findEscapingDefinitionsInBlock(RWNode *to) {
 ///
 static void joinDefinitions(DefinitionsMap<RWNode> &from,
                             DefinitionsMap<RWNode> &to, bool escaping = false) {
+    if (!escaping && to.empty()) {
+        // share all the definitions with 'from'
+        to.add(from);
+        return;
+    }
+
     for (const auto &it : from) {
         if (escaping && !it.first->canEscape()) {
             continue;
         }
 
         if (!to.definesTarget(it.first)) {
-            // just copy the definitions
-            to.add(it.first, it.second);
+            // just copy the definitions (shares them with 'from')
+            to.addTarget(it.first, from);
             continue;
         }
 
@@ -633,12 +859,15 @@ void MemorySSATransformation::collectAllDefinitionsInCallers(Definitions &defs,
         return;
     }
 
+    if (auto *p = profile(subg))
+        ++p->callerSearches;
+
     // create an input PHI node
     auto &summary = getSubgraphSummary(subg);
     DefSite ds{UNKNOWN_MEMORY};
     RWNode *phi = summary.getUnknownPhi();
     if (!phi) {
-        phi = createPhi(ds, /* type = */ RWNodeType::INARG);
+        phi = createPhi(ds, /* type = */ RWNodeType::INARG, subg);
         summary.addInput(ds, phi);
     }
 
@@ -653,7 +882,8 @@ void MemorySSATransformation::collectAllDefinitionsInCallers(Definitions &defs,
             continue;
         }
 
-        callphi = createPhi(ds, RWNodeType::CALLIN);
+        callphi = createPhi(ds, RWNodeType::CALLIN,
+                            callsite->getBBlock()->getSubgraph());
         C->addUnknownInput(callphi);
         phi->addDefUse(callphi);
 
@@ -738,16 +968,107 @@ void MemorySSATransformation::computeAllDefinitions() {
     DBG_SECTION_BEGIN(dda, "Computing definitions for all uses (requested)");
     for (auto *subg : graph.subgraphs()) {
         for (auto *b : subg->bblocks()) {
+            computeDefinitions(b);
+        }
+    }
+    DBG_SECTION_END(dda, "Computing definitions for all uses finished");
+}
+
+bool MemorySSATransformation::isLocalUse(RWNode *use,
+                                         const std::vector<RWNodeCall *> &calls) {
+    if (use->usesUnknown())
+        return false;
+
+    auto *subg = use->getBBlock()->getSubgraph();
+    for (const auto &ds : use->getUses()) {
+        // the search would continue in the callers
+        if (canBeInput(ds.target, subg))
+            return false;
+        // the search would continue in the callees
+        for (auto *C : calls) {
+            if (callMayDefineTarget(C, ds.target))
+                return false;
+        }
+    }
+    return true;
+}
+
+void MemorySSATransformation::computeAllDefinitions(unsigned threads) {
+    DBG_SECTION_BEGIN(dda, "Computing definitions for all uses using "
+                                   << threads << " threads");
+
+    // with complete modref, checking whether a call may define
+    // some memory does not modify anything
+    computeAllModRefs(threads);
+
+    std::vector<RWSubgraph *> subgraphs;
+    for (auto *subg : graph.subgraphs()) {
+        getSubgraphInfo(subg)._collectPhis = true;
+        subgraphs.push_back(subg);
+    }
+
+    // Search the definitions of the uses that stay in their subgraph.
+    // Such a search modifies only the definitions in the blocks of the
+    // subgraph and creates phi nodes only in the subgraph. The other uses
+    // are searched afterwards in the order in which computeAllDefinitions()
+    // would search them. The worker bodies do not log, only the searches
+    // in them do (the indentation of debug sections is per thread).
+    std::vector<std::vector<RWNode *>> postponed(subgraphs.size());
+    DBG(dda, "Searching definitions of local uses in " << subgraphs.size()
+                                                       << " subgraphs");
+    parallelFor(subgraphs.size(), threads, [&](size_t i) {
+        auto &si = getSubgraphInfo(subgraphs[i]);
+        std::vector<RWNodeCall *> calls;
+        std::vector<RWNode *> uses;
+        for (auto *b : subgraphs[i]->bblocks()) {
+            auto &bi = si.getBBlockInfo(b);
+            if (bi.isCallBlock()) {
+                calls.push_back(bi.getCall());
+            } else if (!bi.getDefinitions().isProcessed()) {
+                performLvn(bi.getDefinitions(), b);
+            }
             for (auto *n : b->getNodes()) {
-                if (n->isUse()) {
-                    if (!n->defuse.initialized()) {
-                        n->addDefUse(findDefinitions(n));
-                        assert(n->defuse.initialized());
-                    }
-                }
+                if (n->isUse() && !n->defuse.initialized())
+                    uses.push_back(n);
+            }
+        }
+
+        for (auto *n : uses) {
+            if (isLocalUse(n, calls)) {
+                n->addDefUse(findDefinitions(n));
+                assert(n->defuse.initialized());
+            } else {
+                postponed[i].push_back(n);
+            }
+        }
+    });
+
+#ifdef DEBUG_ENABLED
+    size_t postponedNum = 0;
+    for (const auto &uses : postponed)
+        postponedNum += uses.size();
+    DBG(dda, "Searching local uses done, postponed " << postponedNum
+                                                     << " uses");
+#endif
+
+    // give the new phi nodes IDs in the order of subgraphs
+    for (auto *subg : subgraphs) {
+        auto &si = getSubgraphInfo(subg);
+        si._collectPhis = false;
+        for (auto &phi : si._newPhis)
+            _phis.push_back(&graph.adopt(std::move(phi)));
+        si._newPhis.clear();
+    }
+
+    for (auto &uses : postponed) {
+        for (auto *n : uses) {
+            if (!n->defuse.initialized()) {
+                n->addDefUse(findDefinitions(n));
+                assert(n->defuse.initialized());
             }
         }
     }
+
     DBG_SECTION_END(dda, "Computing definitions for all uses finished");
 }
 
@@ -755,32 +1076,128 @@ void MemorySSATransformation::initialize() {
     // we need each call (of a defined function) in its own basic block
     graph.splitBBlocksOnCalls();
     // remove useless blocks and nodes
-    graph.optimize();
+    if (options.removeUselessNodes)
+        graph.optimize();
 
     // make sure we have a constant-time access to information
     _subgraphs_info.reserve(graph.size());
 
     for (auto *subg : graph.subgraphs()) {
-        auto &si = _subgraphs_info[subg];
-        si._bblock_infos.reserve(subg->size());
-
-        // initialize information about basic blocks
-        for (auto *bb : subg->bblocks()) {
-            if (bb->size() == 1) {
-                if (auto *C = RWNodeCall::get(bb->getFirst())) {
-                    if (C->callsDefined()) {
-                        si._bblock_infos[bb].setCallBlock(C);
-                    }
+        initializeSubgraph(subg);
+    }
+}
+
+void MemorySSATransformation::initializeSubgraph(RWSubgraph *subg) {
+    auto &si = _subgraphs_info[subg];
+    si._bblock_infos.reserve(subg->size());
+
+    // initialize information about basic blocks
+    for (auto *bb : subg->bblocks()) {
+        if (bb->size() == 1) {
+            if (auto *C = RWNodeCall::get(bb->getFirst())) {
+                if (C->callsDefined()) {
+                    si._bblock_infos[bb].setCallBlock(C);
                 }
             }
         }
     }
 }
 
+void MemorySSATransformation::clearSubgraph(RWSubgraph *subg) {
+    for (auto *bb : subg->bblocks()) {
+        auto &nodes = bb->getNodes();
+        for (auto *node : nodes) {
+            if (node->isPhi()) {
+                node->setBBlock(nullptr);
+                continue;
+            }
+
+            node->defuse.clear();
+            if (auto *C = RWNodeCall::get(node))
+                C->clearInputsAndOutputs();
+        }
+
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(),
+                                   [](RWNode *n) { return n->isPhi(); }),
+                    nodes.end());
+    }
+
+    // this drops also the summary and the modref of the subgraph
+    _subgraphs_info.erase(subg);
+}
+
+std::vector<RWSubgraph *>
+MemorySSATransformation::getCallComponent(RWSubgraph *subg) {
+    std::vector<RWSubgraph *> component{subg};
+    std::set<RWSubgraph *> visited{subg};
+
+    auto push = [&](RWSubgraph *s) {
+        if (s && visited.insert(s).second)
+            component.push_back(s);
+    };
+    auto pushCaller = [&](RWNode *c) {
+        if (auto *bb = c->getBBlock())
+            push(bb->getSubgraph());
+    };
+
+    // the vector grows while we iterate over it
+    for (size_t i = 0; i < component.size(); ++i) {
+        auto *cur = component[i];
+        for (auto *c : cur->getCallers())
+            pushCaller(c);
+        for (auto *f : cur->getForkers())
+            pushCaller(f);
+
+        for (auto *bb : cur->bblocks()) {
+            for (auto *node : bb->getNodes()) {
+                if (auto *C = RWNodeCall::get(node)) {
+                    for (auto &cv : C->getCallees())
+                        push(cv.getSubgraph());
+                } else if (auto *F = RWNodeFork::get(node)) {
+                    for (auto &cv : F->getForkees())
+                        push(cv.getSubgraph());
+                }
+            }
+        }
+    }
+
+    return component;
+}
+
+void MemorySSATransformation::invalidate(RWSubgraph *subg) {
+    DBG_SECTION_BEGIN(dda, "Invalidating subgraph " << subg->getName());
+
+    // the summaries of the subgraphs are computed from the summaries
+    // of the called subgraphs and the inputs of the subgraphs from the
+    // definitions in the callers, so the change may propagate
+    // anywhere in the component
+    const auto &component = getCallComponent(subg);
+    for (auto *s : component) {
+        clearSubgraph(s);
+    }
+    // the phi nodes of the component were detached,
+    // their sets would stay cached forever
+    _collapsedPhis.clear();
+    _collapsedIntraprocPhis.clear();
+    for (auto *s : component) {
+        initializeSubgraph(s);
+    }
+
+    DBG_SECTION_END(dda, "Invalidated " << component.size() << " subgraphs");
+}
+
+void MemorySSATransformation::update(RWSubgraph *subg) {
+    subg->splitBBlocksOnCalls();
+    // the subgraph may call different subgraphs now
+    invalidate(subg);
+}
+
 RWNode *MemorySSATransformation::insertUse(RWNode *where, RWNode *mem,
                                            const Offset &off,
                                            const Offset &len) {
     // DBG_SECTION_BEGIN(dda, "Adding MU node");
+    assert(where->getBBlock() &&
+           "The node has no block (was it removed from the graph?)");
     auto &use = graph.create(RWNodeType::MU);
     use.addUse({mem, off, len});
     use.insertBefore(where);
@@ -790,56 +1207,102 @@ RWNode *MemorySSATransformation::insertUse(RWNode *where, RWNode *mem,
     return &use;
 }
 
-static void recGatherNonPhisDefs(RWNode *phi,
-                                 dg::ADT::SparseBitvectorHashImpl &phis,
-                                 dg::ADT::SparseBitvectorHashImpl &ret,
-                                 bool intraproc = false) {
-    assert(phi->isPhi());
-    // set returns the previous value, so if its 'true',
-    // we already had the phi
-    if (phis.set(phi->getID()))
-        return; // we already visited this phi
+///
+// Compute the sets of definitions for the phi nodes reachable from 'phi'
+// whose sets are not computed yet. The components of phi nodes are found
+// by Tarjan's algorithm, so every component is finished after all the
+// components that it uses.
+void MemorySSATransformation::CollapsedPhis::compute(RWNode *phi) {
+    std::unordered_map<const RWNode *, unsigned> dfsnum;
+    std::unordered_map<const RWNode *, unsigned> lowpt;
+    std::vector<RWNode *> stack;
+    std::set<const RWNode *> onStack;
+    // (phi node, next definition)
+    std::vector<std::pair<RWNode *, std::vector<RWNode *>::iterator>> visit;
+
+    auto discover = [&](RWNode *n) {
+        auto num = static_cast<unsigned>(dfsnum.size()) + 1;
+        dfsnum[n] = lowpt[n] = num;
+        stack.push_back(n);
+        onStack.insert(n);
+        visit.emplace_back(n, n->defuse.begin());
+    };
+
+    discover(phi);
+    while (!visit.empty()) {
+        auto *n = visit.back().first;
+        auto &next = visit.back().second;
+        if (next != n->defuse.end()) {
+            auto *def = *next;
+            ++next;
+            // the nodes with computed sets are finished
+            if (!collapses(def) || _setOf.count(def) > 0)
+                continue;
+            if (dfsnum.count(def) == 0)
+                discover(def);
+            else if (onStack.count(def) > 0)
+                lowpt[n] = std::min(lowpt[n], dfsnum[def]);
+            continue;
+        }
 
-    for (auto *n : phi->defuse) {
-        if (!n->isPhi()) {
-            ret.set(n->getID());
-        } else {
-            if (intraproc && n->isInOut()) {
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
+        visit.pop_back();
+        if (!visit.empty()) {
+            auto &parent = lowpt[visit.back().first];
+            parent = std::min(parent, lowpt[n]);
+        }
+        if (lowpt[n] != dfsnum[n])
+            continue;
+
+        // pop the component and gather its definitions
+        std::vector<RWNode *> component;
+        RWNode *member;
+        do {
+            member = stack.back();
+            stack.pop_back();
+            onStack.erase(member);
+            component.push_back(member);
+        } while (member != n);
+
+        std::vector<unsigned> defs;
+        for (auto *m : component) {
+            for (auto *def : m->defuse) {
+                if (!collapses(def)) {
+                    assert(def->getID() > 0);
+                    defs.push_back(def->getID());
+                    continue;
+                }
+                auto it = _setOf.find(def);
+                // the phi nodes from this component do not have a set yet
+                if (it != _setOf.end()) {
+                    const auto &S = _sets[it->second];
+                    defs.insert(defs.end(), S.begin(), S.end());
+                }
             }
         }
+        std::sort(defs.begin(), defs.end());
+        defs.erase(std::unique(defs.begin(), defs.end()), defs.end());
+
+        auto idx = static_cast<unsigned>(_sets.size());
+        _sets.push_back(std::move(defs));
+        for (auto *m : component)
+            _setOf[m] = idx;
     }
 }
 
-// recursivelu replace all phi values with its non-phi definitions
 template <typename ContT>
-std::vector<RWNode *> gatherNonPhisDefs(ReadWriteGraph *graph,
-                                        const ContT &nodes,
-                                        bool intraproc = false) {
+std::vector<RWNode *>
+MemorySSATransformation::gatherNonPhisDefs(const ContT &nodes,
+                                           bool intraproc) {
+    auto &collapsed = intraproc ? _collapsedIntraprocPhis : _collapsedPhis;
     dg::ADT::SparseBitvectorHashImpl ret; // use set to get rid of duplicates
-    dg::ADT::SparseBitvectorHashImpl
-            phis; // set of visited phi nodes - to check the fixpoint
-
-    for (auto n : nodes) {
-        if (!n->isPhi()) {
-            assert(n->getID() > 0);
-            ret.set(n->getID());
-        } else {
-            if (intraproc && n->isInOut()) {
-                assert(n->getID() > 0);
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
-            }
-        }
+    for (auto *n : nodes) {
+        collapsed.addDefinitions(n, ret);
     }
 
     std::vector<RWNode *> retval;
     retval.reserve(ret.size());
     for (auto i : ret) {
-        retval.push_back(graph->getNode(i));
+        retval.push_back(graph.getNode(i));
     }
     return retval;
 }
@@ -850,7 +1313,7 @@ std::vector<RWNode *> MemorySSATransformation::getDefinitions(RWNode *use) {
         use->addDefUse(findDefinitions(use));
         assert(use->defuse.initialized());
     }
-    return gatherNonPhisDefs(getGraph(), use->defuse);
+    return gatherNonPhisDefs(use->defuse);
 }
 
 // return the reaching definitions of ('mem', 'off', 'len')
@@ -858,6 +1321,11 @@ std::vector<RWNode *> MemorySSATransformation::getDefinitions(RWNode *use) {
 std::vector<RWNode *>
 MemorySSATransformation::getDefinitions(RWNode *where, RWNode *mem,
                                         const Offset &off, const Offset &len) {
+    // the node was removed from the graph as useless,
+    // we do not know where the query should take place
+    if (!where->getBBlock())
+        return {};
+
     auto *use = insertUse(where, mem, off, len);
     return getDefinitions(use);
 }
@@ -867,6 +1335,10 @@ void MemorySSATransformation::run() {
 
     initialize();
 
+    if (options.ddaThreads > 1) {
+        computeAllDefinitions(options.ddaThreads);
+    }
+
     // the rest is on-demand :)
 
     DBG_SECTION_END(dda, "Initializing MemorySSA analysis finished");
@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "dg/MemorySSA/MemorySSA.h"
+#include "dg/SCC.h"
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
 
 namespace dg {
 namespace dda {
@@ -27,47 +34,178 @@ void MemorySSATransformation::computeModRef(RWSubgraph *subg,
         return;
     }
 
-    DBG_SECTION_BEGIN(dda, "Computing modref for subgraph " << subg->getName());
+    // compute the modref of 'subg' and of all the subgraphs
+    // that it may call (bottom-up, so that the modref of
+    // recursive procedures is complete)
+    computeModRefs({subg}, /* threads = */ 1);
+    assert(si.modref.isInitialized());
+}
 
-    // set it here due to recursive procedures
-    si.modref.setInitialized();
+///
+// Compute modref of the subgraphs in a strongly connected component
+// of the call graph. All the subgraphs in the component call each other,
+// so the fixpoint of their modrefs is the same for all of them and it is
+// the union of the effects of the component. The components that are
+// called from this component must have been processed already.
+void MemorySSATransformation::computeSCCModRef(
+        const std::vector<RWSubgraph *> &scc) {
+    ModRefInfo modref;
+    for (auto *subg : scc) {
+        auto &si = getSubgraphInfo(subg);
+        for (auto *b : subg->bblocks()) {
+            auto &bi = si.getBBlockInfo(b);
+            if (!bi.isCallBlock()) {
+                // do not perform LVN if not needed, just scan the nodes
+                for (auto *node : b->getNodes()) {
+                    modRefAdd(modref.maydef, node->getDefines(), node, subg);
+                    modRefAdd(modref.maydef, node->getOverwrites(), node, subg);
+                    modRefAdd(modref.mayref, node->getUses(), node, subg);
+                }
+                continue;
+            }
 
-    // iterate over the blocks (note: not over the infos, those
-    // may not be created if the block was not used yet
-    for (auto *b : subg->bblocks()) {
-        auto &bi = si.getBBlockInfo(b);
-        if (bi.isCallBlock()) {
             auto *C = bi.getCall();
             for (auto &callee : C->getCallees()) {
                 auto *csubg = callee.getSubgraph();
                 if (csubg) {
+                    // the subgraphs from this component are handled
+                    // by this loop, the others are done already
                     auto &callsi = getSubgraphInfo(csubg);
-                    computeModRef(csubg, callsi);
-                    assert(callsi.modref.isInitialized());
-
-                    si.modref.add(callsi.modref);
+                    if (callsi.modref.isInitialized())
+                        modref.add(callsi.modref);
+                    else
+                        assert(std::find(scc.begin(), scc.end(), csubg) !=
+                                       scc.end() &&
+                               "The callee has not been processed");
                 } else {
                     // undefined function
-                    modRefAdd(si.modref.maydef,
+                    modRefAdd(modref.maydef,
                               callee.getCalledValue()->getDefines(), C, csubg);
-                    modRefAdd(si.modref.maydef,
+                    modRefAdd(modref.maydef,
                               callee.getCalledValue()->getOverwrites(), C,
                               csubg);
-                    modRefAdd(si.modref.mayref,
+                    modRefAdd(modref.mayref,
                               callee.getCalledValue()->getUses(), C, csubg);
                 }
             }
-        } else {
-            // do not perform LVN if not needed, just scan the nodes
-            for (auto *node : b->getNodes()) {
-                modRefAdd(si.modref.maydef, node->getDefines(), node, subg);
-                modRefAdd(si.modref.maydef, node->getOverwrites(), node, subg);
-                modRefAdd(si.modref.mayref, node->getUses(), node, subg);
+        }
+    }
+
+    modref.setInitialized();
+    for (auto *subg : scc) {
+        getSubgraphInfo(subg).modref = modref;
+    }
+}
+
+namespace {
+// a node of the call graph for computing SCCs of subgraphs
+class CallGraphNode {
+    std::vector<CallGraphNode *> _successors;
+    unsigned _scc_id{0};
+
+  public:
+    RWSubgraph *subgraph;
+
+    CallGraphNode(RWSubgraph *s = nullptr) : subgraph(s) {}
+
+    void addSuccessor(CallGraphNode *n) { _successors.push_back(n); }
+    const std::vector<CallGraphNode *> &successors() const {
+        return _successors;
+    }
+
+    void setSCCId(unsigned id) { _scc_id = id; }
+    unsigned getSCCId() const { return _scc_id; }
+};
+} // anonymous namespace
+
+void MemorySSATransformation::computeModRefs(
+        const std::vector<RWSubgraph *> &subgraphs, unsigned threads) {
+    DBG_SECTION_BEGIN(dda, "Computing modref bottom-up");
+
+    // build the call graph of the subgraphs whose modref is not computed
+    // yet (this also creates the infos for all blocks, so that the infos
+    // are not modified in parallel later). The root node calls all
+    // the given subgraphs.
+    CallGraphNode root;
+    std::unordered_map<RWSubgraph *, CallGraphNode> nodes;
+    std::vector<CallGraphNode *> queue;
+    auto getNode = [&](RWSubgraph *subg) -> CallGraphNode * {
+        if (getSubgraphInfo(subg).modref.isInitialized())
+            return nullptr;
+        auto it = nodes.find(subg);
+        if (it != nodes.end())
+            return &it->second;
+        auto *nd = &nodes.emplace(subg, CallGraphNode(subg)).first->second;
+        queue.push_back(nd);
+        return nd;
+    };
+
+    for (auto *subg : subgraphs) {
+        if (auto *nd = getNode(subg))
+            root.addSuccessor(nd);
+    }
+
+    while (!queue.empty()) {
+        auto *nd = queue.back();
+        queue.pop_back();
+
+        auto &si = getSubgraphInfo(nd->subgraph);
+        for (auto *b : nd->subgraph->bblocks()) {
+            auto &bi = si.getBBlockInfo(b);
+            if (!bi.isCallBlock())
+                continue;
+            for (auto &callee : bi.getCall()->getCallees()) {
+                if (auto *csubg = callee.getSubgraph()) {
+                    if (auto *cnd = getNode(csubg))
+                        nd->addSuccessor(cnd);
+                }
             }
         }
     }
-    DBG_SECTION_END(dda, "Computing modref for subgraph " << subg->getName()
-                                                          << " done");
+
+    // SCC numbers the components in the reverse topological order,
+    // so the callees come before their callers
+    SCC<CallGraphNode> scc;
+    auto &components = scc.compute(&root);
+    SCCCondensation<CallGraphNode> condensation(components);
+
+    // the components on the same level do not call each other,
+    // level 0 are the components that call no other components
+    std::vector<unsigned> levels(components.size(), 0);
+    std::vector<std::vector<unsigned>> byLevel;
+    for (unsigned c = 0; c < components.size(); ++c) {
+        if (components[c][0] == &root)
+            continue;
+
+        for (auto succ : condensation[c].successors())
+            levels[c] = std::max(levels[c], levels[succ] + 1);
+        if (levels[c] >= byLevel.size())
+            byLevel.resize(levels[c] + 1);
+        byLevel[levels[c]].push_back(c);
+    }
+
+    std::vector<std::vector<RWSubgraph *>> sccs(components.size());
+    for (unsigned c = 0; c < components.size(); ++c) {
+        for (auto *nd : components[c]) {
+            if (nd != &root)
+                sccs[c].push_back(nd->subgraph);
+        }
+    }
+
+    for (const auto &comps : byLevel) {
+        parallelFor(comps.size(), threads, [&](size_t i) {
+            computeSCCModRef(sccs[comps[i]]);
+        });
+    }
+
+    DBG_SECTION_END(dda, "Computing modref bottom-up done");
+}
+
+void MemorySSATransformation::computeAllModRefs(unsigned threads) {
+    std::vector<RWSubgraph *> subgraphs;
+    for (auto *subg : graph.subgraphs())
+        subgraphs.push_back(subg);
+    computeModRefs(subgraphs, threads);
 }
 
 } // namespace dda
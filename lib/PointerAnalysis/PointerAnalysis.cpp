@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "dg/PointerAnalysis/PointerAnalysis.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
+#include "dg/SCC.h"
 
 #include "dg/util/debug.h"
 
@@ -38,87 +45,97 @@ bool PointerAnalysis::processLoad(PSNode *node) {
     if (operand->pointsTo.empty())
         return error(operand, "Load's operand has no points-to set");
 
+    std::vector<MemoryObject *> objects;
     for (const Pointer &ptr : operand->pointsTo) {
-        if (ptr.isUnknown()) {
-            // load from unknown pointer yields unknown pointer
-            changed |= node->addPointsTo(UnknownPointer);
-            continue;
-        }
+        objects.clear();
+        changed |= loadFromPointer(node, ptr, node->pointsTo, objects);
+    }
 
-        if (!canBeDereferenced(ptr))
-            continue;
+    return changed;
+}
 
-        // find memory objects holding relevant points-to
-        // information
-        std::vector<MemoryObject *> objects;
-        getMemoryObjects(node, ptr, objects);
+bool PointerAnalysis::loadFromPointer(PSNode *node, const Pointer &ptr,
+                                      PointsToSetT &dst,
+                                      std::vector<MemoryObject *> &objects) {
+    bool changed = false;
 
-        PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
-        assert(target && "Target is not memory allocation");
+    if (ptr.isUnknown()) {
+        // load from unknown pointer yields unknown pointer
+        return dst.add(UnknownPointer);
+    }
 
-        // no objects found for this target? That is
-        // load from unknown memory
-        if (objects.empty()) {
-            if (target->isZeroInitialized())
-                // if the memory is zero initialized, then everything
-                // is fine, we add nullptr
-                changed |= node->addPointsTo(NullPointer);
-            else
-                changed |= errorEmptyPointsTo(node, target);
+    if (!canBeDereferenced(ptr))
+        return false;
 
-            continue;
-        }
+    // find memory objects holding relevant points-to
+    // information
+    getMemoryObjects(node, ptr, objects);
 
-        for (MemoryObject *o : objects) {
-            // is the offset to the memory unknown?
-            // In that case everything can be referenced,
-            // so we need to copy the whole points-to
-            if (ptr.offset.isUnknown()) {
-                // we should load from memory that has
-                // no pointers in it - it may be an error
-                // FIXME: don't duplicate the code
-                if (o->pointsTo.empty()) {
-                    if (target->isZeroInitialized())
-                        changed |= node->addPointsTo(NullPointer);
-                    else if (objects.size() == 1)
-                        changed |= errorEmptyPointsTo(node, target);
-                }
+    PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
+    assert(target && "Target is not memory allocation");
 
-                // we have some pointers - copy them all,
-                // since the offset is unknown
-                for (auto &it : o->pointsTo) {
-                    changed |= node->addPointsTo(it.second);
-                }
+    // no objects found for this target? That is
+    // load from unknown memory
+    if (objects.empty()) {
+        if (target->isZeroInitialized())
+            // if the memory is zero initialized, then everything
+            // is fine, we add nullptr
+            changed |= dst.add(NullPointer);
+        else
+            changed |= errorEmptyPointsTo(node, target);
 
-                // this is all that we can do here...
-                continue;
-            }
+        return changed;
+    }
 
-            // load from empty points-to set
-            // - that is load from unknown memory
-            auto it = o->pointsTo.find(ptr.offset);
-            if (it == o->pointsTo.end()) {
-                // if the memory is zero initialized, then everything
-                // is fine, we add nullptr
+    for (MemoryObject *o : objects) {
+        // is the offset to the memory unknown?
+        // In that case everything can be referenced,
+        // so we need to copy the whole points-to
+        if (ptr.offset.isUnknown()) {
+            // we should load from memory that has
+            // no pointers in it - it may be an error
+            // FIXME: don't duplicate the code
+            if (o->pointsTo.empty()) {
                 if (target->isZeroInitialized())
-                    changed |= node->addPointsTo(NullPointer);
-                // if we don't have a definition even with unknown offset
-                // it is an error
-                // FIXME: don't triplicate the code!
-                else if (!o->pointsTo.count(Offset::UNKNOWN))
+                    changed |= dst.add(NullPointer);
+                else if (objects.size() == 1)
                     changed |= errorEmptyPointsTo(node, target);
-            } else {
-                // we have pointers on that memory, so we can
-                // do the work
-                changed |= node->addPointsTo(it->second);
             }
 
-            // plus always add the pointers at unknown offset,
-            // since these can be what we need too
-            it = o->pointsTo.find(Offset::UNKNOWN);
-            if (it != o->pointsTo.end()) {
-                changed |= node->addPointsTo(it->second);
+            // we have some pointers - copy them all,
+            // since the offset is unknown
+            for (auto &it : o->pointsTo) {
+                changed |= dst.add(it.second);
             }
+
+            // this is all that we can do here...
+            continue;
+        }
+
+        // load from empty points-to set
+        // - that is load from unknown memory
+        auto it = o->pointsTo.find(ptr.offset);
+        if (it == o->pointsTo.end()) {
+            // if the memory is zero initialized, then everything
+            // is fine, we add nullptr
+            if (target->isZeroInitialized())
+                changed |= dst.add(NullPointer);
+            // if we don't have a definition even with unknown offset
+            // it is an error
+            // FIXME: don't triplicate the code!
+            else if (!o->pointsTo.count(Offset::UNKNOWN))
+                changed |= errorEmptyPointsTo(node, target);
+        } else {
+            // we have pointers on that memory, so we can
+            // do the work
+            changed |= dst.add(it->second);
+        }
+
+        // plus always add the pointers at unknown offset,
+        // since these can be what we need too
+        it = o->pointsTo.find(Offset::UNKNOWN);
+        if (it != o->pointsTo.end()) {
+            changed |= dst.add(it->second);
         }
     }
 
@@ -269,29 +286,32 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
     return changed;
 }
 
+Pointer PointerAnalysis::gepPointer(PSNodeGep *gep, const Pointer &ptr) const {
+    Offset::type new_offset;
+    if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
+        // set it like this to avoid overflow when adding
+        new_offset = Offset::UNKNOWN;
+    else
+        new_offset = *ptr.offset + *gep->getOffset();
+
+    // in the case PSNodeType::the memory has size 0, then every pointer
+    // will have unknown offset with the exception that it points
+    // to the begining of the memory - therefore make 0 exception
+    if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
+        new_offset < *options.fieldSensitivity)
+        return {ptr.target, new_offset};
+
+    return {ptr.target, Offset::UNKNOWN};
+}
+
 bool PointerAnalysis::processGep(PSNode *node) {
     bool changed = false;
 
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer &ptr : gep->getSource()->pointsTo) {
-        Offset::type new_offset;
-        if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
-            // set it like this to avoid overflow when adding
-            new_offset = Offset::UNKNOWN;
-        else
-            new_offset = *ptr.offset + *gep->getOffset();
-
-        // in the case PSNodeType::the memory has size 0, then every pointer
-        // will have unknown offset with the exception that it points
-        // to the begining of the memory - therefore make 0 exception
-        if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
-            new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
-        else
-            changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
-    }
+    for (const Pointer &ptr : gep->getSource()->pointsTo)
+        changed |= node->addPointsTo(gepPointer(gep, ptr));
 
     return changed;
 }
@@ -485,32 +505,463 @@ static void setToEmpty(std::vector<PSNode *> &nodes) {
     }
 }
 
-bool PointerAnalysis::run() {
-    DBG_SECTION_BEGIN(pta, "Running pointer analysis");
+///
+// Worklist solver with difference propagation. Every node remembers
+// the pointers that were added to its points-to set since the node was
+// taken from the worklist for the last time (the delta). When the node is
+// taken from the worklist, only the delta is pushed to the users of the node.
+// Loads are re-evaluated also when a memory object that they read from
+// changes. Nodes that do not merely transform the pointers of their operands
+// (e.g., calls via function pointers) are re-processed as a whole.
+//
+// If enabled, the solver also lazily detects cycles of copy edges
+// (edges from operands to casts, phis and returns) and collapses every
+// such cycle into a single representative node, as all nodes on the cycle
+// must have the same points-to set. The detection is triggered when
+// propagating pointers over a copy edge does not add anything new and
+// the points-to sets on both ends of the edge have the same size.
+class DiffPropagation {
+    PointerAnalysis *PA;
+    PointerGraph *PG;
+
+    struct NodeInfo {
+        // pointers that were not propagated to users yet
+        PointsToSetT delta;
+        // the node into which this node was collapsed (if any)
+        PSNode *rep{nullptr};
+        // nodes collapsed into this node
+        std::vector<PSNode *> members;
+        // the node is reachable from the entry of the program,
+        // only such nodes are processed
+        bool reachable{false};
+        // the node is in the worklist
+        bool queued{false};
+        // the node must be processed as a whole (not only its delta)
+        bool reprocess{false};
+        // the node was processed as a whole at least once
+        bool processed{false};
+    };
+
+    // indexed by the IDs of nodes. The graph can grow during the analysis,
+    // so never keep references to the elements across processing of nodes
+    std::vector<NodeInfo> _info;
+    std::vector<PSNode *> _worklist;
+    std::vector<PSNode *> _next;
+    // nodes that read the given memory object
+    std::map<MemoryObject *, std::set<PSNode *>> _readers;
+    // copy edges that were already checked for being on a cycle
+    std::set<std::pair<unsigned, unsigned>> _checkedEdges;
+
+    size_t _processed{0};
+
+    NodeInfo &info(const PSNode *n) {
+        if (n->getID() >= _info.size())
+            _info.resize(std::max(PG->getNodes().size(),
+                                  static_cast<size_t>(n->getID() + 1)));
+        return _info[n->getID()];
+    }
 
-    preprocess();
+    // get the node that represents 'n' (the node itself if it
+    // was not collapsed into another node)
+    PSNode *find(PSNode *n) {
+        PSNode *rep = info(n).rep;
+        return rep ? rep : n;
+    }
 
-    // check that the current state of pointer analysis makes sense
-    sanityCheck();
+    const PointsToSetT &ptsOf(PSNode *n) { return find(n)->pointsTo; }
+
+    bool isCopy(PSNode *n) const {
+        switch (n->getType()) {
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+            return true;
+        case PSNodeType::CALL_RETURN:
+            return !PA->options.invalidateNodes;
+        default:
+            return false;
+        }
+    }
 
-    // process global nodes, these must reach fixpoint after one iteration
-    DBG(pta, "Processing global nodes");
-    queue_globals();
-    iteration();
-    assert((to_process.clear(), changed.clear(), queue_globals(),
-            !iteration()) &&
-           "Globals did not reach fixpoint");
-    to_process.clear();
-    changed.clear();
+    void enqueue(PSNode *n) {
+        auto &I = info(n);
+        if (I.queued)
+            return;
+        I.queued = true;
+        _next.push_back(n);
+    }
 
-    initialize_queue();
+    void reprocess(PSNode *n) {
+        info(n).reprocess = true;
+        enqueue(n);
+    }
 
-    // override the pre-set value
-    if (options.maxIterations > 0) {
-        DBG(pta, "The maximal number of iterations is set to "
-                         << options.maxIterations);
+    // the graph may have changed, process everything
+    // that is reachable from the given node
+    void enqueueReachable(PSNode *from) {
+        for (PSNode *n : PG->getNodes(from)) {
+            info(n).reachable = true;
+            reprocess(n);
+        }
+    }
+
+    bool addDelta(PSNode *n, const Pointer &ptr) {
+        if (!n->addPointsTo(ptr))
+            return false;
+        info(n).delta.add(ptr);
+        enqueue(n);
+        return true;
+    }
+
+    bool addDelta(PSNode *n, const PointsToSetT &ptrs) {
+        bool changed = false;
+        for (const Pointer &ptr : ptrs)
+            changed |= addDelta(n, ptr);
+        return changed;
+    }
+
+    // the successors of a (representative) node in the graph of copy edges
+    std::vector<PSNode *> copySuccessors(PSNode *n) {
+        std::vector<PSNode *> succs;
+        auto addUsers = [&](PSNode *m) {
+            for (PSNode *user : m->getUsers()) {
+                if (!info(user).reachable || !isCopy(user))
+                    continue;
+                PSNode *rep = find(user);
+                if (rep != n)
+                    succs.push_back(rep);
+            }
+        };
+
+        addUsers(n);
+        // NOTE: copy the members, info() may reallocate
+        auto members = info(n).members;
+        for (PSNode *m : members)
+            addUsers(m);
+        return succs;
+    }
+
+    struct CopyEdges {
+        DiffPropagation *solver{nullptr};
+
+        std::vector<PSNode *> operator()(PSNode *n) const {
+            return solver->copySuccessors(n);
+        }
+    };
+
+    void collapse(const std::vector<PSNode *> &component) {
+        assert(component.size() > 1);
+
+        // use the node with the smallest ID to be deterministic
+        PSNode *rep = *std::min_element(component.begin(), component.end(),
+                                        [](PSNode *a, PSNode *b) {
+                                            return a->getID() < b->getID();
+                                        });
+
+        for (PSNode *n : component) {
+            if (n == rep)
+                continue;
+
+            assert(!info(n).rep && "Collapsing a collapsed node");
+            auto members = std::move(info(n).members);
+            info(n).members.clear();
+            members.push_back(n);
+            for (PSNode *m : members) {
+                info(m).rep = rep;
+                info(rep).members.push_back(m);
+            }
+
+            rep->addPointsTo(n->pointsTo);
+            info(n).delta.clear();
+            ++PA->collapsed_nodes_num;
+        }
+
+        // the users of the collapsed nodes may miss some pointers
+        // of the other nodes, propagate the whole set once again
+        info(rep).delta.add(rep->pointsTo);
+        enqueue(rep);
+
+        DBG(pta, "Collapsed " << component.size() << " nodes into node "
+                              << rep->getID());
+    }
+
+    // propagating pointers over the copy edge from -> to
+    // did not add anything new, check whether the edge is on a cycle
+    void checkCycle(PSNode *from, PSNode *to) {
+        if (from == to || !isCopy(from))
+            return;
+        if (from->pointsTo.size() != to->pointsTo.size())
+            return;
+        if (!_checkedEdges.emplace(from->getID(), to->getID()).second)
+            return;
+
+        SCC<PSNode, CopyEdges> scc(CopyEdges{this});
+        const auto &components = scc.compute(to);
+        // the component of the starting node is the last one
+        assert(!components.empty());
+        const auto &component = components.back();
+        if (component.size() > 1)
+            collapse(component);
     }
 
+    void objectChanged(MemoryObject *mo) {
+        auto it = _readers.find(mo);
+        if (it == _readers.end())
+            return;
+        for (PSNode *reader : it->second)
+            reprocess(reader);
+    }
+
+    void load(PSNode *node, const PointsToSetT &ptrs) {
+        PointsToSetT loaded;
+        std::vector<MemoryObject *> objects;
+        for (const Pointer &ptr : ptrs) {
+            objects.clear();
+            PA->loadFromPointer(node, ptr, loaded, objects);
+            for (MemoryObject *mo : objects)
+                _readers[mo].insert(node);
+        }
+
+        addDelta(node, loaded);
+    }
+
+    void store(PSNode *node, const PointsToSetT &values,
+               const PointsToSetT &ptrs) {
+        if (values.empty())
+            return;
+
+        std::vector<MemoryObject *> objects;
+        for (const Pointer &ptr : ptrs) {
+            assert(ptr.target && "Got nullptr as target");
+            if (!canBeDereferenced(ptr))
+                continue;
+
+            objects.clear();
+            PA->getMemoryObjects(node, ptr, objects);
+            for (MemoryObject *mo : objects) {
+                if (mo->addPointsTo(ptr.offset, values))
+                    objectChanged(mo);
+            }
+        }
+    }
+
+    void memoryObjectsOf(PSNode *node, PSNode *operand,
+                         std::vector<MemoryObject *> &objects) {
+        for (const Pointer &ptr : ptsOf(operand)) {
+            if (canBeDereferenced(ptr))
+                PA->getMemoryObjects(node, ptr, objects);
+        }
+    }
+
+    // the generic processing reads the points-to sets of operands directly,
+    // so make sure the collapsed operands have up-to-date points-to sets
+    void syncOperands(PSNode *node) {
+        for (PSNode *op : node->getOperands()) {
+            PSNode *rep = find(op);
+            if (rep != op)
+                op->addPointsTo(rep->pointsTo);
+        }
+    }
+
+    void processWhole(PSNode *node) {
+        bool first = !info(node).processed;
+        info(node).processed = true;
+
+        switch (node->getType()) {
+        case PSNodeType::LOAD:
+            load(node, ptsOf(node->getOperand(0)));
+            return;
+        case PSNodeType::STORE:
+            store(node, ptsOf(node->getOperand(0)),
+                  ptsOf(node->getOperand(1)));
+            return;
+        default:
+            break;
+        }
+
+        PointsToSetT old;
+        if (!first) {
+            PointsToSetT tmp(node->pointsTo);
+            old.swap(tmp);
+        }
+
+        syncOperands(node);
+
+        bool changed = false;
+        changed |= PA->beforeProcessed(node);
+        changed |= PA->processNode(node);
+        changed |= PA->afterProcessed(node);
+
+        std::vector<MemoryObject *> objects;
+        switch (node->getType()) {
+        case PSNodeType::MEMCPY: {
+            auto *memcpy = PSNodeMemcpy::get(node);
+            memoryObjectsOf(node, memcpy->getSource(), objects);
+            for (MemoryObject *mo : objects)
+                _readers[mo].insert(node);
+            if (changed) {
+                objects.clear();
+                memoryObjectsOf(node, memcpy->getDestination(), objects);
+                for (MemoryObject *mo : objects)
+                    objectChanged(mo);
+            }
+        } break;
+        case PSNodeType::CALL_FUNCPTR:
+        case PSNodeType::FORK:
+        case PSNodeType::JOIN:
+            // these may have changed the graph
+            if (changed)
+                enqueueReachable(node);
+            break;
+        default:
+            break;
+        }
+
+        bool hasDelta = false;
+        for (const Pointer &ptr : node->pointsTo) {
+            if (first || !old.has(ptr)) {
+                info(node).delta.add(ptr);
+                hasDelta = true;
+            }
+        }
+        if (hasDelta)
+            enqueue(node);
+    }
+
+    // push the new pointers 'delta' of 'node' (or of a node collapsed
+    // into 'node' if 'node' is a representative) to its user
+    void propagate(PSNode *node, const PointsToSetT &delta, PSNode *user) {
+        if (!info(user).reachable)
+            return;
+
+        switch (user->getType()) {
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+        case PSNodeType::CALL_RETURN:
+            if (isCopy(user)) {
+                PSNode *from = find(node);
+                PSNode *to = find(user);
+                if (!addDelta(to, delta) && PA->options.collapseCycles)
+                    checkCycle(from, to);
+            } else {
+                reprocess(user);
+            }
+            break;
+        case PSNodeType::GEP: {
+            auto *gep = PSNodeGep::get(user);
+            for (const Pointer &ptr : delta)
+                addDelta(user, PA->gepPointer(gep, ptr));
+        } break;
+        case PSNodeType::LOAD:
+            load(user, delta);
+            break;
+        case PSNodeType::STORE:
+            if (user->getOperand(0) == node)
+                store(user, delta, ptsOf(user->getOperand(1)));
+            if (user->getOperand(1) == node)
+                store(user, ptsOf(user->getOperand(0)), delta);
+            break;
+        default:
+            reprocess(user);
+        }
+    }
+
+    void propagateToUsers(PSNode *node, const PointsToSetT &delta) {
+        for (PSNode *user : node->getUsers())
+            propagate(node, delta, user);
+    }
+
+    void process(PSNode *node) {
+        ++_processed;
+
+        if (PSNode *rep = info(node).rep) {
+            // the node was collapsed, just pass the pointers
+            // of its operands to the representative
+            if (info(node).reprocess) {
+                info(node).reprocess = false;
+                for (PSNode *op : node->getOperands())
+                    addDelta(rep, ptsOf(op));
+            }
+            return;
+        }
+
+        if (info(node).reprocess) {
+            info(node).reprocess = false;
+            processWhole(node);
+        }
+
+        PointsToSetT delta;
+        delta.swap(info(node).delta);
+        if (delta.empty())
+            return;
+
+        propagateToUsers(node, delta);
+        // NOTE: copy the members, info() may reallocate
+        auto members = info(node).members;
+        for (PSNode *m : members)
+            propagateToUsers(m, delta);
+    }
+
+    // collapsed nodes must have the same points-to set
+    // as their representatives
+    void syncCollapsed() {
+        for (auto &I : _info) {
+            if (I.rep)
+                continue;
+            for (PSNode *m : I.members) {
+                assert(info(m).rep != nullptr);
+                m->addPointsTo(info(m).rep->pointsTo);
+            }
+        }
+    }
+
+  public:
+    DiffPropagation(PointerAnalysis *pa) : PA(pa), PG(pa->getPG()) {}
+
+    bool run() {
+        PSNode *root = PG->getEntry()->getRoot();
+        assert(root && "Do not have root of PG");
+
+        enqueueReachable(root);
+
+        const auto maxIterations = PA->options.maxIterations;
+        size_t n = 0;
+        while (!_next.empty()) {
+            if (maxIterations > 0 && n > maxIterations) {
+                DBG(pta, "Reached the maximum number of iterations: " << n);
+                syncCollapsed();
+                setToEmpty(_next);
+                return false;
+            }
+            ++n;
+
+            _worklist.swap(_next);
+            for (PSNode *node : _worklist) {
+                info(node).queued = false;
+                process(node);
+            }
+            _worklist.clear();
+        }
+
+        syncCollapsed();
+
+        DBG(pta, "Reached fixpoint after " << n << " rounds, processed "
+                                           << _processed << " nodes, collapsed "
+                                           << PA->collapsed_nodes_num
+                                           << " nodes");
+        return true;
+    }
+};
+
+bool PointerAnalysis::solveDiffPropagation() {
+    DiffPropagation solver(this);
+    return solver.run();
+}
+
+bool PointerAnalysis::solveIterative() {
+    initialize_queue();
+
     size_t n = 0;
     // do fixpoint
     do {
@@ -547,11 +998,46 @@ bool PointerAnalysis::run() {
     // unreachable from the point where the information is
     // generated, so this is OK.
 
+    return options.maxIterations > 0 ? n <= options.maxIterations : true;
+}
+
+bool PointerAnalysis::run() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis");
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    // process global nodes, these must reach fixpoint after one iteration
+    DBG(pta, "Processing global nodes");
+    queue_globals();
+    iteration();
+    assert((to_process.clear(), changed.clear(), queue_globals(),
+            !iteration()) &&
+           "Globals did not reach fixpoint");
+    to_process.clear();
+    changed.clear();
+
+    // override the pre-set value
+    if (options.maxIterations > 0) {
+        DBG(pta, "The maximal number of iterations is set to "
+                         << options.maxIterations);
+    }
+
+    bool ret;
+    if (options.diffPropagation && supportsDiffPropagation()) {
+        DBG(pta, "Using the difference propagation solver");
+        ret = solveDiffPropagation();
+    } else {
+        ret = solveIterative();
+    }
+
     sanityCheck();
 
     DBG_SECTION_END(pta, "Running pointer analysis done");
 
-    return options.maxIterations > 0 ? n <= options.maxIterations : true;
+    return ret;
 }
 
 } // namespace pta
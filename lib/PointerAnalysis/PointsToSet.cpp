@@ -1,5 +1,8 @@
 #include <functional>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "dg/PointerAnalysis/PSNode.h"
@@ -19,6 +22,14 @@ dg::PointerIDLookupTable PointerIdPointsToSet::lookupTable;
 std::map<PSNode *, size_t> SmallOffsetsPointsToSet::ids;
 std::map<PSNode *, size_t> AlignedSmallOffsetsPointsToSet::ids;
 std::map<Pointer, size_t> AlignedPointerIdPointsToSet::ids;
+dg::PointerIDLookupTable HashConsedPointsToSet::lookupTable;
+std::unordered_map<
+        size_t, std::vector<std::unique_ptr<HashConsedPointsToSet::InternedSet>>>
+        HashConsedPointsToSet::sets;
+std::unordered_map<HashConsedPointsToSet::UnionKeyT,
+                   HashConsedPointsToSet::Handle,
+                   HashConsedPointsToSet::UnionKeyHash>
+        HashConsedPointsToSet::unions;
 
 } // namespace pta
 
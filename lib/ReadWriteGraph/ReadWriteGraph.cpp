@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include "dg/BBlocksBuilder.h"
@@ -72,7 +74,153 @@ void RWNodeFork::addForkee(RWSubgraph *s) {
     s->addForker(this);
 }
 
-void ReadWriteGraph::removeUselessNodes() {}
+// can we remove the node that writes to memory if
+// the memory in 'used' is the only memory that is read?
+static bool
+isUselessNode(const RWNode *node,
+              const std::unordered_set<const RWNode *> &used) {
+    // calls, phis, returns, etc. are never useless. Keep also
+    // the nodes that read some memory, we want their definitions
+    if (node->getType() != RWNodeType::STORE &&
+        node->getType() != RWNodeType::GENERIC)
+        return false;
+    if (node->isUse() || !node->isDef())
+        return false;
+
+    auto isUsed = [&used](const DefSite &ds) {
+        // writes to unknown memory can define any memory and global
+        // variables may be read outside of the program
+        return ds.target->isUnknown() || ds.target->isGlobal() ||
+               used.count(ds.target) > 0;
+    };
+
+    return !dg::any_of(node->getDefines(), isUsed) &&
+           !dg::any_of(node->getOverwrites(), isUsed);
+}
+
+unsigned ReadWriteGraph::removeUselessNodes() {
+    // Gather the memory that is read anywhere in the program.
+    // The calls of undefined functions read the memory via the nodes
+    // that model them and the calls of defined functions via the nodes
+    // in the called subgraphs, so we can take every node in the graph.
+    std::unordered_set<const RWNode *> used;
+    for (const auto &nd : _nodes) {
+        for (const auto &ds : nd->getUses()) {
+            if (ds.target->isUnknown()) {
+                // any write may be read
+                DBG(dda, "Node " << nd->getID() << " reads unknown memory, "
+                                 << "not removing any nodes");
+                return 0;
+            }
+            used.insert(ds.target);
+        }
+    }
+
+    unsigned removed = 0;
+    for (auto &subg : _subgraphs) {
+        for (auto *bblock : subg->bblocks()) {
+            auto &nodes = bblock->getNodes();
+            auto it = nodes.begin();
+            while (it != nodes.end()) {
+                auto *node = *it;
+                // keep at least one node in the entry block,
+                // it is the root of the subgraph
+                if (!isUselessNode(node, used) ||
+                    (nodes.size() == 1 &&
+                     bblock == subg->getBBlocks().front().get())) {
+                    ++it;
+                    continue;
+                }
+
+                DBG(dda, "Removing useless node " << node->getID());
+                it = nodes.erase(it);
+                node->setBBlock(nullptr);
+                node->isolate();
+                _removedNodes.push_back(node);
+                ++removed;
+            }
+        }
+    }
+
+    return removed;
+}
+
+unsigned ReadWriteGraph::removeEmptyBBlocks() {
+    unsigned removed = 0;
+    for (auto &subg : _subgraphs) {
+        removed += subg->removeEmptyBBlocks();
+    }
+    return removed;
+}
+
+void ReadWriteGraph::optimize() {
+    DBG_SECTION_BEGIN(dda, "Optimizing the read-write graph");
+    auto nodes = removeUselessNodes();
+    auto blocks = removeEmptyBBlocks();
+    DBG_SECTION_END(dda, "Removed " << nodes << " nodes and " << blocks
+                                    << " blocks");
+    (void) nodes;
+    (void) blocks;
+}
+
+bool ReadWriteGraph::readsRemovedMemory(size_t num) const {
+    if (_removedNodes.empty())
+        return false;
+
+    std::unordered_set<const RWNode *> removed;
+    for (const auto *node : _removedNodes) {
+        for (const auto &ds : node->getDefines())
+            removed.insert(ds.target);
+        for (const auto &ds : node->getOverwrites())
+            removed.insert(ds.target);
+    }
+
+    for (auto i = num; i < _nodes.size(); ++i) {
+        for (const auto &ds : _nodes[i]->getUses()) {
+            if (ds.target->isUnknown() || removed.count(ds.target) > 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+void RWSubgraph::clear() {
+    for (auto *bblock : bblocks()) {
+        for (auto *node : bblock->getNodes()) {
+            node->setBBlock(nullptr);
+            if (auto *C = RWNodeCall::get(node)) {
+                for (auto &cv : C->getCallees()) {
+                    if (auto *subg = cv.getSubgraph())
+                        subg->removeCaller(C);
+                }
+            } else if (auto *F = RWNodeFork::get(node)) {
+                for (auto &cv : F->getForkees()) {
+                    if (auto *subg = cv.getSubgraph())
+                        subg->removeForker(F);
+                }
+            }
+        }
+    }
+    _bblocks.clear();
+}
+
+void RWSubgraph::registerCalls() {
+    for (auto *bblock : bblocks()) {
+        for (auto *node : bblock->getNodes()) {
+            if (auto *C = RWNodeCall::get(node)) {
+                for (auto &cv : C->getCallees()) {
+                    if (auto *subg = cv.getSubgraph())
+                        subg->addCaller(C);
+                }
+            } else if (auto *F = RWNodeFork::get(node)) {
+                for (auto &cv : F->getForkees()) {
+                    if (auto *subg = cv.getSubgraph())
+                        subg->addForker(F);
+                }
+            }
+        }
+    }
+}
 
 void RWSubgraph::buildBBlocks(bool /*dce*/) {
     assert(getRoot() && "No root node");
@@ -126,6 +274,34 @@ splitBlockOnFirstCall(RWBBlock *block,
     return nullptr;
 }
 
+unsigned RWSubgraph::removeEmptyBBlocks() {
+    if (_bblocks.empty())
+        return 0;
+
+    auto *entry = _bblocks[0].get();
+    auto oldsize = _bblocks.size();
+    auto removable = [entry](const std::unique_ptr<RWBBlock> &bblock) {
+        if (bblock.get() == entry || !bblock->empty())
+            return false;
+        // keep empty infinite loops
+        return !dg::any_of(bblock->successors(), [&bblock](RWBBlock *succ) {
+            return succ == bblock.get();
+        });
+    };
+
+    for (auto &bblock : _bblocks) {
+        if (removable(bblock)) {
+            bblock->isolate();
+        }
+    }
+    _bblocks.erase(std::remove_if(_bblocks.begin(), _bblocks.end(), removable),
+                   _bblocks.end());
+
+    assert(entry == _bblocks[0].get() &&
+           "removeEmptyBBlocks() changed the entry");
+    return oldsize - _bblocks.size();
+}
+
 void RWSubgraph::splitBBlocksOnCalls() {
     DBG_SECTION_BEGIN(dda, "Splitting basic blocks on calls");
     if (_bblocks.empty()) {
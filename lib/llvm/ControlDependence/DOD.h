@@ -6,6 +6,7 @@
 #include "GraphBuilder.h"
 #include "IGraphBuilder.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/parallel.h"
 
 #include "ControlDependence/DOD.h"
 #include "ControlDependence/DODNTSCD.h"
@@ -13,6 +14,7 @@
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class Function;
@@ -29,7 +31,7 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
     // for each p -> {a, b}, we have (p, a) and (p, b).
     // This has no effect on slicing. If we will need that in the future,
     // we can change this.
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = CDRelation;
 
     struct Info {
         CDGraph graph;
@@ -76,13 +78,9 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(f);
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(node);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence.get(node)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -113,13 +111,9 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(b->getParent());
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(block);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence.get(block)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -137,6 +131,8 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         DBG(cda, "Triggering computation of all dependencies");
         if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
             computeOnDemand(const_cast<llvm::Function *>(F));
+        } else if (getOptions().cdaThreads() > 1) {
+            computeParallel();
         } else {
             for (const auto &f : *getModule()) {
                 if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
@@ -177,6 +173,29 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
 
     void computeOnDemand(llvm::Function *F) {
         DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        _computeCD(_buildGraph(F));
+    }
+
+    // compute the dependencies of all the functions that were
+    // not computed yet using more threads. The graphs are built
+    // sequentially as the graph builder is shared, then the dependencies
+    // in every function are computed independently.
+    void computeParallel() {
+        std::vector<Info *> infos;
+        for (const auto &f : *getModule()) {
+            if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
+                infos.push_back(
+                        &_buildGraph(const_cast<llvm::Function *>(&f)));
+            }
+        }
+
+        DBG(cda, "Computing dependencies for " << infos.size()
+                                               << " functions in parallel");
+        parallelFor(infos.size(), getOptions().cdaThreads(),
+                    [&infos, this](size_t i) { _computeCD(*infos[i]); });
+    }
+
+    Info &_buildGraph(llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -184,9 +203,10 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
-
+    void _computeCD(Info &info) const {
         if (getOptions().dodRanganathCD()) {
             dg::DODRanganath dod;
             auto result = dod.compute(info.graph);
@@ -215,7 +235,7 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
     ICDGraphBuilder igraphBuilder{};
     CDGraph graph;
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = CDRelation;
     // forward edges (from branchings to dependent blocks)
     CDResultT controlDependence{};
     // reverse edges (from dependent blocks to branchings)
@@ -250,13 +270,9 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "CD is not computed");
-        auto dit = controlDependence.find(node);
-        if (dit == controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence.get(node)) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -282,13 +298,9 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "Did not compute CD");
-        auto dit = controlDependence.find(block);
-        if (dit == controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence.get(block)) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -6,12 +6,14 @@
 #include "GraphBuilder.h"
 #include "IGraphBuilder.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/parallel.h"
 
 #include "ControlDependence/NTSCD.h"
 
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class Function;
@@ -23,7 +25,7 @@ namespace llvmdg {
 class NTSCD : public LLVMControlDependenceAnalysisImpl {
     CDGraphBuilder graphBuilder{};
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = CDRelation;
 
     struct Info {
         CDGraph graph;
@@ -70,13 +72,9 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(f);
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(node);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence.get(node)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -109,13 +107,9 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(b->getParent());
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(block);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence.get(block)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -133,6 +127,8 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         DBG(cda, "Triggering computation of all dependencies");
         if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
             computeOnDemand(const_cast<llvm::Function *>(F));
+        } else if (getOptions().cdaThreads() > 1) {
+            computeParallel();
         } else {
             for (const auto &f : *getModule()) {
                 if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
@@ -173,6 +169,29 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
 
     void computeOnDemand(llvm::Function *F) {
         DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        _computeCD(_buildGraph(F));
+    }
+
+    // compute the dependencies of all the functions that were
+    // not computed yet using more threads. The graphs are built
+    // sequentially as the graph builder is shared, then the dependencies
+    // in every function are computed independently.
+    void computeParallel() {
+        std::vector<Info *> infos;
+        for (const auto &f : *getModule()) {
+            if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
+                infos.push_back(
+                        &_buildGraph(const_cast<llvm::Function *>(&f)));
+            }
+        }
+
+        DBG(cda, "Computing dependencies for " << infos.size()
+                                               << " functions in parallel");
+        parallelFor(infos.size(), getOptions().cdaThreads(),
+                    [&infos, this](size_t i) { _computeCD(*infos[i]); });
+    }
+
+    Info &_buildGraph(llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -180,9 +199,10 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
-
+    void _computeCD(Info &info) const {
         const auto &opts = getOptions();
         if (opts.ntscd2CD()) {
             DBG(cda, "Using the NTSCD 2 algorithm");
@@ -217,7 +237,7 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
     ICDGraphBuilder igraphBuilder{};
     CDGraph graph;
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = CDRelation;
     // forward edges (from branchings to dependent blocks)
     CDResultT controlDependence{};
     // reverse edges (from dependent blocks to branchings)
@@ -252,13 +272,9 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "CD is not computed");
-        auto dit = controlDependence.find(node);
-        if (dit == controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence.get(node)) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -284,13 +300,9 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "Did not compute CD");
-        auto dit = controlDependence.find(block);
-        if (dit == controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence.get(block)) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -7,6 +7,9 @@
 
 #include "dg/ADT/Queue.h"
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
+
+#include <vector>
 
 using namespace std;
 
@@ -72,7 +75,8 @@ class PostDominanceFrontiers {
     }
 };
 
-void SCD::computePostDominators(llvm::Function &F) {
+void SCD::computePostDominators(llvm::Function &F, BlocksMapT &dependencies,
+                                BlocksMapT &dependentBlocks) {
     DBG_SECTION_BEGIN(cda, "Computing post dominators for function "
                                    << F.getName().str());
     using namespace llvm;
@@ -135,5 +139,35 @@ void SCD::computePostDominators(llvm::Function &F) {
                                  << F.getName().str());
 }
 
+void SCD::computeParallel() {
+    std::vector<llvm::Function *> funs;
+    for (const auto &f : *getModule()) {
+        if (!f.isDeclaration() && _computed.insert(&f).second)
+            funs.push_back(const_cast<llvm::Function *>(&f));
+    }
+
+    struct Result {
+        BlocksMapT dependencies;
+        BlocksMapT dependentBlocks;
+    };
+    std::vector<Result> results(funs.size());
+
+    DBG(cda, "Computing post dominators for " << funs.size()
+                                              << " functions in parallel");
+    parallelFor(funs.size(), getOptions().cdaThreads(), [&](size_t i) {
+        computePostDominators(*funs[i], results[i].dependencies,
+                              results[i].dependentBlocks);
+    });
+
+    // merge the results in the order of functions, the blocks
+    // of different functions are different, so just move the sets
+    for (auto &R : results) {
+        for (auto &it : R.dependencies)
+            dependencies.emplace(it.first, std::move(it.second));
+        for (auto &it : R.dependentBlocks)
+            dependentBlocks.emplace(it.first, std::move(it.second));
+    }
+}
+
 } // namespace llvmdg
 } // namespace dg
@@ -25,17 +25,24 @@ namespace llvmdg {
 // This class uses purely LLVM, no internal representation
 // like the other classes (we use the post-dominance computation from LLVM).
 class SCD : public LLVMControlDependenceAnalysisImpl {
-    void computePostDominators(llvm::Function &F);
-
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependentBlocks;
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependencies;
+    using BlocksMapT = std::unordered_map<const llvm::BasicBlock *,
+                                          std::set<llvm::BasicBlock *>>;
+
+    static void computePostDominators(llvm::Function &F,
+                                      BlocksMapT &dependencies,
+                                      BlocksMapT &dependentBlocks);
+    // compute the dependencies of all the functions
+    // that were not computed yet using more threads
+    void computeParallel();
+
+    BlocksMapT dependentBlocks;
+    BlocksMapT dependencies;
     std::set<const llvm::Function *> _computed;
 
     void computeOnDemand(const llvm::Function *F) {
         if (_computed.insert(F).second) {
-            computePostDominators(*const_cast<llvm::Function *>(F));
+            computePostDominators(*const_cast<llvm::Function *>(F),
+                                  dependencies, dependentBlocks);
         }
     }
 
@@ -73,6 +80,8 @@ class SCD : public LLVMControlDependenceAnalysisImpl {
         DBG(cda, "Triggering computation of all dependencies");
         if (F && !F->isDeclaration()) {
             computeOnDemand(F);
+        } else if (getOptions().cdaThreads() > 1) {
+            computeParallel();
         } else {
             for (const auto &f : *getModule()) {
                 if (f.isDeclaration()) {
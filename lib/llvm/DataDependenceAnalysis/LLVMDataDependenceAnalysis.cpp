@@ -21,6 +21,39 @@ DataDependenceAnalysis *LLVMDataDependenceAnalysis::createDDA() {
     return new DataDependenceAnalysis(std::move(graph), _options);
 }
 
+void LLVMDataDependenceAnalysis::rebuild() {
+    delete builder;
+    builder = createBuilder();
+    DDA.reset(createDDA());
+    DDA->run();
+}
+
+bool LLVMDataDependenceAnalysis::update(const llvm::Function *F) {
+    assert(DDA && "The analysis has not been run");
+
+    auto *subg = builder->getSubgraph(F);
+    if (!subg || F->isDeclaration() || !builder->hasCalledSubgraphs(*F)) {
+        rebuild();
+        return false;
+    }
+
+    auto *G = getGraph();
+    auto numNodes = G->getNumOfNodes();
+
+    DDA->invalidate(subg);
+    builder->rebuildSubgraph(*G, *F);
+
+    // the new nodes may read the memory that the removed
+    // useless nodes wrote, we must not miss these definitions
+    if (G->readsRemovedMemory(numNodes)) {
+        rebuild();
+        return false;
+    }
+
+    DDA->update(subg);
+    return true;
+}
+
 RWNode *LLVMDataDependenceAnalysis::getNode(const llvm::Value *val) {
     return builder->getNode(val);
 }
@@ -46,6 +79,12 @@ std::vector<llvm::Value *> LLVMDataDependenceAnalysis::getLLVMDefinitions(
         return defs;
     }
 
+    if (!whereN->getBBlock()) {
+        llvm::errs() << "[DDA] error: the node was removed from the graph: "
+                     << *where << "\n";
+        return defs;
+    }
+
     auto *memN = getNode(mem);
     if (!memN) {
         llvm::errs() << "[DDA] error: no node for: " << *mem << "\n";
@@ -125,5 +164,45 @@ LLVMDataDependenceAnalysis::getLLVMDefinitions(llvm::Value *use) {
     return defs;
 }
 
+void LLVMDataDependenceAnalysis::addLLVMDefinitions(
+        LLVMDefinitionsBatch &batch, const llvm::BasicBlock &B) {
+    RWBBlock *lastBlock = nullptr;
+    for (const auto &I : B) {
+        auto *node = getNode(&I);
+        if (!node || !node->isUse())
+            continue;
+
+        // compute the definitions of all uses from the block at once
+        auto *block = node->getBBlock();
+        if (block && block != lastBlock) {
+            DDA->computeDefinitions(block);
+            lastBlock = block;
+        }
+
+        batch.addUse(&I);
+        for (RWNode *nd : getDefinitions(node)) {
+            assert(nd->getType() != RWNodeType::PHI);
+            const auto *llvmvalue = getValue(nd);
+            assert(llvmvalue && "Have no value for a node");
+            batch.addDefinition(const_cast<llvm::Value *>(llvmvalue));
+        }
+    }
+}
+
+LLVMDefinitionsBatch
+LLVMDataDependenceAnalysis::getLLVMDefinitionsBatch(const llvm::BasicBlock &B) {
+    LLVMDefinitionsBatch batch;
+    addLLVMDefinitions(batch, B);
+    return batch;
+}
+
+LLVMDefinitionsBatch
+LLVMDataDependenceAnalysis::getLLVMDefinitionsBatch(const llvm::Function &F) {
+    LLVMDefinitionsBatch batch;
+    for (const auto &B : F)
+        addLLVMDefinitions(batch, B);
+    return batch;
+}
+
 } // namespace dda
 } // namespace dg
@@ -64,7 +64,14 @@ void LLVMDefUseAnalysis::addDataDependencies(LLVMNode *node) {
     static std::set<const llvm::Value *> reported_mappings;
 
     auto *val = node->getValue();
-    auto defs = RD->getLLVMDefinitions(val);
+
+    // search the definitions of all uses in the block at once
+    auto *block = cast<Instruction>(val)->getParent();
+    if (block != _defsBlock) {
+        _blockDefs = RD->getLLVMDefinitionsBatch(*block);
+        _defsBlock = block;
+    }
+    auto defs = _blockDefs.getDefinitions(val);
 
     // add data dependence
     for (auto *def : defs) {
@@ -28,6 +28,10 @@ class LLVMDefUseAnalysis : public legacy::DataFlowAnalysis<LLVMNode> {
     LLVMPointerAnalysis *PTA;
     const llvm::DataLayout *DL;
 
+    // the definitions of the uses from the last queried block
+    const llvm::BasicBlock *_defsBlock{nullptr};
+    dda::LLVMDefinitionsBatch _blockDefs;
+
   public:
     LLVMDefUseAnalysis(LLVMDependenceGraph *dg, LLVMDataDependenceAnalysis *rd,
                        LLVMPointerAnalysis *pta);
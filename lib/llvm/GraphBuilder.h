@@ -1,9 +1,15 @@
 #ifndef DG_GRAPHBUILDER_H_
 #define DG_GRAPHBUILDER_H_
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <llvm/IR/CFG.h>
 #include <llvm/IR/Constants.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/ValueHandle.h>
 #include <llvm/Support/raw_os_ostream.h>
 
 #include "dg/ADT/SetQueue.h"
@@ -48,6 +54,10 @@ class GraphBuilder {
 
         SubgraphT &subgraph;
         BlocksMappingT blocks{};
+        // the instructions for which we built the nodes of the subgraph,
+        // the handles tell whether the instructions were deleted
+        // (a new instruction may be allocated at the same address)
+        std::vector<std::pair<const llvm::Value *, llvm::WeakVH>> values{};
 
         SubgraphInfo(SubgraphT &s) : subgraph(s) {}
         SubgraphInfo(SubgraphInfo &&) = default;
@@ -125,6 +135,8 @@ class GraphBuilder {
         subginfo.blocks[&B] = &bblock;
 
         for (const auto &I : B) {
+            subginfo.values.emplace_back(
+                    &I, const_cast<llvm::Instruction *>(&I));
             for (auto *node : buildNode(&I)) {
                 bblock.append(node);
             }
@@ -167,6 +179,44 @@ class GraphBuilder {
         DBG_SECTION_END(dg, "Building the subgraph done");
     }
 
+    ///
+    // Forget the blocks of the subgraph of 'F' and the mapping
+    // of its instructions to nodes, so that the subgraph can be built
+    // again by buildSubgraph() (e.g., after 'F' has been changed).
+    // The nodes of the instructions that are still in 'F' and for which
+    // 'keep' returns true are kept and used in the new subgraph.
+    template <typename KeepT>
+    void forgetSubgraph(const llvm::Function &F, KeepT keep) {
+        auto subgit = _subgraphs.find(&F);
+        assert(subgit != _subgraphs.end() && "Do not have that subgraph");
+        auto &subginfo = subgit->second;
+
+        // the old instructions may have been deleted already,
+        // do not touch them if they are not in 'F'
+        std::unordered_set<const llvm::Value *> current;
+        for (const auto &I : llvm::instructions(F))
+            current.insert(&I);
+
+        for (const auto &valAndHandle : subginfo.values) {
+            const auto *val = valAndHandle.first;
+            auto it = _nodes.find(val);
+            if (it == _nodes.end())
+                continue;
+            // the handle is null if the instruction was deleted,
+            // 'val' may be the address of a different instruction then
+            if (valAndHandle.second && current.count(val) > 0 &&
+                keep(val, it->second))
+                continue;
+
+            if (auto *repr = it->second.getRepresentant())
+                _nodeToValue.erase(repr);
+            _nodes.erase(it);
+        }
+
+        subginfo.values.clear();
+        subginfo.blocks.clear();
+    }
+
     void buildAllFuns() {
         DBG(dg, "Building all functions from LLVM module");
         for (const auto &F : *_module) {
@@ -188,10 +238,21 @@ class GraphBuilder {
     }
 
     void buildFunsFromCG(llvmdg::CallGraph *cg) {
-        const auto &funs = cg->functions();
+        auto funs = cg->functions();
         // we should have at least the entry fun
         assert(!funs.empty() && "No function in call graph");
 
+        // the order of functions in the call graph depends on pointers,
+        // build the subgraphs in the order from the module so that the
+        // graph (and the results of analyses) are the same in every run
+        std::unordered_map<const llvm::Function *, unsigned> order;
+        for (const auto &F : *_module)
+            order.emplace(&F, order.size());
+        std::sort(funs.begin(), funs.end(),
+                  [&order](const llvm::Function *a, const llvm::Function *b) {
+                      return order[a] < order[b];
+                  });
+
         for (const auto *F : funs) {
             DBG(dg, "Building functions based on call graph information");
             assert(_subgraphs.find(F) == _subgraphs.end() &&
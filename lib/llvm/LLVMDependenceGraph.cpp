@@ -1,6 +1,7 @@
 #include <set>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <llvm/Config/llvm-config.h>
 
@@ -54,6 +55,14 @@ getConstructedFunctions() {
 }
 
 LLVMDependenceGraph::~LLVMDependenceGraph() {
+    // forget the function, so that a graph built later for another
+    // module does not find this graph if the function's address is reused
+    if (LLVMNode *entry = getEntry()) {
+        auto it = constructedFunctions.find(entry->getKey());
+        if (it != constructedFunctions.end() && it->second == this)
+            constructedFunctions.erase(it);
+    }
+
     // delete nodes
     for (auto &I : *this) {
         LLVMNode *node = I.second;
@@ -903,34 +912,161 @@ bool LLVMDependenceGraph::getCallSites(const std::vector<std::string> &names,
 
 void LLVMDependenceGraph::computeNTSCD(
         const LLVMControlDependenceAnalysisOptions &opts) {
-    DBG_SECTION_BEGIN(llvmdg, "Filling in CDA edges (NTSCD)");
     dg::LLVMControlDependenceAnalysis ntscd(this->module, opts);
     assert(opts.ntscdCD() || opts.ntscd2CD());
+    // compute the dependencies for all the functions at once
+    // instead of on demand so that they are computed in parallel
+    if (opts.cdaThreads() > 1)
+        ntscd.compute();
 
+    addControlDependenceEdges(ntscd);
+}
+
+void LLVMDependenceGraph::addControlDependenceEdges(
+        LLVMControlDependenceAnalysis &ntscd) {
+    DBG_SECTION_BEGIN(llvmdg, "Filling in CDA edges (NTSCD)");
     for (const auto &it : getConstructedFunctions()) {
-        auto &blocks = it.second->getBlocks();
-        for (auto &BB : *llvm::cast<llvm::Function>(it.first)) {
-            auto *bb = blocks[&BB];
-            assert(bb);
-            for (auto *dep : ntscd.getDependencies(&BB)) {
-                auto *depbb = blocks[dep];
-                assert(depbb);
-                depbb->addControlDependence(bb);
+        it.second->addControlDependenceEdges(
+                ntscd, *llvm::cast<llvm::Function>(it.first));
+    }
+
+    DBG_SECTION_END(llvmdg, "Done computing CDA edges");
+}
+
+void LLVMDependenceGraph::addControlDependenceEdges(
+        LLVMControlDependenceAnalysis &ntscd, llvm::Function &F) {
+    auto &blocks = getBlocks();
+    for (auto &BB : F) {
+        auto *bb = blocks[&BB];
+        assert(bb);
+        for (auto *dep : ntscd.getDependencies(&BB)) {
+            auto *depbb = blocks[dep];
+            assert(depbb);
+            depbb->addControlDependence(bb);
+        }
+
+        for (auto &I : BB) {
+            for (auto *dep : ntscd.getDependencies(&I)) {
+                auto *depnd = getNode(dep);
+                assert(depnd);
+                auto *ind = getNode(&I);
+                assert(ind);
+                depnd->addControlDependence(ind);
             }
+        }
+    }
+}
 
-            for (auto &I : BB) {
-                for (auto *dep : ntscd.getDependencies(&I)) {
-                    auto *depnd = it.second->getNode(dep);
-                    assert(depnd);
-                    auto *ind = it.second->getNode(&I);
-                    assert(ind);
-                    depnd->addControlDependence(ind);
-                }
+struct LLVMDependenceGraph::OnDemandCD {
+    LLVMControlDependenceAnalysisOptions options;
+    // computes NTSCD of functions on demand (unused for standard CD)
+    std::unique_ptr<LLVMControlDependenceAnalysis> CDA;
+
+    OnDemandCD(llvm::Module *m,
+               const LLVMControlDependenceAnalysisOptions &opts)
+            : options(opts) {
+        if (!opts.standardCD())
+            CDA.reset(new LLVMControlDependenceAnalysis(m, opts));
+    }
+};
+
+void LLVMDependenceGraph::computeControlDependenciesOnDemand() {
+    if (!onDemandCD)
+        return;
+
+    // take the state, so that the dependencies are computed only once
+    auto state = std::move(onDemandCD);
+    assert(!onDemandCD);
+
+    auto *F = llvm::cast<llvm::Function>(getEntry()->getValue());
+    DBG_SECTION_BEGIN(llvmdg, "Computing control dependencies on demand for "
+                                      << F->getName().str());
+    if (state->options.standardCD()) {
+        computePostDominators(*F, true);
+    } else {
+        addControlDependenceEdges(*state->CDA, *F);
+    }
+    DBG_SECTION_END(llvmdg, "Done computing control dependencies for "
+                                    << F->getName().str());
+}
+
+void LLVMDependenceGraph::computePendingControlDependencies() {
+    for (const auto &F : getConstructedFunctions())
+        F.second->computeControlDependenciesOnDemand();
+}
+
+unsigned LLVMDependenceGraph::getPendingControlDependenciesNum() {
+    unsigned num = 0;
+    for (const auto &F : getConstructedFunctions()) {
+        if (F.second->onDemandCD)
+            ++num;
+    }
+    return num;
+}
+
+void LLVMDependenceGraph::freeze() {
+    if (frozenEdges)
+        return;
+
+    // the graphs of other modules may be frozen already
+    std::vector<LLVMDependenceGraph *> graphs;
+    for (const auto &F : getConstructedFunctions()) {
+        if (!F.second->frozenEdges)
+            graphs.push_back(F.second);
+    }
+
+    // the nodes of parameters are not in the graphs
+    std::vector<LLVMNode *> nodes;
+    std::set<LLVMDGParameters *> knownParams;
+    auto addPair = [&nodes](const DGParameterPair<LLVMNode> &pair) {
+        if (pair.in)
+            nodes.push_back(pair.in);
+        if (pair.out)
+            nodes.push_back(pair.out);
+    };
+    auto addParams = [&](LLVMDGParameters *params) {
+        if (!params || !knownParams.insert(params).second)
+            return;
+        for (const auto &par : *params)
+            addPair(par.second);
+        for (auto I = params->global_begin(), E = params->global_end(); I != E;
+             ++I)
+            addPair(I->second);
+        if (auto *vararg = params->getVarArg())
+            addPair(*vararg);
+        if (auto *noret = params->getNoReturn())
+            nodes.push_back(noret);
+    };
+
+    // the graphs share the global nodes
+    std::set<const ContainerType *> knownGlobals;
+    for (LLVMDependenceGraph *graph : graphs) {
+        addParams(graph->getParameters());
+        // the unified exit node may not be in the graph
+        LLVMNode *exit = graph->getExit();
+        if (exit && graph->getNode(exit->getKey()) != exit)
+            nodes.push_back(exit);
+        for (auto &it : *graph) {
+            if (LLVMNode *n = it.second) {
+                nodes.push_back(n);
+                addParams(n->getParameters());
+            }
+        }
+
+        const auto &globals = graph->getGlobalNodes();
+        if (globals && knownGlobals.insert(globals.get()).second) {
+            for (auto &it : *globals) {
+                nodes.push_back(it.second);
+                addParams(it.second->getParameters());
             }
         }
     }
 
-    DBG_SECTION_END(llvmdg, "Done computing CDA edges");
+    DBG(llvmdg, "Freezing edges of " << nodes.size() << " nodes");
+    auto frozen = FrozenEdges<LLVMNode>::freeze(nodes);
+    for (LLVMDependenceGraph *graph : graphs)
+        graph->frozenEdges = frozen;
+    frozenEdges = frozen;
 }
 
 void LLVMDependenceGraph::computeNonTerminationControlDependencies() {
@@ -1140,8 +1276,15 @@ std::set<const llvm::Instruction *> LLVMDependenceGraph::getInstructionsOfType(
     return instructions;
 }
 void LLVMDependenceGraph::computeControlDependencies(
-        const LLVMControlDependenceAnalysisOptions &opts) {
-    if (opts.standardCD()) {
+        const LLVMControlDependenceAnalysisOptions &opts, bool onDemand) {
+    if (onDemand && (opts.standardCD() || opts.ntscdCD() || opts.ntscd2CD() ||
+                     opts.ntscdRanganathCD())) {
+        // just remember how to compute the dependencies,
+        // see computeControlDependenciesOnDemand()
+        auto state = std::make_shared<OnDemandCD>(this->module, opts);
+        for (const auto &F : getConstructedFunctions())
+            F.second->onDemandCD = state;
+    } else if (opts.standardCD()) {
         computePostDominators(true);
     } else if (opts.ntscdLegacyCD()) {
         computeNonTerminationControlDependencies();
@@ -1161,6 +1304,17 @@ void LLVMDependenceGraph::computeControlDependencies(
         addNoreturnDependencies(opts);
 }
 
+void LLVMDependenceGraph::computeControlDependencies(
+        LLVMControlDependenceAnalysis &CDA) {
+    const auto &opts = CDA.getOptions();
+    assert((opts.ntscdCD() || opts.ntscd2CD() || opts.ntscdRanganathCD()) &&
+           "Only NTSCD can be filled in from a standalone analysis");
+    addControlDependenceEdges(CDA);
+
+    if (opts.interproceduralCD())
+        addNoreturnDependencies(opts);
+}
+
 void LLVMDependenceGraph::addNoreturnDependencies(LLVMNode *noret,
                                                   LLVMBBlock *from) {
     std::set<LLVMBBlock *> visited;
@@ -0,0 +1,279 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/util/debug.h"
+
+///
+// The format of the cache file. All the numbers are 64-bit
+// in the native byte order, so the file can be used directly
+// after mapping it into memory:
+//
+//  Header
+//  calls[callsNum]          -- (callsite ID, function ID) pairs of the calls
+//                              via function pointers in the order in which
+//                              they were resolved
+//  pointers[pointersNum]    -- (target ID, offset) pairs, the table
+//                              of all pointers in the points-to sets
+//  offsets[nodesNum + 1]    -- the points-to set of node with ID 'i' are
+//                              elements [offsets[i], offsets[i + 1])
+//  elements[elementsNum]    -- indices to the table of pointers
+//
+// The IDs are IDs of nodes in the pointer graph that is built
+// from the module again and the calls via function pointers
+// are again inserted into it before loading the points-to sets.
+
+namespace dg {
+
+namespace {
+
+struct CacheHeader {
+    char magic[8];
+    uint64_t nodesNum;
+    uint64_t callsNum;
+    uint64_t pointersNum;
+    uint64_t elementsNum;
+};
+
+// bump the last character when changing the format
+const char cacheMagic[8] = {'D', 'G', 'P', 'T', 'A', 'C', '0', '1'};
+
+void hashOptions(llvm::MD5 &hash, const LLVMPointerAnalysisOptions &opts) {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    os << static_cast<int>(opts.analysisType) << ";" << *opts.fieldSensitivity
+       << ";" << opts.entryFunction << ";" << opts.preprocessGeps << ";"
+       << opts.invalidateNodes << ";" << opts.diffPropagation << ";"
+       << opts.collapseCycles << ";" << opts.maxIterations << ";"
+       << sizeof(PointsToSetT) << ";";
+    for (const auto &it : opts.allocationFunctions)
+        os << it.first << "=" << static_cast<int>(it.second) << ";";
+    hash.update(os.str());
+}
+
+} // anonymous namespace
+
+std::string DGLLVMPointerAnalysis::getCacheFile() const {
+    llvm::MD5 hash;
+    {
+        std::string str;
+        llvm::raw_string_ostream os(str);
+        _builder->getModule()->print(os, nullptr);
+        hash.update(os.str());
+    }
+    hashOptions(hash, options);
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    llvm::SmallString<32> hex;
+    llvm::MD5::stringifyResult(result, hex);
+
+    llvm::SmallString<128> path(options.cacheDir);
+    llvm::sys::path::append(path, std::string(hex.str()) + ".pta");
+    return std::string(path.str());
+}
+
+bool DGLLVMPointerAnalysis::loadFromCache(const std::string &file) {
+    assert(PTA && "Must be initialized");
+
+#if LLVM_VERSION_MAJOR >= 13
+    auto buf = llvm::MemoryBuffer::getFile(file, /* IsText = */ false,
+                                           /* RequiresNullTerminator = */ false);
+#else
+    auto buf = llvm::MemoryBuffer::getFile(file, /* FileSize = */ -1,
+                                           /* RequiresNullTerminator = */ false);
+#endif
+    if (!buf)
+        return false;
+
+    const char *data = (*buf)->getBufferStart();
+    const size_t size = (*buf)->getBufferSize();
+
+    CacheHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0)
+        return false;
+
+    const uint64_t words = 2 * header.callsNum + 2 * header.pointersNum +
+                           header.nodesNum + 1 + header.elementsNum;
+    if (size != sizeof(header) + words * sizeof(uint64_t))
+        return false;
+
+    // the buffer is aligned (and typically mmapped), read it in place
+    const auto *calls = reinterpret_cast<const uint64_t *>(data + sizeof(header));
+    const auto *pointers = calls + 2 * header.callsNum;
+    const auto *offsets = pointers + 2 * header.pointersNum;
+    const auto *elements = offsets + header.nodesNum + 1;
+
+    // check the sets before we start modifying the graph
+    for (uint64_t id = 0; id < header.nodesNum; ++id) {
+        if (offsets[id] > offsets[id + 1])
+            return false;
+    }
+    if (offsets[header.nodesNum] != header.elementsNum)
+        return false;
+    for (uint64_t i = 0; i < header.elementsNum; ++i) {
+        if (elements[i] >= header.pointersNum)
+            return false;
+    }
+
+    DBG_SECTION_BEGIN(pta, "Loading the results of PTA from " << file);
+
+    // Rebuild the graph as the analysis did -- insert the calls
+    // via function pointers in the same order so that the nodes
+    // get the same IDs.
+    const auto &nodes = PS->getNodes();
+    bool graphChanged = false;
+    auto failed = [this, &graphChanged]() {
+        if (graphChanged) {
+            // start from scratch with a fresh graph
+            PTA.reset();
+            _funptrCalls.clear();
+            _builder.reset(new LLVMPointerGraphBuilder(_builder->getModule(),
+                                                       options));
+            initialize();
+        }
+        DBG_SECTION_END(pta, "Cached results do not match the graph");
+        return false;
+    };
+
+    for (uint64_t i = 0; i < header.callsNum; ++i) {
+        auto callsite = calls[2 * i];
+        auto called = calls[2 * i + 1];
+        if (callsite >= nodes.size() || called >= nodes.size() ||
+            !nodes[callsite] || !nodes[called])
+            return failed();
+        graphChanged = true;
+        PTA->functionPointerCall(nodes[callsite].get(), nodes[called].get());
+    }
+
+    if (nodes.size() != header.nodesNum)
+        return failed();
+
+    auto getNode = [&nodes](uint64_t id) -> PSNode * {
+        switch (id) {
+        case pta::PointerGraphReservedIDs::ID_NULL:
+            return pta::NULLPTR;
+        case pta::PointerGraphReservedIDs::ID_UNKNOWN:
+            return pta::UNKNOWN_MEMORY;
+        case pta::PointerGraphReservedIDs::ID_INVALIDATED:
+            return pta::INVALIDATED;
+        default:
+            return id < nodes.size() ? nodes[id].get() : nullptr;
+        }
+    };
+
+    std::vector<Pointer> table;
+    table.reserve(header.pointersNum);
+    for (uint64_t i = 0; i < header.pointersNum; ++i) {
+        auto *target = getNode(pointers[2 * i]);
+        if (!target)
+            return failed();
+        table.emplace_back(target, Offset(pointers[2 * i + 1]));
+    }
+
+    for (uint64_t id = 0; id < header.nodesNum; ++id) {
+        if (!nodes[id] && offsets[id] != offsets[id + 1])
+            return failed();
+    }
+
+    for (uint64_t id = 0; id < header.nodesNum; ++id) {
+        if (!nodes[id])
+            continue;
+
+        PointsToSetT &pointsTo = nodes[id]->pointsTo;
+        pointsTo = PointsToSetT();
+        for (auto i = offsets[id]; i < offsets[id + 1]; ++i)
+            pointsTo.add(table[elements[i]]);
+    }
+
+    DBG_SECTION_END(pta, "Loaded the results of PTA");
+    return true;
+}
+
+bool DGLLVMPointerAnalysis::storeToCache(const std::string &file) const {
+    const auto &nodes = PS->getNodes();
+
+    std::vector<uint64_t> calls;
+    calls.reserve(2 * _funptrCalls.size());
+    for (const auto &call : _funptrCalls) {
+        calls.push_back(call.first->getID());
+        calls.push_back(call.second->getID());
+    }
+
+    std::unordered_map<Pointer, uint64_t> pointerIDs;
+    std::vector<uint64_t> pointers;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> elements;
+    offsets.reserve(nodes.size() + 1);
+    for (const auto &node : nodes) {
+        offsets.push_back(elements.size());
+        if (!node)
+            continue;
+
+        for (const auto &ptr : node->pointsTo) {
+            auto it = pointerIDs.emplace(ptr, pointerIDs.size());
+            if (it.second) {
+                pointers.push_back(ptr.target->getID());
+                pointers.push_back(*ptr.offset);
+            }
+            elements.push_back(it.first->second);
+        }
+    }
+    offsets.push_back(elements.size());
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.nodesNum = nodes.size();
+    header.callsNum = _funptrCalls.size();
+    header.pointersNum = pointerIDs.size();
+    header.elementsNum = elements.size();
+
+    if (llvm::sys::fs::create_directories(options.cacheDir))
+        return false;
+
+    // write into a temporary file and rename it, so that
+    // other processes never see a partially written file
+    int fd;
+    llvm::SmallString<128> tmp;
+    if (llvm::sys::fs::createUniqueFile(file + ".tmp-%%%%%%", fd, tmp))
+        return false;
+    {
+        llvm::raw_fd_ostream out(fd, /* shouldClose = */ true);
+        auto write = [&out](const std::vector<uint64_t> &v) {
+            out.write(reinterpret_cast<const char *>(v.data()),
+                      v.size() * sizeof(uint64_t));
+        };
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write(calls);
+        write(pointers);
+        write(offsets);
+        write(elements);
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(tmp);
+            return false;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tmp, file)) {
+        llvm::sys::fs::remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+} // namespace dg
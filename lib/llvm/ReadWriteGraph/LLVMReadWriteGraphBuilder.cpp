@@ -12,6 +12,7 @@
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DataLayout.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/IntrinsicInst.h>
@@ -144,5 +145,52 @@ RWNode *LLVMReadWriteGraphBuilder::getOperand(const llvm::Value *val) {
     return op;
 }
 
+void LLVMReadWriteGraphBuilder::rebuildSubgraph(ReadWriteGraph &G,
+                                                const llvm::Function &F) {
+    auto *subg = getSubgraph(&F);
+    assert(subg && "Do not have the subgraph");
+
+    // the graph was moved out of the builder in build(),
+    // take it back while we create the new nodes
+    graph = std::move(G);
+
+    subg->clear();
+    forgetSubgraph(F, [](const llvm::Value * /*unused*/,
+                         const NodesSeq<RWNode> &nodes) {
+        const auto *repr = nodes.getRepresentant();
+        return repr && repr->isAllocation();
+    });
+    buildSubgraph(F);
+    // the kept nodes may be calls, register them again
+    subg->registerCalls();
+
+    G = std::move(graph);
+}
+
+bool LLVMReadWriteGraphBuilder::hasCalledSubgraphs(const llvm::Function &F) {
+    for (const auto &I : llvm::instructions(F)) {
+        const auto *CInst = llvm::dyn_cast<llvm::CallInst>(&I);
+        if (!CInst || CInst->isInlineAsm())
+            continue;
+
+#if LLVM_VERSION_MAJOR >= 8
+        const auto *calledVal = CInst->getCalledOperand()->stripPointerCasts();
+#else
+        const auto *calledVal = CInst->getCalledValue()->stripPointerCasts();
+#endif
+        std::vector<const llvm::Function *> functions;
+        if (const auto *fun = llvm::dyn_cast<llvm::Function>(calledVal))
+            functions.push_back(fun);
+        else
+            functions = getCalledFunctions(calledVal, PTA);
+
+        for (const auto *fun : functions) {
+            if (!fun->isDeclaration() && !getSubgraph(fun))
+                return false;
+        }
+    }
+    return true;
+}
+
 } // namespace dda
 } // namespace dg
@@ -84,6 +84,16 @@ class LLVMReadWriteGraphBuilder
         return std::move(graph);
     }
 
+    ///
+    // Build again the subgraph of the function 'F' that has been changed.
+    // The nodes are created in the graph 'G' (the graph returned by build()).
+    // The nodes of allocations that are still in 'F' are reused, because
+    // the nodes of other subgraphs may refer to them.
+    void rebuildSubgraph(ReadWriteGraph &G, const llvm::Function &F);
+
+    // do we have subgraphs for all defined functions that 'F' may call?
+    bool hasCalledSubgraphs(const llvm::Function &F);
+
     RWNode *getOperand(const llvm::Value *val);
 
     std::vector<DefSite> mapPointers(const llvm::Value *where,
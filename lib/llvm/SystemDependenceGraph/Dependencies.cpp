@@ -12,6 +12,8 @@ struct SDGDependenciesBuilder {
     llvmdg::SystemDependenceGraph &_sdg;
     dda::LLVMDataDependenceAnalysis *DDA;
     LLVMControlDependenceAnalysis *CDA;
+    // the definitions of the uses in the currently processed block
+    dda::LLVMDefinitionsBatch _blockDefs;
 
     SDGDependenciesBuilder(llvmdg::SystemDependenceGraph &g,
                            dda::LLVMDataDependenceAnalysis *dda,
@@ -111,8 +113,7 @@ struct SDGDependenciesBuilder {
         if (!DDA->isUse(&I))
             return;
 
-        for (auto &op : DDA->getLLVMDefinitions(&I)) {
-            auto *val = &*op;
+        for (auto *val : _blockDefs.getDefinitions(&I)) {
             auto *opnd = _sdg.getNode(val);
             if (!opnd) {
                 llvm::errs() << "[SDG error] Do not have operand node:\n";
@@ -154,6 +155,8 @@ struct SDGDependenciesBuilder {
         assert(dg && "Do not have dg");
 
         for (auto &B : F) {
+            // search the definitions of all uses in the block at once
+            _blockDefs = DDA->getLLVMDefinitionsBatch(B);
             for (auto &I : B) {
                 processInstr(I);
             }
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dg/ADT/Bitvector.h"
+#include "dg/ADT/ChunkedBitvector.h"
+#include "dg/util/TimeMeasure.h"
+
+using namespace dg::ADT;
+
+// the results of the operations, so that they are not optimized away
+static size_t sink = 0;
+
+#define run(func, msg)                                                         \
+    do {                                                                       \
+        std::cout << "Running " << (msg) << "\n";                              \
+        dg::debug::TimeMeasure tm;                                             \
+        tm.start();                                                            \
+        func<SparseBitvectorMapImpl>(size, times);                             \
+        tm.stop();                                                             \
+        tm.report(" -- SparseBitvector (map) took");                           \
+        tm.start();                                                            \
+        func<SparseBitvectorHashImpl>(size, times);                            \
+        tm.stop();                                                             \
+        tm.report(" -- SparseBitvector (hash map) took");                      \
+        tm.start();                                                            \
+        func<ChunkedBitvector<>>(size, times);                                 \
+        tm.stop();                                                             \
+        tm.report(" -- ChunkedBitvector took");                                \
+    } while (0);
+
+// Create sets that resemble the points-to sets of pointer IDs:
+// most of the elements are clustered around the IDs of pointers
+// to the same object and the rest is scattered over all the IDs.
+// The sets are the same for every type of bitvector.
+template <typename BV>
+std::vector<BV> createSets(size_t size, size_t num = 100) {
+    const uint64_t maxID = 100000;
+    std::default_random_engine generator(size);
+    std::uniform_int_distribution<uint64_t> ids(0, maxID);
+    std::uniform_int_distribution<uint64_t> near(0, 4 * size);
+
+    std::vector<BV> sets(num);
+    for (auto &S : sets) {
+        auto base = ids(generator);
+        for (size_t i = 0; i < size; ++i) {
+            if (i % 4 == 0)
+                S.set(ids(generator));
+            else
+                S.set(base + near(generator));
+        }
+    }
+    return sets;
+}
+
+template <typename BV>
+bool intersect(BV &A, const BV &B) {
+    BV tmp;
+    for (auto x : A) {
+        if (B.get(x))
+            tmp.set(x);
+    }
+    bool changed = tmp.size() != A.size();
+    A.swap(tmp);
+    return changed;
+}
+
+template <>
+bool intersect(ChunkedBitvector<> &A, const ChunkedBitvector<> &B) {
+    return A.intersect(B);
+}
+
+template <typename BV>
+bool isSubset(const BV &A, const BV &B) {
+    for (auto x : A) {
+        if (!B.get(x))
+            return false;
+    }
+    return true;
+}
+
+template <>
+bool isSubset(const ChunkedBitvector<> &A, const ChunkedBitvector<> &B) {
+    return A.isSubsetOf(B);
+}
+
+// unite all pairs of sets
+template <typename BV>
+void testUnion(size_t size, int times) {
+    auto sets = createSets<BV>(size);
+    for (int t = 0; t < times; ++t) {
+        for (size_t i = 0; i < sets.size(); ++i) {
+            auto S = sets[i];
+            for (const auto &S2 : sets)
+                sink += S.set(S2);
+        }
+    }
+}
+
+// unite the sets to sets that already contain them
+// (the usual case when the pointer analysis approaches the fixpoint)
+template <typename BV>
+void testUnionNoChange(size_t size, int times) {
+    auto sets = createSets<BV>(size);
+    BV all;
+    for (const auto &S : sets)
+        all.set(S);
+
+    for (int t = 0; t < times; ++t) {
+        for (const auto &S : sets)
+            sink += all.set(S);
+    }
+}
+
+template <typename BV>
+void testIntersection(size_t size, int times) {
+    auto sets = createSets<BV>(size);
+    for (int t = 0; t < times; ++t) {
+        for (size_t i = 0; i + 1 < sets.size(); ++i) {
+            auto S = sets[i];
+            sink += intersect(S, sets[i + 1]);
+        }
+    }
+}
+
+template <typename BV>
+void testSubset(size_t size, int times) {
+    auto sets = createSets<BV>(size);
+    BV all;
+    for (const auto &S : sets)
+        all.set(S);
+
+    for (int t = 0; t < times; ++t) {
+        for (size_t i = 0; i < sets.size(); ++i) {
+            sink += isSubset(sets[i], all);
+            sink += isSubset(all, sets[i]);
+        }
+    }
+}
+
+template <typename BV>
+void testSize(size_t size, int times) {
+    auto sets = createSets<BV>(size);
+    for (int t = 0; t < times; ++t) {
+        for (const auto &S : sets)
+            sink += S.size();
+    }
+}
+
+int main() {
+    for (size_t size : {10, 100, 1000}) {
+        std::cout << "== Sets of " << size << " elements ==\n";
+        int times = static_cast<int>(10000 / size);
+
+        run(testUnion, "Union of all pairs of sets");
+        run(testUnionNoChange, "Union with a superset");
+        run(testIntersection, "Intersection of sets");
+        run(testSubset, "Subset test");
+        times *= 100;
+        run(testSize, "Counting elements");
+    }
+
+    std::cout << "(" << sink << ")\n";
+}
@@ -2,9 +2,12 @@
 
 #include <random>
 #include <set>
+#include <vector>
 
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/ChunkedBitvector.h"
 
+using dg::ADT::ChunkedBitvector;
 using dg::ADT::SparseBitvector;
 
 TEST_CASE("Querying empty set", "SparseBitvector") {
@@ -205,3 +208,110 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
     //    B2.merge(B1);
     //    REQUIRE(B1 == B2);
 }
+
+template <typename T>
+static std::vector<uint64_t> toVector(const T &C) {
+    std::vector<uint64_t> ret;
+    for (auto x : C)
+        ret.push_back(x);
+    return ret;
+}
+
+TEST_CASE("Chunked bitvector set and unset", "ChunkedBitvector") {
+    ChunkedBitvector<> B;
+
+    REQUIRE(B.empty());
+    REQUIRE(B.begin() == B.end());
+    for (unsigned int i = 0; i < 64; ++i) {
+        REQUIRE(B.set(uint64_t{1} << i) == false);
+        REQUIRE(B.set(uint64_t{1} << i) == true);
+    }
+    REQUIRE(B.set(0) == false);
+    REQUIRE(B.size() == 65);
+
+    uint64_t prev = 0;
+    size_t num = 0;
+    for (auto x : B) {
+        REQUIRE((num == 0 || x > prev));
+        REQUIRE(B.get(x));
+        prev = x;
+        ++num;
+    }
+    REQUIRE(num == 65);
+
+    REQUIRE(B.unset(0) == true);
+    REQUIRE(B.unset(0) == false);
+    for (unsigned int i = 0; i < 64; ++i) {
+        REQUIRE(B.unset(uint64_t{1} << i) == true);
+    }
+    REQUIRE(B.empty());
+    REQUIRE(B.size() == 0);
+}
+
+TEST_CASE("Chunked bitvector random", "ChunkedBitvector") {
+    ChunkedBitvector<> B;
+    std::set<uint64_t> S;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 10000);
+
+    for (int i = 0; i < 5000; ++i) {
+        auto x = distribution(generator);
+        if (i % 3 == 0) {
+            REQUIRE(B.unset(x) == (S.erase(x) > 0));
+        } else {
+            REQUIRE(B.set(x) == !S.insert(x).second);
+        }
+    }
+
+    REQUIRE(B.size() == S.size());
+    REQUIRE(toVector(B) == toVector(S));
+}
+
+TEST_CASE("Chunked bitvector set operations", "ChunkedBitvector") {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 5000);
+
+    for (int n = 0; n < 50; ++n) {
+        ChunkedBitvector<> B1, B2;
+        std::set<uint64_t> S1, S2;
+        for (int i = 0; i < 2 * n; ++i) {
+            auto x = distribution(generator);
+            auto y = distribution(generator);
+            B1.set(x);
+            S1.insert(x);
+            B2.set(y);
+            S2.insert(y);
+        }
+
+        std::set<uint64_t> U(S1);
+        U.insert(S2.begin(), S2.end());
+        std::set<uint64_t> I;
+        for (auto x : S1) {
+            if (S2.count(x) > 0)
+                I.insert(x);
+        }
+
+        auto U1 = B1;
+        REQUIRE(U1.set(B2) == (U.size() != S1.size()));
+        REQUIRE(U1.set(B2) == false);
+        REQUIRE(U1.set(B1) == false);
+        REQUIRE(U1.size() == U.size());
+        REQUIRE(toVector(U1) == toVector(U));
+        REQUIRE(B1.isSubsetOf(U1));
+        REQUIRE(B2.isSubsetOf(U1));
+        REQUIRE(U1.isSubsetOf(B1) == (U.size() == S1.size()));
+
+        auto I1 = B1;
+        REQUIRE(I1.intersect(B2) == (I.size() != S1.size()));
+        REQUIRE(I1.intersect(B2) == false);
+        REQUIRE(I1.size() == I.size());
+        REQUIRE(toVector(I1) == toVector(I));
+        REQUIRE(I1.isSubsetOf(B1));
+        REQUIRE(I1.isSubsetOf(B2));
+
+        auto U2 = B2;
+        U2.set(B1);
+        REQUIRE(U1 == U2);
+    }
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+
+#include "dg/util/debug.h"
+
+#include "ControlDependence/CDGraph.h"
+#include "ControlDependence/CDRelation.h"
+#include "ControlDependence/DOD.h"
+#include "ControlDependence/NTSCD.h"
+
+using namespace dg;
+
+// p is a predicate on a cycle: p -> body -> p and p -> exit
+TEST_CASE("predicate on a cycle depends on itself", "[NTSCD]") {
+    CDGraph G;
+    auto &entry = G.createNode();
+    auto &p = G.createNode();
+    auto &body = G.createNode();
+    auto &exit = G.createNode();
+    G.addNodeSuccessor(entry, p);
+    G.addNodeSuccessor(p, body);
+    G.addNodeSuccessor(p, exit);
+    G.addNodeSuccessor(body, p);
+
+    auto expected = NTSCDRanganath().compute(G).first;
+    REQUIRE(expected.has(&p, &p));
+    REQUIRE(expected.has(&body, &p));
+
+    for (bool fastPath : {true, false}) {
+        REQUIRE(NTSCD().compute(G, fastPath).first == expected);
+        REQUIRE(NTSCD2().compute(G, fastPath).first == expected);
+    }
+}
+
+// the search from t gets back to t through the cycles t -> a -> t
+// and t -> b -> t, but e must not be colored (y does not reach t),
+// so t does not depend on q
+TEST_CASE("target reached again through a cycle", "[NTSCD][DOD]") {
+    CDGraph G;
+    auto &q = G.createNode();
+    auto &e = G.createNode();
+    auto &z = G.createNode();
+    auto &t = G.createNode();
+    auto &y = G.createNode();
+    auto &a = G.createNode();
+    auto &b = G.createNode();
+    auto &end = G.createNode();
+    G.addNodeSuccessor(q, e);
+    G.addNodeSuccessor(q, z);
+    G.addNodeSuccessor(e, t);
+    G.addNodeSuccessor(e, y);
+    G.addNodeSuccessor(t, a);
+    G.addNodeSuccessor(t, b);
+    G.addNodeSuccessor(a, t);
+    G.addNodeSuccessor(b, t);
+    G.addNodeSuccessor(y, end);
+    G.addNodeSuccessor(z, end);
+
+    auto expected = NTSCDRanganath().compute(G).first;
+    REQUIRE(expected.has(&t, &e));
+    REQUIRE(!expected.has(&t, &q));
+
+    for (bool fastPath : {true, false}) {
+        REQUIRE(NTSCD().compute(G, fastPath).first == expected);
+        REQUIRE(NTSCD2().compute(G, fastPath).first == expected);
+    }
+
+    auto allpaths = AllMaxPath().compute(G);
+    REQUIRE(allpaths[a.getID()].get(t.getID()));
+    REQUIRE(allpaths[b.getID()].get(t.getID()));
+    REQUIRE(!allpaths[e.getID()].get(t.getID()));
+    REQUIRE(!allpaths[q.getID()].get(t.getID()));
+}
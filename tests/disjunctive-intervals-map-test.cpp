@@ -1,16 +1,19 @@
 #include <catch2/catch.hpp>
 
 #include <random>
+#include <set>
 #include <sstream>
 #include <vector>
 
 #undef NDEBUG
 
 #include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
 #include "dg/Offset.h"
 
 using namespace dg;
 using dg::ADT::DisjunctiveIntervalMap;
+using dg::ADT::FlatDisjunctiveIntervalMap;
 
 static std::ostream &
 operator<<(std::ostream &os, const std::vector<std::tuple<int, int, int>> &v) {
@@ -573,3 +576,132 @@ TEST_CASE("Uncovered - regression 1", "DisjunctiveIntervalMap") {
     ret = M.uncovered(0, 3);
     REQUIRE(ret.empty());
 }
+
+TEST_CASE("Uncovered - regression 2", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int> M;
+    using IntT = decltype(M)::IntervalT;
+
+    M.add(0, 3, 0);
+    M.add(4, 7, 0);
+    M.add(16, 19, 0);
+
+    // the gap before the next interval must not
+    // stretch out of the queried interval
+    auto ret = M.uncovered(4, 11);
+    REQUIRE(ret.size() == 1);
+    REQUIRE(ret[0] == IntT{8, 11});
+}
+
+TEST_CASE("Flat map add and split", "FlatDisjunctiveIntervalMap") {
+    FlatDisjunctiveIntervalMap<int, int> M;
+    REQUIRE(M.empty());
+
+    REQUIRE(M.add(0, 10, 1));
+    REQUIRE(!M.add(0, 10, 1));
+    REQUIRE(M.size() == 1);
+
+    REQUIRE(M.add(3, 5, 2));
+    REQUIRE(M.size() == 3);
+    REQUIRE(M.gather(0, 2) == std::set<int>{1});
+    REQUIRE(M.gather(3, 5) == (std::set<int>{1, 2}));
+    REQUIRE(M.gather(4, 8) == (std::set<int>{1, 2}));
+    REQUIRE(M.gather(6, 10) == std::set<int>{1});
+    REQUIRE(M.gather(11, 20).empty());
+
+    REQUIRE(M.update(2, 12, 3));
+    REQUIRE(M.size() == 5);
+    REQUIRE(M.gather(0, 1) == std::set<int>{1});
+    REQUIRE(M.gather(2, 12) == std::set<int>{3});
+    REQUIRE(M.overlapsFull(0, 12));
+    REQUIRE(!M.overlapsFull(0, 13));
+    REQUIRE(M.uncovered(10, 20).size() == 1);
+    REQUIRE(M.uncovered(10, 20)[0].start == 13);
+}
+
+TEST_CASE("Flat map intersection", "FlatDisjunctiveIntervalMap") {
+    FlatDisjunctiveIntervalMap<int, int> A, B;
+    A.add(0, 10, 1);
+    A.add(20, 30, 2);
+    B.add(5, 25, 1);
+    B.add(5, 25, 2);
+
+    auto I = A.intersection(B);
+    REQUIRE(I.size() == 2);
+    REQUIRE(I.gather(5, 10) == std::set<int>{1});
+    REQUIRE(I.gather(20, 25) == std::set<int>{2});
+    REQUIRE(I.uncovered(0, 30).size() == 3);
+}
+
+TEST_CASE("Flat map split with Offset", "FlatDisjunctiveIntervalMap") {
+    FlatDisjunctiveIntervalMap<int> M;
+    using IntT = decltype(M)::IntervalT;
+
+    M.add(0, 31, 1);
+    M.add(12, 15, 2);
+    REQUIRE(M.size() == 3);
+
+    auto it = M.begin();
+    REQUIRE(it->first == IntT{0, 11});
+    ++it;
+    REQUIRE(it->first == IntT{12, 15});
+    ++it;
+    REQUIRE(it->first == IntT{16, 31});
+}
+
+// the intervals of bytes from [a, b] that have no values in M
+static std::vector<DisjunctiveIntervalMap<int, int>::IntervalT>
+uncoveredBytes(const DisjunctiveIntervalMap<int, int> &M, int a, int b) {
+    std::vector<DisjunctiveIntervalMap<int, int>::IntervalT> ret;
+    for (int x = a; x <= b; ++x) {
+        if (!M.gather(x, x).empty())
+            continue;
+        if (!ret.empty() && ret.back().end == x - 1)
+            ret.back().end = x;
+        else
+            ret.emplace_back(x, x);
+    }
+    return ret;
+}
+
+// the flat map must behave the same as DisjunctiveIntervalMap
+TEST_CASE("Flat map random", "FlatDisjunctiveIntervalMap") {
+    std::default_random_engine generator(7);
+    std::uniform_int_distribution<int> distribution(0, 100);
+
+    for (int round = 0; round < 100; ++round) {
+        DisjunctiveIntervalMap<int, int> M;
+        FlatDisjunctiveIntervalMap<int, int> F;
+
+        for (int i = 0; i < 20; ++i) {
+            int a = distribution(generator);
+            int b = distribution(generator);
+            if (a > b)
+                std::swap(a, b);
+            int val = distribution(generator) % 5;
+
+            if (i % 4 == 3)
+                REQUIRE(M.update(a, b, val) == F.update(a, b, val));
+            else
+                REQUIRE(M.add(a, b, val) == F.add(a, b, val));
+            REQUIRE(M.size() == F.size());
+
+            auto Mit = M.begin();
+            for (const auto &it : F) {
+                REQUIRE(it.first == Mit->first);
+                REQUIRE(std::set<int>(it.second.begin(), it.second.end()) ==
+                        Mit->second);
+                ++Mit;
+            }
+
+            a = distribution(generator);
+            b = distribution(generator);
+            if (a > b)
+                std::swap(a, b);
+            REQUIRE(M.gather(a, b) == F.gather(a, b));
+            REQUIRE(uncoveredBytes(M, a, b) == F.uncovered(a, b));
+            REQUIRE(M.uncovered(a, b) == F.uncovered(a, b));
+            REQUIRE(F.overlaps(a, b) == !M.gather(a, b).empty());
+            REQUIRE(F.overlapsFull(a, b) == M.uncovered(a, b).empty());
+        }
+    }
+}
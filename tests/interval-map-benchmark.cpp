@@ -0,0 +1,139 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
+#include "dg/util/TimeMeasure.h"
+
+using namespace dg::ADT;
+
+// the results of the operations, so that they are not optimized away
+static size_t sink = 0;
+
+#define run(func, msg)                                                         \
+    do {                                                                       \
+        std::cout << "Running " << (msg) << "\n";                              \
+        dg::debug::TimeMeasure tm;                                             \
+        tm.start();                                                            \
+        func<DisjunctiveIntervalMap<int, uint64_t>>(size, times);              \
+        tm.stop();                                                             \
+        tm.report(" -- DisjunctiveIntervalMap took");                          \
+        tm.start();                                                            \
+        func<FlatDisjunctiveIntervalMap<int, uint64_t>>(size, times);          \
+        tm.stop();                                                             \
+        tm.report(" -- FlatDisjunctiveIntervalMap took");                      \
+    } while (0);
+
+// Create maps that resemble the definitions of one memory object:
+// the intervals are mostly small (the fields of the object) and
+// every interval is defined by a few nodes.
+// The maps are the same for every type of map.
+template <typename MapT>
+std::vector<MapT> createMaps(size_t size, size_t num = 100) {
+    std::default_random_engine generator(size);
+    std::uniform_int_distribution<uint64_t> offsets(0, 8 * size);
+    std::uniform_int_distribution<uint64_t> lengths(1, 8);
+    std::uniform_int_distribution<int> nodes(0, 1000);
+
+    std::vector<MapT> maps(num);
+    for (auto &M : maps) {
+        for (size_t i = 0; i < size; ++i) {
+            auto start = offsets(generator);
+            M.add(start, start + lengths(generator) - 1, nodes(generator));
+        }
+    }
+    return maps;
+}
+
+// the way MemorySSA joins definitions: copy the bytes
+// of 'from' that are not defined in 'to' yet
+template <typename MapT>
+bool join(const MapT &from, MapT &to) {
+    bool changed = false;
+    for (const auto &it : from) {
+        for (const auto &I : to.uncovered(it.first))
+            changed |= to.add(I, it.second);
+    }
+    return changed;
+}
+
+// copy the maps (e.g., when copying the definitions of a block)
+template <typename MapT>
+void testCopy(size_t size, int times) {
+    auto maps = createMaps<MapT>(size);
+    for (int t = 0; t < times; ++t) {
+        for (const auto &M : maps) {
+            auto tmp = M;
+            sink += tmp.size();
+        }
+    }
+}
+
+// add all the definitions of one map to a copy of another map
+// (e.g., joining the definitions from predecessors)
+template <typename MapT>
+void testAdd(size_t size, int times) {
+    auto maps = createMaps<MapT>(size);
+    for (int t = 0; t < times; ++t) {
+        for (size_t i = 0; i + 1 < maps.size(); ++i) {
+            auto tmp = maps[i];
+            for (const auto &it : maps[i + 1])
+                sink += tmp.add(it.first, it.second);
+        }
+    }
+}
+
+template <typename MapT>
+void testJoin(size_t size, int times) {
+    auto maps = createMaps<MapT>(size);
+    for (int t = 0; t < times; ++t) {
+        for (size_t i = 0; i + 1 < maps.size(); ++i) {
+            auto tmp = maps[i];
+            sink += join(maps[i + 1], tmp);
+        }
+    }
+}
+
+// strong updates of single intervals
+template <typename MapT>
+void testUpdate(size_t size, int times) {
+    auto maps = createMaps<MapT>(size);
+    std::default_random_engine generator(size);
+    std::uniform_int_distribution<uint64_t> offsets(0, 8 * size);
+    for (int t = 0; t < times; ++t) {
+        for (auto &M : maps) {
+            auto start = offsets(generator);
+            sink += M.update(start, start + 3, t);
+        }
+    }
+}
+
+template <typename MapT>
+void testGather(size_t size, int times) {
+    auto maps = createMaps<MapT>(size);
+    std::default_random_engine generator(size);
+    std::uniform_int_distribution<uint64_t> offsets(0, 8 * size);
+    for (int t = 0; t < times; ++t) {
+        for (const auto &M : maps) {
+            auto start = offsets(generator);
+            sink += M.gather(start, start + 7).size();
+            sink += M.uncovered(start, start + 7).size();
+        }
+    }
+}
+
+int main() {
+    for (size_t size : {1, 4, 16, 64}) {
+        std::cout << "== Maps with " << size << " definitions ==\n";
+        int times = static_cast<int>(2000 / size);
+
+        run(testCopy, "Copying maps");
+        run(testAdd, "Adding maps");
+        run(testJoin, "Joining maps");
+        run(testUpdate, "Updating intervals");
+        run(testGather, "Gathering values");
+    }
+
+    std::cout << "(" << sink << ")\n";
+}
@@ -0,0 +1,520 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "dg/MemorySSA/MemorySSA.h"
+#include "dg/llvm/DataDependence/DataDependence.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+
+using namespace dg;
+
+static const char *code = R"(
+@g = global i32 0
+
+define i32 @sum(i32 %n) {
+entry:
+  %s = alloca i32
+  %i = alloca i32
+  store i32 0, i32* %s
+  store i32 0, i32* %i
+  br label %loop
+loop:
+  %iv = load i32, i32* %i
+  %c = icmp slt i32 %iv, %n
+  br i1 %c, label %body, label %exit
+body:
+  %sv = load i32, i32* %s
+  %sv1 = add i32 %sv, %iv
+  store i32 %sv1, i32* %s
+  %iv1 = add i32 %iv, 1
+  store i32 %iv1, i32* %i
+  br label %loop
+exit:
+  %sr = load i32, i32* %s
+  %gr = load i32, i32* @g
+  %r = add i32 %sr, %gr
+  ret i32 %r
+}
+
+define void @inc(i32* %p, i32 %n) {
+entry:
+  %v = load i32, i32* %p
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %rec, label %exit
+rec:
+  %v1 = add i32 %v, 1
+  store i32 %v1, i32* %p
+  %n1 = sub i32 %n, 1
+  call void @inc(i32* %p, i32 %n1)
+  br label %exit
+exit:
+  %gv = load i32, i32* @g
+  %gv1 = add i32 %gv, %v
+  store i32 %gv1, i32* @g
+  ret void
+}
+
+define i32 @main() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32 1, i32* %a
+  store i32 2, i32* %b
+  %x = call i32 @sum(i32 10)
+  call void @inc(i32* %a, i32 %x)
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %then, label %join
+then:
+  store i32 3, i32* %b
+  br label %join
+join:
+  %av = load i32, i32* %a
+  %bv = load i32, i32* %b
+  %gv = load i32, i32* @g
+  %r = add i32 %av, %bv
+  %r1 = add i32 %r, %gv
+  ret i32 %r1
+}
+)";
+
+// mutually recursive functions, the only write in the cycle is in @b
+static const char *recursiveCode = R"(
+@x = global i32 0
+
+define void @a(i32 %n) {
+entry:
+  call void @b(i32 %n)
+  ret void
+}
+
+define void @b(i32 %n) {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %rec, label %exit
+rec:
+  store i32 %n, i32* @x
+  call void @c(i32 %n)
+  br label %exit
+exit:
+  ret void
+}
+
+define void @c(i32 %n) {
+entry:
+  %n1 = sub i32 %n, 1
+  call void @a(i32 %n1)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  store i32 0, i32* @x
+  call void @a(i32 3)
+  %l1 = load i32, i32* @x
+  store i32 1, i32* @x
+  call void @c(i32 3)
+  %l2 = load i32, i32* @x
+  %r = add i32 %l1, %l2
+  ret i32 %r
+}
+)";
+
+namespace {
+
+struct Analyses {
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> M;
+    std::unique_ptr<DGLLVMPointerAnalysis> PTA;
+    std::unique_ptr<dda::LLVMDataDependenceAnalysis> DDA;
+
+    Analyses(unsigned ddaThreads,
+             const std::function<void(llvm::Module &)> &modify = nullptr,
+             const char *source = code) {
+        llvm::SMDiagnostic SMD;
+        M = llvm::parseIR(llvm::MemoryBufferRef(source, "test"), SMD, context);
+        REQUIRE(M);
+        if (modify)
+            modify(*M);
+
+        PTA.reset(new DGLLVMPointerAnalysis(M.get()));
+        PTA->run();
+
+        LLVMDataDependenceAnalysisOptions opts;
+        opts.ddaThreads = ddaThreads;
+        DDA.reset(new dda::LLVMDataDependenceAnalysis(M.get(), PTA.get(),
+                                                      opts));
+        DDA->run();
+    }
+
+    dda::MemorySSATransformation *getSSA() {
+        return static_cast<dda::MemorySSATransformation *>(
+                DDA->getDDA()->getImpl());
+    }
+
+    std::vector<std::set<llvm::Value *>> getDefinitions() {
+        std::vector<std::set<llvm::Value *>> defs;
+        for (auto &F : *M) {
+            for (auto &I : llvm::instructions(F)) {
+                if (!DDA->isUse(&I))
+                    continue;
+                auto vals = DDA->getLLVMDefinitions(&I);
+                defs.emplace_back(vals.begin(), vals.end());
+            }
+        }
+        return defs;
+    }
+};
+
+// the IDs of nodes in the blocks and the (sorted) IDs of their definitions
+// (the definitions of phi nodes are collected in sets of pointers,
+// so their order may differ between two builds of the graph)
+std::vector<std::vector<unsigned>> getMemorySSA(dda::ReadWriteGraph *G) {
+    std::vector<std::vector<unsigned>> result;
+    for (auto *subg : G->subgraphs()) {
+        for (auto *b : subg->bblocks()) {
+            for (auto *n : b->getNodes()) {
+                std::vector<unsigned> defs;
+                for (auto *d : n->defuse)
+                    defs.push_back(d->getID());
+                std::sort(defs.begin(), defs.end());
+                defs.insert(defs.begin(), n->getID());
+                result.push_back(std::move(defs));
+            }
+        }
+    }
+    return result;
+}
+
+// the non-phi definitions reachable from 'n' over phi nodes
+void collapsePhis(dda::RWNode *n, std::set<dda::RWNode *> &visited,
+                  std::set<unsigned> &defs) {
+    if (!visited.insert(n).second)
+        return;
+    for (auto *d : n->defuse) {
+        if (d->isPhi())
+            collapsePhis(d, visited, defs);
+        else
+            defs.insert(d->getID());
+    }
+}
+
+// compare the definitions of the LLVM values
+std::vector<std::set<std::string>>
+getNames(const std::vector<std::set<llvm::Value *>> &defs) {
+    std::vector<std::set<std::string>> names;
+    for (const auto &S : defs) {
+        names.emplace_back();
+        for (auto *v : S) {
+            std::string str;
+            llvm::raw_string_ostream os(str);
+            v->print(os);
+            names.back().insert(os.str());
+        }
+    }
+    return names;
+}
+
+// find the instruction with the given name in the function 'fun'
+llvm::Instruction *getInstruction(llvm::Module &M, const char *fun,
+                                  const char *name) {
+    for (auto &I : llvm::instructions(M.getFunction(fun))) {
+        if (I.getName() == name)
+            return &I;
+    }
+    return nullptr;
+}
+
+// find the first instruction in the block 'block' of the function 'fun'
+llvm::Instruction *getFirstInBlock(llvm::Module &M, const char *fun,
+                                   const char *block) {
+    for (auto &B : *M.getFunction(fun)) {
+        if (B.getName() == block)
+            return &B.front();
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+TEST_CASE("eager definitions match on-demand definitions", "DDA") {
+    Analyses onDemand(1);
+    Analyses eager(4);
+
+    auto defs = getNames(onDemand.getDefinitions());
+    REQUIRE(!defs.empty());
+    REQUIRE(defs == getNames(eager.getDefinitions()));
+}
+
+TEST_CASE("eager definitions do not depend on threads", "DDA") {
+    Analyses one(1);
+    one.getSSA()->computeAllDefinitions(1);
+
+    for (unsigned threads : {2, 3, 8}) {
+        Analyses more(1);
+        more.getSSA()->computeAllDefinitions(threads);
+        REQUIRE(getMemorySSA(one.getSSA()->getGraph()) ==
+                getMemorySSA(more.getSSA()->getGraph()));
+    }
+}
+
+TEST_CASE("modref of recursive functions is complete", "DDA") {
+    // the definitions of %l1 compute the modref of @a first,
+    // the modref of @c must still contain the store from @b
+    Analyses onDemand(1, nullptr, recursiveCode);
+    Analyses eager(4, nullptr, recursiveCode);
+
+    auto defs = getNames(onDemand.getDefinitions());
+    REQUIRE(defs.size() == 2);
+    auto store = getNames({{getFirstInBlock(*onDemand.M, "b", "rec")}});
+    REQUIRE(defs[1].count(*store[0].begin()) > 0);
+    REQUIRE(defs == getNames(eager.getDefinitions()));
+}
+
+TEST_CASE("collapsed phi nodes", "DDA") {
+    Analyses A(4);
+    auto *SSA = A.getSSA();
+
+    for (unsigned round = 0; round < 2; ++round) {
+        for (auto *subg : SSA->getGraph()->subgraphs()) {
+            for (auto *b : subg->bblocks()) {
+                for (auto *n : b->getNodes()) {
+                    if (!n->isUse())
+                        continue;
+
+                    std::set<unsigned> ids;
+                    for (auto *d : SSA->getDefinitions(n))
+                        ids.insert(d->getID());
+
+                    std::set<dda::RWNode *> visited;
+                    std::set<unsigned> expected;
+                    collapsePhis(n, visited, expected);
+                    REQUIRE(ids == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("trivial phi nodes are removed", "DDA") {
+    Analyses A(1);
+    auto *SSA = A.getSSA();
+    SSA->computeAllDefinitions();
+
+    // the loop in 'sum' does not write @g
+    REQUIRE(SSA->getNumOfRemovedPhis() > 0);
+    REQUIRE(SSA->getNumOfRemovedPhis() < SSA->getNumOfCreatedPhis());
+
+    for (auto *subg : SSA->getGraph()->subgraphs()) {
+        for (auto *b : subg->bblocks()) {
+            for (auto *n : b->getNodes()) {
+                if (n->getType() != dda::RWNodeType::PHI)
+                    continue;
+
+                std::set<dda::RWNode *> defs(n->defuse.begin(),
+                                             n->defuse.end());
+                defs.erase(n);
+                REQUIRE(defs.size() != 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("batched definitions match single queries", "DDA") {
+    Analyses single(1);
+    Analyses batched(1);
+
+    std::vector<std::set<llvm::Value *>> defs;
+    for (auto &F : *batched.M) {
+        auto batch = batched.DDA->getLLVMDefinitionsBatch(F);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            auto D = batch.getDefinitions(i);
+            REQUIRE(D == batch.getDefinitions(batch.getUse(i)));
+            defs.emplace_back(D.begin(), D.end());
+        }
+    }
+
+    REQUIRE(!defs.empty());
+    REQUIRE(getNames(defs) == getNames(single.getDefinitions()));
+    // the uses were queried in the same order, so also the phi nodes
+    // must be the same
+    REQUIRE(getMemorySSA(single.getSSA()->getGraph()) ==
+            getMemorySSA(batched.getSSA()->getGraph()));
+}
+
+TEST_CASE("incremental update matches a new analysis", "DDA") {
+    // the changes of the module and the functions that they change
+    std::vector<std::pair<std::function<void(llvm::Module &)>, const char *>>
+            changes = {
+                    // store to a global in a loop of a called function
+                    {[](llvm::Module &M) {
+                         auto *iv1 = getInstruction(M, "sum", "iv1");
+                         new llvm::StoreInst(iv1, M.getGlobalVariable("g"),
+                                             iv1->getNextNode());
+                     },
+                     "sum"},
+                    // store to a local variable passed to a call
+                    {[](llvm::Module &M) {
+                         auto *then = getFirstInBlock(M, "main", "then");
+                         new llvm::StoreInst(
+                                 llvm::ConstantInt::get(
+                                         llvm::Type::getInt32Ty(
+                                                 M.getContext()),
+                                         4),
+                                 getInstruction(M, "main", "a"), then);
+                     },
+                     "main"},
+                    // remove a store
+                    {[](llvm::Module &M) {
+                         getFirstInBlock(M, "main", "then")->eraseFromParent();
+                     },
+                     "main"},
+            };
+
+    for (auto &change : changes) {
+        Analyses A(1);
+        // compute the results that the update must throw away
+        auto before = getNames(A.getDefinitions());
+
+        change.first(*A.M);
+        REQUIRE(A.DDA->update(A.M->getFunction(change.second)));
+
+        Analyses fresh(1, change.first);
+        auto after = getNames(fresh.getDefinitions());
+        REQUIRE(before != after);
+        REQUIRE(getNames(A.getDefinitions()) == after);
+    }
+}
+
+TEST_CASE("profile counts the queries", "DDA") {
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), SMD, context);
+    REQUIRE(M);
+
+    DGLLVMPointerAnalysis PTA(M.get());
+    PTA.run();
+
+    LLVMDataDependenceAnalysisOptions opts;
+    opts.profile = true;
+    dda::LLVMDataDependenceAnalysis DDA(M.get(), &PTA, opts);
+    DDA.run();
+
+    uint64_t uses = 0;
+    for (auto &I : llvm::instructions(M->getFunction("main"))) {
+        if (DDA.isUse(&I)) {
+            DDA.getLLVMDefinitions(&I);
+            ++uses;
+        }
+    }
+
+    auto *SSA = static_cast<dda::MemorySSATransformation *>(
+            DDA.getDDA()->getImpl());
+    // the definitions of @g in main come from the called functions
+    uint64_t descents = 0;
+    for (auto *subg : DDA.getGraph()->subgraphs()) {
+        const auto *profile = SSA->getProfile(subg);
+        REQUIRE(profile);
+        descents += profile->descents;
+        if (subg->getName() == "main") {
+            REQUIRE(profile->queries == uses);
+            REQUIRE(profile->lvnScans > 0);
+            REQUIRE(profile->maxDefinitions > 0);
+        } else {
+            REQUIRE(profile->queries == 0);
+        }
+    }
+    REQUIRE(descents > 0);
+}
+
+TEST_CASE("query at a removed useless node", "DDA") {
+    // %a is never read, so the store to it is useless
+    const char *source = R"(
+define i32 @main() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32 1, i32* %a
+  store i32 2, i32* %b
+  %x = load i32, i32* %b
+  ret i32 %x
+}
+)";
+
+    for (bool prune : {false, true}) {
+        llvm::LLVMContext context;
+        llvm::SMDiagnostic SMD;
+        auto M = llvm::parseIR(llvm::MemoryBufferRef(source, "test"), SMD,
+                               context);
+        REQUIRE(M);
+
+        DGLLVMPointerAnalysis PTA(M.get());
+        PTA.run();
+
+        LLVMDataDependenceAnalysisOptions opts;
+        opts.removeUselessNodes = prune;
+        dda::LLVMDataDependenceAnalysis DDA(M.get(), &PTA, opts);
+        DDA.run();
+
+        auto *a = getInstruction(*M, "main", "a");
+        auto *store = llvm::cast<llvm::Instruction>(*a->user_begin());
+        REQUIRE(llvm::isa<llvm::StoreInst>(store));
+        auto defs = DDA.getLLVMDefinitions(store, a, 0, 4);
+        if (prune) {
+            REQUIRE(!DDA.getNode(store)->getBBlock());
+            REQUIRE(defs.empty());
+        } else {
+            REQUIRE(defs.size() == 1);
+        }
+
+        // the kept nodes can still be used as the place of queries
+        auto *x = getInstruction(*M, "main", "x");
+        defs = DDA.getLLVMDefinitions(x, getInstruction(*M, "main", "b"), 0,
+                                      4);
+        REQUIRE(defs.size() == 1);
+    }
+}
+
+TEST_CASE("update does not reuse the nodes of deleted allocations", "DDA") {
+    // add an unused alloca that the change deletes
+    auto addAlloca = [](llvm::Module &M) {
+        auto *b = getInstruction(M, "main", "b");
+        new llvm::AllocaInst(llvm::Type::getInt32Ty(M.getContext()), 0, "t",
+                             b->getNextNode());
+    };
+    // the new instruction may be allocated at the address of the deleted
+    // alloca, it must not get the node of the alloca
+    auto change = [](llvm::Module &M) -> llvm::Instruction * {
+        auto *b = getInstruction(M, "main", "b");
+        getInstruction(M, "main", "t")->eraseFromParent();
+        return llvm::CastInst::CreatePointerCast(
+                b, llvm::Type::getInt8PtrTy(M.getContext()), "p",
+                b->getNextNode());
+    };
+
+    Analyses A(1, addAlloca);
+    // compute the results that the update must throw away
+    A.getDefinitions();
+
+    auto *p = change(*A.M);
+    REQUIRE(A.DDA->update(A.M->getFunction("main")));
+    REQUIRE(A.DDA->getNode(p) == nullptr);
+
+    Analyses fresh(1, [&](llvm::Module &M) {
+        addAlloca(M);
+        change(M);
+    });
+    REQUIRE(getNames(A.getDefinitions()) ==
+            getNames(fresh.getDefinitions()));
+}
@@ -1,7 +1,22 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
 #include "dg/DFS.h"
+#include "dg/SliceReachability.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/LLVMSlicer.h"
 
 TEST_CASE("reference counting test", "LLVM DG") {
     using namespace dg;
@@ -43,3 +58,256 @@ TEST_CASE("reference counting test", "LLVM DG") {
     delete entryBB1;
     delete entryBB2;
 }
+
+static const char *code = R"(
+declare void @__assert_fail()
+declare i32 @nondet()
+
+@g = global i32 0
+
+define i32 @foo(i32* %p, i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [0, %entry], [%i1, %body]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+body:
+  %v = load i32, i32* %p
+  %v1 = add i32 %v, %i
+  store i32 %v1, i32* %p
+  %i1 = add i32 %i, 1
+  br label %loop
+exit:
+  %r = load i32, i32* %p
+  ret i32 %r
+}
+
+define i32 @main() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32 0, i32* %a
+  store i32 1, i32* %b
+  %n = call i32 @nondet()
+  %x = call i32 @foo(i32* %a, i32 %n)
+  %y = call i32 @foo(i32* %b, i32 3)
+  store i32 %y, i32* @g
+  %c = icmp eq i32 %x, 10
+  br i1 %c, label %ok, label %err
+err:
+  call void @__assert_fail()
+  unreachable
+ok:
+  ret i32 0
+}
+)";
+
+TEST_CASE("slice reachability matches marking", "LLVM DG") {
+    using namespace dg;
+
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), SMD, context);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get(), {});
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    // every instruction is a set of criteria and there are
+    // also sets with more criteria
+    std::vector<std::set<LLVMNode *>> criteria;
+    std::set<LLVMNode *> all;
+    for (auto &F : *M) {
+        const auto &CF = getConstructedFunctions();
+        auto it = CF.find(&F);
+        if (it == CF.end())
+            continue;
+        std::set<LLVMNode *> fun;
+        for (auto &I : llvm::instructions(F)) {
+            auto *nd = it->second->getNode(&I);
+            REQUIRE(nd);
+            criteria.push_back({nd});
+            fun.insert(nd);
+        }
+        all.insert(fun.begin(), fun.end());
+        criteria.push_back(std::move(fun));
+    }
+    criteria.push_back(std::move(all));
+
+    SliceReachability<LLVMNode> reachability(criteria);
+    auto slices = reachability.slices(criteria, 4);
+    REQUIRE(slices.size() == criteria.size());
+
+    llvmdg::LLVMSlicer slicer;
+    for (size_t i = 0; i < criteria.size(); ++i) {
+        const auto sl_id = static_cast<uint32_t>(i + 1);
+        for (auto *nd : criteria[i])
+            slicer.mark(nd, sl_id);
+
+        // all the marked nodes are reachable from the criteria,
+        // so it is enough to check the nodes known to reachability
+        size_t marked = 0;
+        for (auto *nd : reachability.nodes()) {
+            if (nd->getSlice() == sl_id)
+                ++marked;
+        }
+        REQUIRE(marked == slices[i].size());
+        for (auto *nd : slices[i])
+            REQUIRE(nd->getSlice() == sl_id);
+    }
+}
+
+TEST_CASE("frozen edges", "LLVM DG") {
+    using namespace dg;
+
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), SMD, context);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphOptions options;
+    options.freezeEdges = false;
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get(), options);
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    using Edges = std::vector<std::vector<LLVMNode *>>;
+    auto getEdges = [](const LLVMNode *nd) {
+        Edges edges(EDGES_KINDS_NUM);
+        for (unsigned k = 0; k < EDGES_KINDS_NUM; ++k) {
+            auto kind = static_cast<EdgesKind>(k);
+            edges[k].assign(nd->edges_begin(kind), nd->edges_end(kind));
+            REQUIRE(edges[k].size() == nd->getEdgesNum(kind));
+        }
+        return edges;
+    };
+
+    std::map<LLVMNode *, Edges> before;
+    for (const auto &F : getConstructedFunctions()) {
+        for (auto &it : *F.second)
+            before[it.second] = getEdges(it.second);
+    }
+
+    dg->freeze();
+
+    LLVMNode *withData = nullptr;
+    for (auto &it : before) {
+        REQUIRE(it.first->isFrozen());
+        REQUIRE(getEdges(it.first) == it.second);
+        if (!withData && it.first->getDataDependenciesNum() > 0)
+            withData = it.first;
+    }
+    REQUIRE(withData);
+
+    // removing and adding edges keeps both directions in sync
+    LLVMNode *target = *withData->data_begin();
+    auto targetEdges = getEdges(target);
+    REQUIRE(withData->isFrozen(EDGES_DATA));
+    REQUIRE(target->isFrozen(EDGES_REV_DATA));
+    REQUIRE(withData->removeDataDependence(target));
+    REQUIRE(!withData->removeDataDependence(target));
+    REQUIRE(withData->getDataDependenciesNum() ==
+            before[withData][EDGES_DATA].size() - 1);
+    REQUIRE(target->getRevDataDependenciesNum() ==
+            targetEdges[EDGES_REV_DATA].size() - 1);
+
+    REQUIRE(withData->addDataDependence(target));
+    REQUIRE(!withData->addDataDependence(target));
+    REQUIRE(!withData->isFrozen(EDGES_DATA));
+    REQUIRE(!target->isFrozen(EDGES_REV_DATA));
+    REQUIRE(getEdges(withData) == before[withData]);
+    REQUIRE(getEdges(target) == targetEdges);
+
+    // isolating a node removes it from frozen edges of other nodes
+    std::set<LLVMNode *> neighbours;
+    for (auto &kindEdges : before[withData])
+        neighbours.insert(kindEdges.begin(), kindEdges.end());
+    withData->isolate();
+    for (unsigned k = 0; k < EDGES_KINDS_NUM; ++k) {
+        auto kind = static_cast<EdgesKind>(k);
+        if (kind != EDGES_INTERFERENCE && kind != EDGES_REV_INTERFERENCE)
+            REQUIRE(withData->getEdgesNum(kind) == 0);
+    }
+    for (auto *nd : neighbours) {
+        auto edges = getEdges(nd);
+        for (auto &kindEdges : edges)
+            REQUIRE(std::find(kindEdges.begin(), kindEdges.end(), withData) ==
+                    kindEdges.end());
+    }
+}
+
+TEST_CASE("control dependencies on demand", "LLVM DG") {
+    using namespace dg;
+    using CDAlgorithm = LLVMControlDependenceAnalysisOptions::CDAlgorithm;
+
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), SMD, context);
+    REQUIRE(M);
+
+    // the instructions marked from every instruction as the criterion
+    // (the constructed functions are global, so the graphs for the module
+    // must be built one after another)
+    auto getSlices = [&M](CDAlgorithm algorithm, bool onDemand) {
+        llvmdg::LLVMDependenceGraphOptions options;
+        options.CDAOptions.algorithm = algorithm;
+        options.CDOnDemand = onDemand;
+        llvmdg::LLVMDependenceGraphBuilder builder(M.get(), options);
+        auto dg = builder.build();
+        REQUIRE(dg);
+        REQUIRE(LLVMDependenceGraph::getPendingControlDependenciesNum() ==
+                (onDemand ? 2 : 0));
+
+        std::map<LLVMNode *, const llvm::Value *> values;
+        std::vector<LLVMNode *> criteria;
+        for (const auto &F : getConstructedFunctions()) {
+            for (auto &it : *F.second) {
+                values[it.second] = it.first;
+                criteria.push_back(it.second);
+            }
+        }
+
+        std::map<const llvm::Value *, std::set<const llvm::Value *>> slices;
+        llvmdg::LLVMSlicer slicer;
+        for (size_t i = 0; i < criteria.size(); ++i) {
+            const auto sl_id = static_cast<uint32_t>(i + 1);
+            slicer.mark(criteria[i], sl_id);
+            auto &slice = slices[values[criteria[i]]];
+            for (auto &it : values) {
+                if (it.first->getSlice() == sl_id)
+                    slice.insert(it.second);
+            }
+        }
+        REQUIRE(LLVMDependenceGraph::getPendingControlDependenciesNum() == 0);
+        return slices;
+    };
+
+    for (auto algorithm : {CDAlgorithm::STANDARD, CDAlgorithm::NTSCD}) {
+        auto slices = getSlices(algorithm, false);
+        REQUIRE(slices == getSlices(algorithm, true));
+    }
+
+    // the control dependencies of functions that marking
+    // does not reach are not computed
+    llvmdg::LLVMDependenceGraphOptions options;
+    options.CDOnDemand = true;
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get(), options);
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    llvm::Instruction *nondet = nullptr;
+    for (auto &I : llvm::instructions(M->getFunction("main"))) {
+        if (I.getName() == "n")
+            nondet = &I;
+    }
+    REQUIRE(nondet);
+    llvmdg::LLVMSlicer slicer;
+    slicer.mark(dg->getNode(nondet), 1);
+    // @foo is not reached
+    REQUIRE(LLVMDependenceGraph::getPendingControlDependenciesNum() == 1);
+
+    LLVMDependenceGraph::computePendingControlDependencies();
+    REQUIRE(LLVMDependenceGraph::getPendingControlDependenciesNum() == 0);
+}
@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+
+using namespace dg;
+
+// a call via function pointer builds the called functions
+// into the graph during the analysis
+static const char *code = R"(
+declare i8* @malloc(i64)
+
+@g = global i32* null
+@fptr = global i32 (i32*)* null
+
+define i32 @inc(i32* %p) {
+  %v = load i32, i32* %p
+  %q = call i8* @malloc(i64 4)
+  %qi = bitcast i8* %q to i32*
+  store i32* %qi, i32** @g
+  ret i32 %v
+}
+
+define i32 @dec(i32* %p) {
+  %v = load i32, i32* %p
+  store i32* %p, i32** @g
+  ret i32 %v
+}
+
+define i32 @main(i32 %n) {
+entry:
+  %a = alloca i32
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %l1, label %l2
+l1:
+  store i32 (i32*)* @inc, i32 (i32*)** @fptr
+  br label %j
+l2:
+  store i32 (i32*)* @dec, i32 (i32*)** @fptr
+  br label %j
+j:
+  %f = load i32 (i32*)*, i32 (i32*)** @fptr
+  %x = call i32 %f(i32* %a)
+  %gp = load i32*, i32** @g
+  %y = load i32, i32* %gp
+  ret i32 %y
+}
+)";
+
+using ResultsT =
+        std::vector<std::pair<bool, std::set<std::pair<llvm::Value *, uint64_t>>>>;
+
+// the points-to sets of all the instructions in the module
+static ResultsT getResults(llvm::Module &M,
+                           const LLVMPointerAnalysisOptions &opts) {
+    DGLLVMPointerAnalysis PTA(&M, opts);
+    PTA.run();
+
+    ResultsT results;
+    for (auto &F : M) {
+        for (auto &I : llvm::instructions(F)) {
+            auto pts = PTA.getLLVMPointsToChecked(&I);
+            std::set<std::pair<llvm::Value *, uint64_t>> S;
+            for (const auto &ptr : pts.second)
+                S.emplace(ptr.value, *ptr.offset);
+            results.emplace_back(pts.first, std::move(S));
+        }
+    }
+    return results;
+}
+
+TEST_CASE("Cached results", "[PTA cache]") {
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), err, ctx);
+    REQUIRE(M);
+
+    llvm::SmallString<128> dir;
+    REQUIRE(!llvm::sys::fs::createUniqueDirectory("dg-pta-cache", dir));
+
+    for (auto type : {LLVMPointerAnalysisOptions::AnalysisType::fi,
+                      LLVMPointerAnalysisOptions::AnalysisType::fs}) {
+        LLVMPointerAnalysisOptions opts;
+        opts.analysisType = type;
+        auto expected = getResults(*M, opts);
+
+        opts.cacheDir = std::string(dir.str());
+        // the first run stores the results, the second loads them
+        REQUIRE(getResults(*M, opts) == expected);
+        REQUIRE(getResults(*M, opts) == expected);
+
+        DGLLVMPointerAnalysis PTA(M.get(), opts);
+        REQUIRE(llvm::sys::fs::exists(PTA.getCacheFile()));
+    }
+
+    llvm::sys::fs::remove_directories(dir);
+}
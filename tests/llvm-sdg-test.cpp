@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "dg/SystemDependenceGraph/MultiSliceReachability.h"
+#include "dg/llvm/SystemDependenceGraph/SystemDependenceGraph.h"
+
+using namespace dg;
+
+static const char *code = R"(
+declare void @__assert_fail()
+declare i32 @nondet()
+
+@g = global i32 0
+
+define i32 @foo(i32* %p, i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [0, %entry], [%i1, %body]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+body:
+  %v = load i32, i32* %p
+  %v1 = add i32 %v, %i
+  store i32 %v1, i32* %p
+  %i1 = add i32 %i, 1
+  br label %loop
+exit:
+  %r = load i32, i32* %p
+  ret i32 %r
+}
+
+define i32 @main() {
+entry:
+  %a = alloca i32
+  %b = alloca i32
+  store i32 0, i32* %a
+  store i32 1, i32* %b
+  %n = call i32 @nondet()
+  %x = call i32 @foo(i32* %a, i32 %n)
+  %y = call i32 @foo(i32* %b, i32 3)
+  store i32 %y, i32* @g
+  %c = icmp eq i32 %x, 10
+  br i1 %c, label %ok, label %err
+err:
+  call void @__assert_fail()
+  unreachable
+ok:
+  ret i32 0
+}
+)";
+
+using CriteriaT = std::vector<std::vector<sdg::DGElement *>>;
+
+template <unsigned Words>
+static void checkSlices(llvmdg::SystemDependenceGraph &sdg,
+                        const CriteriaT &crit) {
+    // all the criteria at once
+    sdg::MultiSliceReachability<Words> all(sdg.getSDG());
+    all.compute(crit);
+
+    for (unsigned i = 0; i < crit.size(); ++i) {
+        // only the i-th criterion (as the bit 0)
+        sdg::MultiSliceReachability<Words> one(sdg.getSDG());
+        one.compute(CriteriaT{crit[i]});
+
+        auto slice = all.getSlice(i);
+        REQUIRE(slice == one.getSlice(0));
+        for (auto *e : crit[i])
+            REQUIRE(all.isInSlice(e, i));
+    }
+}
+
+TEST_CASE("bit-parallel slices", "SDG") {
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "test"), SMD, context);
+    REQUIRE(M);
+
+    DGLLVMPointerAnalysis PTA(M.get());
+    PTA.run();
+    dda::LLVMDataDependenceAnalysis DDA(M.get(), &PTA);
+    DDA.run();
+    LLVMControlDependenceAnalysis CDA(M.get(), {});
+
+    llvmdg::SystemDependenceGraph sdg(M.get(), &PTA, &DDA, &CDA);
+
+    // every instruction is a criterion
+    CriteriaT crit;
+    for (auto &F : *M) {
+        for (auto &I : llvm::instructions(F)) {
+            auto *nd = sdg.getNode(&I);
+            REQUIRE(nd);
+            crit.push_back({nd});
+        }
+    }
+    REQUIRE(crit.size() <= 64);
+
+    checkSlices<1>(sdg, crit);
+    checkSlices<4>(sdg, crit);
+
+    // the value compared in main depends on the loads in foo,
+    // but not on the store to @g
+    auto *main = M->getFunction("main");
+    auto *foo = M->getFunction("foo");
+    llvm::Instruction *cmp = nullptr, *storeG = nullptr, *load = nullptr;
+    for (auto &I : llvm::instructions(main)) {
+        if (llvm::isa<llvm::ICmpInst>(I))
+            cmp = &I;
+        if (auto *S = llvm::dyn_cast<llvm::StoreInst>(&I))
+            if (S->getPointerOperand() == M->getGlobalVariable("g"))
+                storeG = &I;
+    }
+    for (auto &I : llvm::instructions(foo))
+        if (llvm::isa<llvm::LoadInst>(I))
+            load = &I;
+    REQUIRE(cmp);
+    REQUIRE(storeG);
+    REQUIRE(load);
+
+    sdg::MultiSliceReachability<> R(sdg.getSDG());
+    R.compute(CriteriaT{{sdg.getNode(cmp)}});
+    REQUIRE(R.isInSlice(sdg.getNode(cmp), 0));
+    REQUIRE(R.isInSlice(sdg.getNode(load), 0));
+    REQUIRE(!R.isInSlice(sdg.getNode(storeG), 0));
+}
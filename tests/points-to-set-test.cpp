@@ -1,5 +1,7 @@
 #include <catch2/catch.hpp>
 
+#include <vector>
+
 #include "dg/PointerAnalysis/PSNode.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
@@ -245,6 +247,85 @@ void testSmallOverflowBehavior() { // only works for SmallOffsetsPTSet
     REQUIRE(S.overflowSetSize() == 0);
 }
 
+void testHashConsedSharing() { // only works for HashConsedPointsToSet
+    HashConsedPointsToSet S1, S2, S3;
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.add(Pointer(A, 0)) == true);
+    REQUIRE(S1 != S2);
+    REQUIRE(S1.add(Pointer(B, 8)) == true);
+    // the same set created in a different order shares the storage
+    REQUIRE(S2.add(Pointer(B, 8)) == true);
+    REQUIRE(S2.add(Pointer(A, 0)) == true);
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.getHandle() == S2.getHandle());
+
+    auto unions = HashConsedPointsToSet::getNumOfMemoizedUnions();
+    REQUIRE(S3.add(Pointer(A, 0)) == true);
+    REQUIRE(S3.add(Pointer(B, 8)) == true);
+    // adding single pointers does not memoize unions
+    REQUIRE(HashConsedPointsToSet::getNumOfMemoizedUnions() == unions);
+    REQUIRE(S3 == S1);
+    REQUIRE(S3.add(S1) == false);
+
+    REQUIRE(S3.remove(Pointer(B, 8)) == true);
+    REQUIRE(S3 != S1);
+    REQUIRE(S3.size() == 1);
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S1.add(S3) == false);
+}
+
+void testHashConsedRelease() { // only works for HashConsedPointsToSet
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+
+    auto sets = HashConsedPointsToSet::getNumOfInternedSets();
+    auto unions = HashConsedPointsToSet::getNumOfMemoizedUnions();
+
+    HashConsedPointsToSet S3;
+    {
+        HashConsedPointsToSet S1, S2;
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(S1.add(Pointer(A, i)) == true);
+        // the sets built on the way are released
+        REQUIRE(HashConsedPointsToSet::getNumOfInternedSets() == sets + 1);
+
+        REQUIRE(S2.add(Pointer(A, 100)) == true);
+        HashConsedPointsToSet S5(S2);
+        REQUIRE(S2.add(S1) == true);
+        REQUIRE(S5.size() == 1);
+        REQUIRE(S2.size() == 101);
+        REQUIRE(HashConsedPointsToSet::getNumOfInternedSets() == sets + 3);
+        REQUIRE(HashConsedPointsToSet::getNumOfMemoizedUnions() == unions + 1);
+
+        S3 = S1;
+    }
+
+    // S3 keeps the set alive, the rest is released
+    REQUIRE(S3.size() == 100);
+    REQUIRE(HashConsedPointsToSet::getNumOfInternedSets() == sets + 1);
+    REQUIRE(HashConsedPointsToSet::getNumOfMemoizedUnions() == unions);
+
+    // adding the pointers at once interns only the result
+    HashConsedPointsToSet S4;
+    std::vector<Pointer> ptrs;
+    for (int i = 100; i < 200; ++i)
+        ptrs.emplace_back(A, i);
+    REQUIRE(S4.add(ptrs) == true);
+    REQUIRE(S4.size() == 100);
+    REQUIRE(HashConsedPointsToSet::getNumOfInternedSets() == sets + 2);
+    REQUIRE(S4.add(Pointer(A, dg::Offset::UNKNOWN)) == true);
+    REQUIRE(S4.size() == 1);
+    REQUIRE(S4.add(ptrs) == false);
+
+    S3.clear();
+    S4.clear();
+    REQUIRE(HashConsedPointsToSet::getNumOfInternedSets() == sets);
+}
+
 TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<OffsetsSetPointsToSet>();
     queryingEmptySet<SimplePointsToSet>();
@@ -253,6 +334,7 @@ TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<SmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedSmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedPointerIdPointsToSet>();
+    queryingEmptySet<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add an element", "PointsToSet") {
@@ -263,6 +345,7 @@ TEST_CASE("Add an element", "PointsToSet") {
     addAnElement<SmallOffsetsPointsToSet>();
     addAnElement<AlignedSmallOffsetsPointsToSet>();
     addAnElement<AlignedPointerIdPointsToSet>();
+    addAnElement<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add few elements", "PointsToSet") {
@@ -273,6 +356,7 @@ TEST_CASE("Add few elements", "PointsToSet") {
     addFewElements<SmallOffsetsPointsToSet>();
     addFewElements<AlignedSmallOffsetsPointsToSet>();
     addFewElements<AlignedPointerIdPointsToSet>();
+    addFewElements<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add few elements 2", "PointsToSet") {
@@ -283,6 +367,7 @@ TEST_CASE("Add few elements 2", "PointsToSet") {
     addFewElements2<SmallOffsetsPointsToSet>();
     addFewElements2<AlignedSmallOffsetsPointsToSet>();
     addFewElements2<AlignedPointerIdPointsToSet>();
+    addFewElements2<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Merge points-to sets", "PointsToSet") {
@@ -293,6 +378,7 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     mergePointsToSets<SmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedSmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedPointerIdPointsToSet>();
+    mergePointsToSets<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove element",
@@ -304,6 +390,7 @@ TEST_CASE("Remove element",
     removeElement<SmallOffsetsPointsToSet>();
     removeElement<AlignedSmallOffsetsPointsToSet>();
     removeElement<AlignedPointerIdPointsToSet>();
+    removeElement<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove few elements",
@@ -315,6 +402,7 @@ TEST_CASE("Remove few elements",
     removeFewElements<SmallOffsetsPointsToSet>();
     removeFewElements<AlignedSmallOffsetsPointsToSet>();
     removeFewElements<AlignedPointerIdPointsToSet>();
+    removeFewElements<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove all elements pointing to a target",
@@ -326,6 +414,7 @@ TEST_CASE("Remove all elements pointing to a target",
     removeAnyTest<SmallOffsetsPointsToSet>();
     removeAnyTest<AlignedSmallOffsetsPointsToSet>();
     removeAnyTest<AlignedPointerIdPointsToSet>();
+    removeAnyTest<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Test various points-to functions", "PointsToSet") {
@@ -336,6 +425,7 @@ TEST_CASE("Test various points-to functions", "PointsToSet") {
     pointsToTest<SmallOffsetsPointsToSet>();
     pointsToTest<AlignedSmallOffsetsPointsToSet>();
     pointsToTest<AlignedPointerIdPointsToSet>();
+    pointsToTest<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Test small overflow set behavior", "PointsToSet") {
@@ -346,3 +436,11 @@ TEST_CASE("Test aligned overflow set behavior", "PointsToSet") {
     testAlignedOverflowBehavior<AlignedSmallOffsetsPointsToSet>();
     testAlignedOverflowBehavior<AlignedPointerIdPointsToSet>();
 }
+
+TEST_CASE("Test hash-consed sets sharing", "PointsToSet") {
+    testHashConsedSharing();
+}
+
+TEST_CASE("Test hash-consed sets release", "PointsToSet") {
+    testHashConsedRelease();
+}
@@ -868,6 +868,72 @@ void memcpy_test8() {
     REQUIRE(L3->doesPointsTo(NULLPTR));
 }
 
+// the load precedes the store in the CFG. The iterative solver
+// does not revisit the load, because it is not reachable from the store,
+// but the difference propagation solver computes the full fixpoint
+template <typename PTStoT>
+void fi_load_before_store() {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(B);
+    PSNode *CAST = PS.create<PSNodeType::CAST>(L1);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(CAST);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, B);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(C, A);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(L1);
+    L1->addSuccessor(CAST);
+    CAST->addSuccessor(L2);
+    L2->addSuccessor(S1);
+    S1->addSuccessor(S2);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS);
+    PA.run();
+
+    REQUIRE(L1->doesPointsTo(A));
+    REQUIRE(CAST->doesPointsTo(A));
+    REQUIRE(L2->doesPointsTo(C));
+}
+
+// cycle of copy edges, returns the number of collapsed nodes
+template <typename PTStoT>
+unsigned copy_cycle() {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *P1 = PS.create<PSNodeType::PHI>(A);
+    PSNode *C = PS.create<PSNodeType::CAST>(P1);
+    PSNode *P2 = PS.create<PSNodeType::PHI>(B, C);
+    PSNode *L = PS.create<PSNodeType::LOAD>(P2);
+    P1->addOperand(P2);
+
+    A->addSuccessor(B);
+    B->addSuccessor(P1);
+    P1->addSuccessor(C);
+    C->addSuccessor(P2);
+    P2->addSuccessor(P1);
+    P2->addSuccessor(L);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS);
+    PA.run();
+
+    for (PSNode *n : {P1, C, P2}) {
+        REQUIRE(n->doesPointsTo(A));
+        REQUIRE(n->doesPointsTo(B));
+        REQUIRE(n->pointsTo.size() == 2);
+    }
+
+    return PA.getNumOfCollapsedNodes();
+}
+
 TEST_CASE("Flow insensitive", "FI") {
     store_load<dg::pta::PointerAnalysisFI>();
     store_load2<dg::pta::PointerAnalysisFI>();
@@ -893,6 +959,84 @@ TEST_CASE("Flow insensitive", "FI") {
     memcpy_test6<dg::pta::PointerAnalysisFI>();
     memcpy_test7<dg::pta::PointerAnalysisFI>();
     memcpy_test8<dg::pta::PointerAnalysisFI>();
+    REQUIRE(copy_cycle<dg::pta::PointerAnalysisFI>() == 0);
+}
+
+// flow-insensitive analysis solved by the difference propagation solver
+class PointerAnalysisFIDiff : public PointerAnalysisFI {
+  public:
+    PointerAnalysisFIDiff(PointerGraph *PS)
+            : PointerAnalysisFI(
+                      PS, dg::PointerAnalysisOptions().setDiffPropagation(
+                                  true)) {}
+};
+
+TEST_CASE("Flow insensitive with difference propagation", "FI") {
+    store_load<PointerAnalysisFIDiff>();
+    store_load2<PointerAnalysisFIDiff>();
+    store_load3<PointerAnalysisFIDiff>();
+    store_load4<PointerAnalysisFIDiff>();
+    store_load5<PointerAnalysisFIDiff>();
+    gep1<PointerAnalysisFIDiff>();
+    gep2<PointerAnalysisFIDiff>();
+    gep3<PointerAnalysisFIDiff>();
+    gep4<PointerAnalysisFIDiff>();
+    gep5<PointerAnalysisFIDiff>();
+    nulltest<PointerAnalysisFIDiff>();
+    constant_store<PointerAnalysisFIDiff>();
+    load_from_zeroed<PointerAnalysisFIDiff>();
+    load_from_unknown_offset<PointerAnalysisFIDiff>();
+    load_from_unknown_offset2<PointerAnalysisFIDiff>();
+    load_from_unknown_offset3<PointerAnalysisFIDiff>();
+    memcpy_test<PointerAnalysisFIDiff>();
+    memcpy_test2<PointerAnalysisFIDiff>();
+    memcpy_test3<PointerAnalysisFIDiff>();
+    memcpy_test4<PointerAnalysisFIDiff>();
+    memcpy_test5<PointerAnalysisFIDiff>();
+    memcpy_test6<PointerAnalysisFIDiff>();
+    memcpy_test7<PointerAnalysisFIDiff>();
+    memcpy_test8<PointerAnalysisFIDiff>();
+    fi_load_before_store<PointerAnalysisFIDiff>();
+    REQUIRE(copy_cycle<PointerAnalysisFIDiff>() == 0);
+}
+
+// the same as above, but collapsing cycles of copy edges
+class PointerAnalysisFICollapse : public PointerAnalysisFI {
+  public:
+    PointerAnalysisFICollapse(PointerGraph *PS)
+            : PointerAnalysisFI(PS, dg::PointerAnalysisOptions()
+                                            .setDiffPropagation(true)
+                                            .setCollapseCycles(true)) {}
+};
+
+TEST_CASE("Flow insensitive with collapsing cycles", "FI") {
+    store_load<PointerAnalysisFICollapse>();
+    store_load2<PointerAnalysisFICollapse>();
+    store_load3<PointerAnalysisFICollapse>();
+    store_load4<PointerAnalysisFICollapse>();
+    store_load5<PointerAnalysisFICollapse>();
+    gep1<PointerAnalysisFICollapse>();
+    gep2<PointerAnalysisFICollapse>();
+    gep3<PointerAnalysisFICollapse>();
+    gep4<PointerAnalysisFICollapse>();
+    gep5<PointerAnalysisFICollapse>();
+    nulltest<PointerAnalysisFICollapse>();
+    constant_store<PointerAnalysisFICollapse>();
+    load_from_zeroed<PointerAnalysisFICollapse>();
+    load_from_unknown_offset<PointerAnalysisFICollapse>();
+    load_from_unknown_offset2<PointerAnalysisFICollapse>();
+    load_from_unknown_offset3<PointerAnalysisFICollapse>();
+    memcpy_test<PointerAnalysisFICollapse>();
+    memcpy_test2<PointerAnalysisFICollapse>();
+    memcpy_test3<PointerAnalysisFICollapse>();
+    memcpy_test4<PointerAnalysisFICollapse>();
+    memcpy_test5<PointerAnalysisFICollapse>();
+    memcpy_test6<PointerAnalysisFICollapse>();
+    memcpy_test7<PointerAnalysisFICollapse>();
+    memcpy_test8<PointerAnalysisFICollapse>();
+    fi_load_before_store<PointerAnalysisFICollapse>();
+    // P1, C, and P2 are collapsed into one node
+    REQUIRE(copy_cycle<PointerAnalysisFICollapse>() == 2);
 }
 
 TEST_CASE("Flow sensitive", "FS") {
@@ -1,3 +1,5 @@
+#include <cstdlib>
+#include <iostream>
 #include <random>
 #include <string>
 #include <vector>
@@ -11,20 +13,70 @@ std::default_random_engine generator;
 std::uniform_int_distribution<uint64_t> distribution(0,
                                                      ~static_cast<uint64_t>(0));
 
+// The allocated memory, tracked to compare the peak memory
+// of the implementations of points-to sets
+static size_t allocated = 0;
+static size_t peak = 0;
+
+void *operator new(std::size_t size) {
+    // keep the size of the block in front of it
+    auto *mem = static_cast<std::max_align_t *>(
+            std::malloc(size + sizeof(std::max_align_t)));
+    if (!mem)
+        std::abort();
+    *reinterpret_cast<size_t *>(mem) = size;
+    allocated += size;
+    if (allocated > peak)
+        peak = allocated;
+    return mem + 1;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (!ptr)
+        return;
+    auto *mem = static_cast<std::max_align_t *>(ptr) - 1;
+    allocated -= *reinterpret_cast<size_t *>(mem);
+    std::free(mem);
+}
+
+void operator delete(void *ptr, std::size_t /*unused*/) noexcept {
+    operator delete(ptr);
+}
+
+static void resetPeak() { peak = allocated; }
+
+static void reportPeak(size_t base) {
+    std::cerr << "    peak memory " << (peak - base) / 1024 << " kB\n";
+}
+
 #define run(func, msg)                                                         \
     do {                                                                       \
         std::cout << "Running " << (msg) << "\n";                              \
         dg::debug::TimeMeasure tm;                                             \
+        size_t base = allocated;                                               \
+        resetPeak();                                                           \
         tm.start();                                                            \
         for (int i = 0; i < times; ++i)                                        \
             func<PointsToSetT>();                                              \
         tm.stop();                                                             \
         tm.report(" -- PointsToSet bitvector took");                           \
+        reportPeak(base);                                                      \
+        base = allocated;                                                      \
+        resetPeak();                                                           \
         tm.start();                                                            \
         for (int i = 0; i < times; ++i)                                        \
             func<SimplePointsToSet>();                                         \
         tm.stop();                                                             \
         tm.report(" -- PointsToSet std::set took");                            \
+        reportPeak(base);                                                      \
+        base = allocated;                                                      \
+        resetPeak();                                                           \
+        tm.start();                                                            \
+        for (int i = 0; i < times; ++i)                                        \
+            func<HashConsedPointsToSet>();                                     \
+        tm.stop();                                                             \
+        tm.report(" -- PointsToSet hash-consed took");                         \
+        reportPeak(base);                                                      \
     } while (0);
 
 template <typename PTSetT>
@@ -84,6 +136,18 @@ void test5() {
     }
 }
 
+// many sets with the same elements that are alive at once
+// (e.g., the points-to sets of copies of the same pointer)
+template <typename PTSetT>
+void test6() {
+    std::vector<PTSetT> sets(1000);
+    for (auto &S : sets) {
+        for (int i = 0; i < 100; ++i) {
+            S.add(reinterpret_cast<PSNode *>(i + 1), 8 * i);
+        }
+    }
+}
+
 int main() {
     int times;
     times = 100000;
@@ -100,4 +164,7 @@ int main() {
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    times = 100;
+    run(test6, "Adding 100 pointers to 1000 sets");
 }
@@ -1,5 +1,8 @@
 #include <catch2/catch.hpp>
 
+#include <list>
+
+#include "dg/MemorySSA/DefinitionsMap.h"
 #include "dg/ReadWriteGraph/ReadWriteGraph.h"
 
 using namespace dg::dda;
@@ -89,3 +92,141 @@ TEST_CASE("split around in middle", "[RWBBlock]") {
     CHECK(blks.first->getSingleSuccessor() == blks.second.get());
     CHECK(blks.second->getSingleSuccessor() == &succ);
 }
+
+TEST_CASE("copy is not changed by the original", "[DefinitionsMap]") {
+    RWNode mem, A, B;
+    DefinitionsMap<RWNode> M;
+    M.add({&mem, 0, 4}, &A);
+
+    auto copy = M;
+    REQUIRE(copy == M);
+    REQUIRE(M.add({&mem, 0, 8}, &B));
+    REQUIRE(M.update({&mem, 0, 2}, &A));
+    REQUIRE(M.addAll(&B));
+
+    REQUIRE(copy.get({&mem, 0, 4}) == std::set<RWNode *>{&A});
+    REQUIRE(copy.undefinedIntervals({&mem, 0, 8}).size() == 1);
+    REQUIRE(M.get({&mem, 0, 4}) == (std::set<RWNode *>{&A, &B}));
+    REQUIRE(!(copy == M));
+}
+
+TEST_CASE("original is not changed by the copy", "[DefinitionsMap]") {
+    RWNode mem1, mem2, A, B;
+    DefinitionsMap<RWNode> M;
+    M.add({&mem1, 0, 4}, &A);
+
+    DefinitionsMap<RWNode> copy;
+    REQUIRE(copy.add(M));
+    REQUIRE(!copy.add(M));
+    REQUIRE(!copy.add({&mem1, 0, 4}, &A));
+    REQUIRE(copy.add({&mem1, 0, 4}, &B));
+    REQUIRE(copy.add({&mem2, 0, 4}, &B));
+
+    REQUIRE(M.size() == 1);
+    REQUIRE(M.get({&mem1, 0, 4}) == std::set<RWNode *>{&A});
+    REQUIRE(copy.get({&mem1, 0, 4}) == (std::set<RWNode *>{&A, &B}));
+
+    DefinitionsMap<RWNode> target;
+    REQUIRE(target.addTarget(&mem1, M));
+    REQUIRE(!target.addTarget(&mem2, M));
+    REQUIRE(target.addTarget(&mem1, copy));
+    REQUIRE(M.get({&mem1, 0, 4}) == std::set<RWNode *>{&A});
+    REQUIRE(target.get({&mem1, 0, 4}) == (std::set<RWNode *>{&A, &B}));
+}
+
+TEST_CASE("map with DisjunctiveIntervalMap", "[DefinitionsMap]") {
+    RWNode mem, A, B;
+    DefinitionsMap<RWNode, dg::ADT::DisjunctiveIntervalMap<RWNode *>> M;
+    M.add({&mem, 0, 4}, &A);
+
+    auto copy = M;
+    REQUIRE(M.add({&mem, 2, 4}, &B));
+    REQUIRE(copy.get({&mem, 0, 8}) == std::set<RWNode *>{&A});
+    REQUIRE(M.get({&mem, 0, 8}) == (std::set<RWNode *>{&A, &B}));
+}
+
+TEST_CASE("remove useless nodes", "[ReadWriteGraph]") {
+    ReadWriteGraph G;
+    auto &subg = G.createSubgraph();
+    auto &entry = subg.createBBlock();
+    auto &B1 = subg.createBBlock();
+    auto &B2 = subg.createBBlock();
+    auto &B3 = subg.createBBlock();
+    entry.addSuccessor(&B1);
+    B1.addSuccessor(&B2);
+    B2.addSuccessor(&B3);
+
+    auto &A1 = G.create(RWNodeType::ALLOC);
+    auto &A2 = G.create(RWNodeType::ALLOC);
+    entry.append(&A1);
+    entry.append(&A2);
+
+    // A2 is never read, so S2 and S3 are useless
+    auto &S1 = G.create(RWNodeType::STORE);
+    auto &S2 = G.create(RWNodeType::STORE);
+    auto &S3 = G.create(RWNodeType::STORE);
+    S1.addDef(&A1, 0, 4);
+    S2.addDef(&A2, 0, 4);
+    S3.addDef(&A2, 0, 4, /* strong update = */ true);
+    B1.append(&S1);
+    B1.append(&S2);
+    B2.append(&S3);
+
+    auto &L = G.create(RWNodeType::LOAD);
+    L.addUse(&A1, 0, 4);
+    B3.append(&L);
+
+    REQUIRE(G.removeUselessNodes() == 2);
+    CHECK(S2.getBBlock() == nullptr);
+    CHECK(S3.getBBlock() == nullptr);
+    CHECK(B1.getNodes() == std::list<RWNode *>{&S1});
+    CHECK(B2.empty());
+
+    REQUIRE(G.removeEmptyBBlocks() == 1);
+    CHECK(subg.size() == 3);
+    CHECK(B1.getSingleSuccessor() == &B3);
+    CHECK(B3.getSinglePredecessor() == &B1);
+}
+
+TEST_CASE("keep nodes that may be read", "[ReadWriteGraph]") {
+    RWNode global(RWNodeType::GLOBAL);
+    ReadWriteGraph G;
+    auto &subg = G.createSubgraph();
+    auto &entry = subg.createBBlock();
+
+    auto &A = G.create(RWNodeType::ALLOC);
+    entry.append(&A);
+
+    auto &S1 = G.create(RWNodeType::STORE);
+    auto &S2 = G.create(RWNodeType::STORE);
+    S1.addDef(&global, 0, 4);
+    S2.addDef(UNKNOWN_MEMORY, 0, 4);
+    entry.append(&S1);
+    entry.append(&S2);
+
+    // the memory read by a call of an undefined function
+    auto &model = G.create(RWNodeType::GENERIC);
+    model.addUse(&A);
+    auto *C = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    C->addCallee(&model);
+
+    auto &S3 = G.create(RWNodeType::STORE);
+    S3.addDef(&A, 0, 4);
+    entry.append(&S3);
+    entry.append(C);
+
+    REQUIRE(G.removeUselessNodes() == 0);
+
+    // nothing can be removed when someone reads unknown memory
+    auto &A2 = G.create(RWNodeType::ALLOC);
+    auto &S4 = G.create(RWNodeType::STORE);
+    auto &L = G.create(RWNodeType::LOAD);
+    S4.addDef(&A2, 0, 4);
+    L.addUse(UNKNOWN_MEMORY);
+    entry.append(&A2);
+    entry.append(&S4);
+    entry.append(&L);
+
+    REQUIRE(G.removeUselessNodes() == 0);
+    CHECK(entry.size() == 8);
+}
@@ -3,6 +3,10 @@
 
 #include <ctime>
 #include <fstream>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include <llvm/IR/Module.h>
 #include <llvm/Support/raw_os_ostream.h>
@@ -14,6 +18,7 @@
 #include <llvm/Bitcode/ReaderWriter.h>
 #endif
 
+#include "dg/SliceReachability.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
 #include "dg/llvm/LLVMSlicer.h"
@@ -26,6 +31,22 @@
 #include "llvm-slicer-opts.h"
 #include "llvm-slicer-utils.h"
 
+///
+// The instructions and blocks that are in the slice with the given id.
+// Unlike the nodes of the dependence graph, the marks are stored as
+// positions in the functions, so they can be applied also to a dependence
+// graph built for another copy of the same module.
+struct SliceMarks {
+    struct FunctionMarks {
+        std::vector<bool> blocks;
+        // the instructions of the function in the order of the blocks
+        std::vector<bool> instructions;
+    };
+
+    uint32_t sliceId{0};
+    std::map<std::string, FunctionMarks> functions;
+};
+
 /// --------------------------------------------------------------------
 //   - Slicer class -
 //
@@ -50,6 +71,12 @@
 //  Slicer slicer(M, options);
 //  slicer.buildDG(true /* compute dependencies */);
 //
+//  To get several slices from one computation of dependencies,
+//  mark every set of criteria with a different slice id and
+//  store the marks using getMarks(). The marks can be then applied
+//  to a graph built (without dependencies) for a fresh copy
+//  of the module using applyMarks() and the copy can be sliced.
+//
 /// --------------------------------------------------------------------
 class Slicer {
     llvm::Module *M{};
@@ -63,6 +90,67 @@ class Slicer {
     const uint32_t _default_slice_id = 0xdead;
     bool _computed_deps{false};
 
+    template <typename BlockPred, typename NodePred>
+    SliceMarks _getMarks(uint32_t sl_id, const BlockPred &isBlockMarked,
+                         const NodePred &isNodeMarked) const {
+        assert(_dg && "Must run buildDG() first");
+
+        SliceMarks marks;
+        marks.sliceId = sl_id;
+
+        const auto &CF = dg::getConstructedFunctions();
+        for (auto &F : *M) {
+            auto it = CF.find(&F);
+            if (it == CF.end())
+                continue;
+
+            const auto &blocks = it->second->getBlocks();
+            auto &fmarks = marks.functions[F.getName().str()];
+            for (auto &B : F) {
+                auto bit = blocks.find(&B);
+                fmarks.blocks.push_back(bit != blocks.end() &&
+                                        isBlockMarked(bit->second));
+                for (auto &I : B) {
+                    auto *node = it->second->getNode(&I);
+                    fmarks.instructions.push_back(node && isNodeMarked(node));
+                }
+            }
+        }
+
+        return marks;
+    }
+
+    // the position of the instruction in SliceMarks::FunctionMarks
+    static size_t _instructionIndex(const llvm::Instruction *I) {
+        size_t idx = 0;
+        for (const auto &B : *I->getParent()->getParent()) {
+            for (const auto &BI : B) {
+                if (&BI == I)
+                    return idx;
+                ++idx;
+            }
+        }
+        assert(false && "Instruction not found in its function");
+        abort();
+    }
+
+    void _reportControlDependenceOnDemand() const {
+        if (!_options.dgOptions.CDOnDemand)
+            return;
+
+        llvm::errs() << "[llvm-slicer] Control dependencies computed on "
+                     << "demand, skipped "
+                     << dg::LLVMDependenceGraph::
+                                getPendingControlDependenciesNum()
+                     << " of " << dg::getConstructedFunctions().size()
+                     << " functions\n";
+    }
+
+    void keepPreservedFunctions() {
+        for (const auto &funcName : _options.preservedFunctions)
+            slicer.keepFunctionUntouched(funcName.c_str());
+    }
+
   public:
     Slicer(llvm::Module *mod, const SlicerOptions &opts)
             : M(mod), _options(opts), _builder(mod, _options.dgOptions) {
@@ -113,6 +201,17 @@ class Slicer {
         llvm::errs()
                 << "[llvm-slicer] CPU time of control dependence analysis: "
                 << double(stats.cdaTime) / CLOCKS_PER_SEC << " s\n";
+        llvm::errs() << "[llvm-slicer] Wall time of pointer analysis: "
+                     << double(stats.ptaWallTime) / 1000000 << " s\n";
+        llvm::errs() << "[llvm-slicer] Wall time of data dependence analysis: "
+                     << double(stats.rdaWallTime) / 1000000 << " s\n";
+        llvm::errs()
+                << "[llvm-slicer] Wall time of control dependence analysis: "
+                << double(stats.cdaWallTime) / 1000000 << " s"
+                << " (waited " << double(stats.cdaWaitWallTime) / 1000000
+                << " s)\n";
+        llvm::errs() << "[llvm-slicer] Wall time of building the graph: "
+                     << double(stats.buildWallTime) / 1000000 << " s\n";
     }
 
     // Mark the nodes from the slice.
@@ -120,13 +219,26 @@ class Slicer {
     // but buildDG() must be called before.
     bool mark(std::set<dg::LLVMNode *> &criteria_nodes) {
         assert(_dg && "mark() called without the dependence graph built");
-        assert(!criteria_nodes.empty() && "Do not have slicing criteria");
-
-        dg::debug::TimeMeasure tm;
 
         // compute dependece edges
         computeDependencies();
 
+        return mark(criteria_nodes, _default_slice_id);
+    }
+
+    // Mark the nodes from the slice with the given slice id.
+    // The dependencies must be already computed. Marking the graph
+    // again with a different id overwrites the marks of the nodes
+    // that are in both slices, so the marks must be stored using
+    // getMarks() before that.
+    bool mark(std::set<dg::LLVMNode *> &criteria_nodes, uint32_t sl_id) {
+        assert(_dg && "mark() called without the dependence graph built");
+        assert(_computed_deps && "mark() called without dependencies");
+        assert(!criteria_nodes.empty() && "Do not have slicing criteria");
+        assert(sl_id != 0 && "Invalid slice id");
+
+        dg::debug::TimeMeasure tm;
+
         // unmark this set of nodes after marking the relevant ones.
         // Used to mimic the Weissers algorithm
         std::set<dg::LLVMNode *> unmark;
@@ -136,10 +248,9 @@ class Slicer {
 
         _dg->getCallSites(_options.additionalSlicingCriteria, &criteria_nodes);
 
-        for (const auto &funcName : _options.preservedFunctions)
-            slicer.keepFunctionUntouched(funcName.c_str());
+        keepPreservedFunctions();
 
-        slice_id = _default_slice_id;
+        slice_id = sl_id;
 
         tm.start();
         for (dg::LLVMNode *start : criteria_nodes)
@@ -153,7 +264,154 @@ class Slicer {
 
         tm.stop();
         tm.report("[llvm-slicer] Finding dependent nodes took");
+        _reportControlDependenceOnDemand();
+
+        return true;
+    }
+
+    // Get the instructions and blocks marked with the given slice id
+    SliceMarks getMarks(uint32_t sl_id) const {
+        return _getMarks(
+                sl_id,
+                [sl_id](const dg::LLVMBBlock *B) {
+                    return B->getSlice() == sl_id;
+                },
+                [sl_id](const dg::LLVMNode *n) {
+                    return n->getSlice() == sl_id;
+                });
+    }
+
+    // Get the marks for the slice that consists of the given nodes
+    SliceMarks getMarks(const std::vector<dg::LLVMNode *> &nodes,
+                        uint32_t sl_id) const {
+        std::unordered_set<const dg::LLVMNode *> inslice(nodes.begin(),
+                                                         nodes.end());
+        std::unordered_set<const dg::LLVMBBlock *> blocks;
+        for (const auto *n : nodes) {
+            if (const auto *B = n->getBBlock())
+                blocks.insert(B);
+        }
+
+        return _getMarks(
+                sl_id,
+                [&blocks](const dg::LLVMBBlock *B) {
+                    return blocks.count(B) > 0;
+                },
+                [&inslice](const dg::LLVMNode *n) {
+                    return inslice.count(n) > 0;
+                });
+    }
+
+    ///
+    // Compute the backward slices w.r.t. every set of criteria without
+    // marking the graph, using (at most) 'threads' threads. The slice
+    // for the i-th set gets the slice id i + 1. The dependencies must be
+    // already computed and the sets must not be empty.
+    std::vector<SliceMarks>
+    computeSlices(std::vector<std::set<dg::LLVMNode *>> criteria,
+                  unsigned threads) {
+        assert(_computed_deps && "computeSlices() called without dependencies");
+        assert(!_options.forwardSlicing && "Only backward slices supported");
+
+        dg::debug::TimeMeasure tm;
+        tm.start();
+
+        // the criteria nodes that are not going to be in the slices
+        std::vector<std::set<dg::LLVMNode *>> unmark(criteria.size());
+        for (size_t i = 0; i < criteria.size(); ++i) {
+            assert(!criteria[i].empty() && "Do not have slicing criteria");
+            if (_options.removeSlicingCriteria)
+                unmark[i] = criteria[i];
+            _dg->getCallSites(_options.additionalSlicingCriteria,
+                              &criteria[i]);
+        }
+
+        keepPreservedFunctions();
+
+        dg::SliceReachability<dg::LLVMNode> reachability(criteria);
+        auto slices = reachability.slices(criteria, threads);
+
+        std::vector<SliceMarks> marks;
+        marks.reserve(slices.size());
+        for (size_t i = 0; i < slices.size(); ++i) {
+            marks.push_back(
+                    getMarks(slices[i], static_cast<uint32_t>(i + 1)));
+            if (unmark[i].empty())
+                continue;
+
+            // unmark the criteria, but keep their blocks
+            auto &fmarks = marks.back().functions;
+            for (auto *nd : unmark[i]) {
+                auto *I = llvm::dyn_cast<llvm::Instruction>(nd->getValue());
+                if (!I)
+                    continue;
+                auto *F = I->getParent()->getParent();
+                auto it = fmarks.find(F->getName().str());
+                if (it != fmarks.end())
+                    it->second.instructions[_instructionIndex(I)] = false;
+            }
+        }
+
+        tm.stop();
+        tm.report("[llvm-slicer] Finding dependent nodes took");
+        _reportControlDependenceOnDemand();
+
+        return marks;
+    }
+
+    // Mark the instructions and blocks stored in 'marks' that were taken
+    // from a graph for the same module. Call slice() afterwards.
+    // Dependencies are not needed for this, buildDG() is enough.
+    bool applyMarks(const SliceMarks &marks) {
+        assert(_dg && "applyMarks() called without the dependence graph");
+        assert(marks.sliceId != 0 && "Invalid slice id");
+
+        keepPreservedFunctions();
+
+        const auto &CF = dg::getConstructedFunctions();
+        for (auto &F : *M) {
+            auto it = CF.find(&F);
+            if (it == CF.end())
+                continue;
+
+            auto mit = marks.functions.find(F.getName().str());
+            if (mit == marks.functions.end()) {
+                llvm::errs() << "[llvm-slicer] No marks for function "
+                             << F.getName() << "\n";
+                return false;
+            }
+
+            const auto &fmarks = mit->second;
+            const auto &blocks = it->second->getBlocks();
+            size_t bidx = 0, iidx = 0;
+            for (auto &B : F) {
+                if (bidx >= fmarks.blocks.size())
+                    return false;
+                if (fmarks.blocks[bidx++]) {
+                    auto bit = blocks.find(&B);
+                    if (bit == blocks.end())
+                        return false;
+                    bit->second->setSlice(marks.sliceId);
+                }
+
+                for (auto &I : B) {
+                    if (iidx >= fmarks.instructions.size())
+                        return false;
+                    if (fmarks.instructions[iidx++]) {
+                        auto *node = it->second->getNode(&I);
+                        if (!node)
+                            return false;
+                        node->setSlice(marks.sliceId);
+                    }
+                }
+            }
+
+            if (bidx != fmarks.blocks.size() ||
+                iidx != fmarks.instructions.size())
+                return false;
+        }
 
+        slice_id = marks.sliceId;
         return true;
     }
 
@@ -234,9 +492,13 @@ class Slicer {
 class ModuleWriter {
     const SlicerOptions &options;
     llvm::Module *M;
+    // overrides the name of the output file from options
+    std::string outputFile;
 
   public:
-    ModuleWriter(const SlicerOptions &o, llvm::Module *m) : options(o), M(m) {}
+    ModuleWriter(const SlicerOptions &o, llvm::Module *m,
+                 std::string outFile = "")
+            : options(o), M(m), outputFile(std::move(outFile)) {}
 
     int cleanAndSaveModule(bool should_verify_module = true) {
         // remove unneeded parts of the module
@@ -286,7 +548,9 @@ class ModuleWriter {
     bool writeModule() {
         // compose name if not given
         std::string fl;
-        if (!options.outputFile.empty()) {
+        if (!outputFile.empty()) {
+            fl = outputFile;
+        } else if (!options.outputFile.empty()) {
             fl = options.outputFile;
         } else {
             fl = options.inputFile;
@@ -321,15 +321,11 @@ static void dumpIr(LLVMControlDependenceAnalysis &cda) {
             const auto *info = ntscd->_getFunInfo(&f);
             if (info) {
                 for (auto *nd : *graph) {
-                    auto it = info->controlDependence.find(nd);
-                    if (it == info->controlDependence.end())
-                        continue;
-
-                    for (const auto *dep : it->second) {
+                    for (auto depid : info->controlDependence.get(nd)) {
                         // FIXME: for interproc CD this will not work as the
                         // nodes would be in a different graph
                         std::cout << " " << graph->getName() << "_"
-                                  << dep->getID() << " -> " << graph->getName()
+                                  << depid << " -> " << graph->getName()
                                   << "_" << nd->getID() << " [ color=red ]\n";
                     }
                 }
@@ -341,13 +337,9 @@ static void dumpIr(LLVMControlDependenceAnalysis &cda) {
             const auto *info = dod->_getFunInfo(&f);
             if (info) {
                 for (auto *nd : *graph) {
-                    auto it = info->controlDependence.find(nd);
-                    if (it == info->controlDependence.end())
-                        continue;
-
-                    for (const auto *dep : it->second) {
+                    for (auto depid : info->controlDependence.get(nd)) {
                         std::cout << " " << graph->getName() << "_"
-                                  << dep->getID() << " -> " << graph->getName()
+                                  << depid << " -> " << graph->getName()
                                   << "_" << nd->getID() << " [ color=red ]\n";
                     }
                 }
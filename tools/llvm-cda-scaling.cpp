@@ -0,0 +1,529 @@
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "dg/tools/llvm-slicer-opts.h"
+#include "dg/tools/llvm-slicer-utils.h"
+
+#include "dg/ControlDependence/ControlDependenceAnalysisOptions.h"
+#include "dg/util/debug.h"
+
+#include "ControlDependence/CDGraph.h"
+#include "ControlDependence/CDRelation.h"
+#include "ControlDependence/ControlClosure.h"
+#include "ControlDependence/DOD.h"
+#include "ControlDependence/DODNTSCD.h"
+#include "ControlDependence/NTSCD.h"
+
+using namespace dg;
+
+using CDAlgorithm = ControlDependenceAnalysisOptions::CDAlgorithm;
+
+llvm::cl::opt<bool> enable_debug(
+        "dbg", llvm::cl::desc("Enable debugging messages (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> regression(
+        "regression",
+        llvm::cl::desc("Do not benchmark, check that the algorithms that "
+                       "should compute the same dependencies agree on the "
+                       "generated graphs (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::list<std::string> families(
+        "families",
+        llvm::cl::desc("Families of graphs to generate: random, loops, "
+                       "irreducible, switch, infinite-loops (default=all)."),
+        llvm::cl::CommaSeparated, llvm::cl::cat(SlicingOpts));
+
+llvm::cl::list<unsigned>
+        sizes("sizes",
+              llvm::cl::desc("The numbers of nodes of the generated graphs "
+                             "(default=10,100,1000,10000,100000, and "
+                             "10,50,200 with -regression)."),
+              llvm::cl::CommaSeparated, llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> seeds(
+        "seeds",
+        llvm::cl::desc("The number of graphs of every family and size "
+                       "(default=1, and 5 with -regression)."),
+        llvm::cl::init(0), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> timeout(
+        "timeout",
+        llvm::cl::desc("Time limit for one run of an algorithm in seconds. "
+                       "An algorithm that runs out of time is not run on "
+                       "larger graphs (default=10)."),
+        llvm::cl::init(10), llvm::cl::cat(SlicingOpts));
+
+///
+// Generators of graphs. Every node has at most two successors
+// (DOD works only with such graphs). The generators create
+// pieces of the graph until the graph has at least n nodes.
+///
+using GeneratorT = std::function<void(CDGraph &, unsigned, std::mt19937 &)>;
+
+static void generateRandom(CDGraph &G, unsigned n, std::mt19937 &rng) {
+    std::vector<CDNode *> nodes;
+    nodes.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        nodes.push_back(&G.createNode());
+    }
+
+    std::uniform_int_distribution<unsigned> ids(0, n - 1);
+    unsigned edges = n + n / 2;
+    unsigned tries = 0;
+    while (edges > 0 && ++tries < 10 * n) {
+        auto *nd = nodes[ids(rng)];
+        if (nd->successors().size() > 1)
+            continue;
+        G.addNodeSuccessor(*nd, *nodes[ids(rng)]);
+        --edges;
+    }
+}
+
+// a loop whose body is a loop nested 'depth' times,
+// returns the header and the exit node of the loop
+static std::pair<CDNode *, CDNode *> createLoopNest(CDGraph &G,
+                                                    unsigned depth) {
+    auto &header = G.createNode();
+    CDNode *entry, *latch;
+    if (depth == 0) {
+        entry = latch = &G.createNode();
+    } else {
+        std::tie(entry, latch) = createLoopNest(G, depth - 1);
+    }
+    auto &exit = G.createNode();
+
+    G.addNodeSuccessor(header, *entry);
+    G.addNodeSuccessor(header, exit);
+    G.addNodeSuccessor(*latch, header);
+    return {&header, &exit};
+}
+
+static void generateLoops(CDGraph &G, unsigned n, std::mt19937 &rng) {
+    std::uniform_int_distribution<unsigned> depths(0, 8);
+    auto *last = &G.createNode();
+    while (G.size() < n) {
+        auto loop = createLoopNest(G, depths(rng));
+        G.addNodeSuccessor(*last, *loop.first);
+        last = loop.second;
+    }
+}
+
+static void generateIrreducible(CDGraph &G, unsigned n,
+                                std::mt19937 & /*unused*/) {
+    // a cycle x <-> y that can be entered in both x and y
+    auto *last = &G.createNode();
+    while (G.size() < n) {
+        auto &x = G.createNode();
+        auto &y = G.createNode();
+        auto &exit = G.createNode();
+        G.addNodeSuccessor(*last, x);
+        G.addNodeSuccessor(*last, y);
+        G.addNodeSuccessor(x, y);
+        G.addNodeSuccessor(x, exit);
+        G.addNodeSuccessor(y, x);
+        last = &exit;
+    }
+}
+
+static void generateSwitches(CDGraph &G, unsigned n, std::mt19937 &rng) {
+    std::uniform_int_distribution<unsigned> cases(8, 32);
+    auto *last = &G.createNode();
+    while (G.size() < n) {
+        auto &join = G.createNode();
+        for (unsigned i = cases(rng); i > 0; --i) {
+            auto &cmp = G.createNode();
+            auto &body = G.createNode();
+            G.addNodeSuccessor(*last, cmp);
+            G.addNodeSuccessor(cmp, body);
+            G.addNodeSuccessor(body, join);
+            last = &cmp;
+        }
+        // the default case
+        G.addNodeSuccessor(*last, join);
+        last = &join;
+    }
+}
+
+static void generateInfiniteLoops(CDGraph &G, unsigned n, std::mt19937 &rng) {
+    std::uniform_int_distribution<unsigned> percents(0, 99);
+    auto *last = &G.createNode();
+    while (G.size() < n) {
+        auto &next = G.createNode();
+        auto &header = G.createNode();
+        auto &body = G.createNode();
+        G.addNodeSuccessor(*last, next);
+        G.addNodeSuccessor(*last, header);
+        G.addNodeSuccessor(header, body);
+        G.addNodeSuccessor(body, header);
+        // most of the loops never terminate
+        if (percents(rng) < 25)
+            G.addNodeSuccessor(body, next);
+        last = &next;
+    }
+}
+
+static const std::vector<std::pair<std::string, GeneratorT>> generators = {
+        {"random", generateRandom},
+        {"loops", generateLoops},
+        {"irreducible", generateIrreducible},
+        {"switch", generateSwitches},
+        {"infinite-loops", generateInfiniteLoops},
+};
+
+static size_t edgesNum(CDGraph &G) {
+    size_t num = 0;
+    for (auto *nd : G) {
+        num += nd->successors().size();
+    }
+    return num;
+}
+
+///
+// Algorithms. The standard CD and the legacy NTSCD are computed
+// from LLVM functions, not from CDGraph, so they are not here.
+///
+struct Algorithm {
+    const char *name;
+    CDAlgorithm algorithm;
+    bool acyclicFastPath;
+};
+
+static const std::vector<Algorithm> algorithms = {
+        {"ntscd", CDAlgorithm::NTSCD, true},
+        {"ntscd-no-fast-path", CDAlgorithm::NTSCD, false},
+        {"ntscd2", CDAlgorithm::NTSCD2, true},
+        {"ntscd2-no-fast-path", CDAlgorithm::NTSCD2, false},
+        {"ntscd-ranganath", CDAlgorithm::NTSCD_RANGANATH, false},
+        {"ntscd-ranganath-orig", CDAlgorithm::NTSCD_RANGANATH_ORIG, false},
+        {"dod", CDAlgorithm::DOD, false},
+        {"dod-ranganath", CDAlgorithm::DOD_RANGANATH, false},
+        {"dod+ntscd", CDAlgorithm::DODNTSCD, false},
+        {"scc", CDAlgorithm::STRONG_CC, false},
+};
+
+// returns the number of computed dependencies
+// (or the size of the closure for strong control closure)
+static size_t runAlgorithm(const Algorithm &A, CDGraph &G) {
+    switch (A.algorithm) {
+    case CDAlgorithm::NTSCD:
+        return NTSCD().compute(G, A.acyclicFastPath).first.size();
+    case CDAlgorithm::NTSCD2:
+        return NTSCD2().compute(G, A.acyclicFastPath).first.size();
+    case CDAlgorithm::NTSCD_RANGANATH:
+        return NTSCDRanganath().compute(G).first.size();
+    case CDAlgorithm::NTSCD_RANGANATH_ORIG:
+        return NTSCDRanganath()
+                .compute(G, /* doFixpoint = */ false)
+                .first.size();
+    case CDAlgorithm::DOD:
+        return DOD().compute(G).first.size();
+    case CDAlgorithm::DOD_RANGANATH:
+        return DODRanganath().compute(G).first.size();
+    case CDAlgorithm::DODNTSCD:
+        return DODNTSCD().compute(G).first.size();
+    case CDAlgorithm::STRONG_CC: {
+        // the closure of the node in the middle of the graph,
+        // the same as LLVMControlDependenceAnalysis does
+        std::set<CDNode *> X{G.getNode(G.size() / 2 + 1)};
+        return StrongControlClosure().getClosure(G, X).size();
+    }
+    default:
+        assert(false && "Unsupported algorithm");
+        abort();
+    }
+}
+
+///
+// Running the algorithms in a child process, so that we can
+// measure the peak memory of the run and survive timeouts and crashes.
+///
+enum class Status { OK, TIMEOUT, CRASH, SKIPPED };
+
+static const char *statusName(Status s) {
+    switch (s) {
+    case Status::OK:
+        return "ok";
+    case Status::TIMEOUT:
+        return "timeout";
+    case Status::CRASH:
+        return "crash";
+    case Status::SKIPPED:
+        return "skipped";
+    }
+    return "unknown";
+}
+
+struct RunResult {
+    Status status{Status::SKIPPED};
+    double timeMs{0};
+    long peakMemKb{0};
+    size_t dependencies{0};
+};
+
+static long maxRSSKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// run 'fun' in a child process, the child writes 'RunResult'
+// to a pipe, or exits with the given exit code
+static RunResult runInChild(const std::function<size_t()> &fun) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        abort();
+    }
+
+    std::cout.flush();
+    auto pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        abort();
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        alarm(timeout);
+
+        RunResult result;
+        auto mem = maxRSSKb();
+        auto start = std::chrono::steady_clock::now();
+        result.dependencies = fun();
+        auto end = std::chrono::steady_clock::now();
+        result.timeMs =
+                std::chrono::duration<double, std::milli>(end - start).count();
+        result.peakMemKb = maxRSSKb() - mem;
+        result.status = Status::OK;
+
+        auto written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    RunResult result;
+    auto got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+
+    int wstatus;
+    waitpid(pid, &wstatus, 0);
+    if (WIFSIGNALED(wstatus)) {
+        result.status = WTERMSIG(wstatus) == SIGALRM ? Status::TIMEOUT
+                                                      : Status::CRASH;
+    } else if (got != sizeof(result) || WEXITSTATUS(wstatus) != 0) {
+        result.status = Status::CRASH;
+    }
+
+    return result;
+}
+
+static bool isSelected(const std::string &family) {
+    if (families.empty())
+        return true;
+    for (const auto &f : families) {
+        if (f == family)
+            return true;
+    }
+    return false;
+}
+
+static int benchmark(const std::vector<unsigned> &szs, unsigned num) {
+    std::cout << "family,seed,nodes,edges,algorithm,status,time_ms,peak_mem_"
+                 "kb,dependencies\n";
+
+    for (const auto &gen : generators) {
+        if (!isSelected(gen.first))
+            continue;
+
+        // algorithms that ran out of time or crashed
+        std::vector<bool> exhausted(algorithms.size(), false);
+        for (auto size : szs) {
+            for (unsigned seed = 0; seed < num; ++seed) {
+                CDGraph G(gen.first);
+                std::mt19937 rng(seed);
+                gen.second(G, size, rng);
+                auto edges = edgesNum(G);
+
+                for (size_t i = 0; i < algorithms.size(); ++i) {
+                    const auto &A = algorithms[i];
+                    RunResult result;
+                    if (!exhausted[i]) {
+                        result = runInChild(
+                                [&A, &G]() { return runAlgorithm(A, G); });
+                        exhausted[i] = result.status != Status::OK;
+                    }
+
+                    std::cout << gen.first << "," << seed << "," << G.size()
+                              << "," << edges << "," << A.name << ","
+                              << statusName(result.status) << ","
+                              << result.timeMs << "," << result.peakMemKb
+                              << "," << result.dependencies << "\n";
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+///
+// Regression checks
+///
+static bool checkEqual(const std::pair<CDRelation, CDRelation> &expected,
+                       const std::pair<CDRelation, CDRelation> &result,
+                       const char *name) {
+    if (expected.first != result.first || expected.second != result.second) {
+        std::cerr << "  " << name << " differs from ntscd2\n";
+        return false;
+    }
+    return true;
+}
+
+// check that 'rev' is the reverse relation of 'rel'
+static bool checkReverse(CDGraph &G, const CDRelation &rel,
+                         const CDRelation &rev, const char *name) {
+    for (auto *nd : G) {
+        for (auto id : rel.get(nd)) {
+            if (!rev.has(G.getNode(id), nd)) {
+                std::cerr << "  " << name << ": the reverse dependencies "
+                          << "miss " << id << " -> " << nd->getID() << "\n";
+                return false;
+            }
+        }
+    }
+    if (rel.size() != rev.size()) {
+        std::cerr << "  " << name << ": the reverse dependencies "
+                  << "have extra elements\n";
+        return false;
+    }
+    return true;
+}
+
+// returns 0 if all the checks passed
+static size_t checkGraph(CDGraph &G) {
+    bool ok = true;
+    auto ntscd2 = NTSCD2().compute(G);
+    ok &= checkReverse(G, ntscd2.first, ntscd2.second, "ntscd2");
+
+    // all the NTSCD algorithms must compute the same relation
+    ok &= checkEqual(ntscd2, NTSCD2().compute(G, false),
+                     "ntscd2-no-fast-path");
+    ok &= checkEqual(ntscd2, NTSCD().compute(G), "ntscd");
+    ok &= checkEqual(ntscd2, NTSCD().compute(G, false), "ntscd-no-fast-path");
+    ok &= checkEqual(ntscd2, NTSCDRanganath().compute(G), "ntscd-ranganath");
+
+    // DOD + NTSCD must be the union of DOD and NTSCD
+    auto dod = DOD().compute(G);
+    auto dodntscd = DODNTSCD().compute(G);
+    for (auto *nd : G) {
+        for (auto id : dodntscd.first.get(nd)) {
+            if (!ntscd2.first.get(nd).get(id) && !dod.first.get(nd).get(id)) {
+                std::cerr << "  dod+ntscd has an extra dependence " << id
+                          << " -> " << nd->getID() << "\n";
+                ok = false;
+            }
+        }
+        for (auto id : ntscd2.first.get(nd)) {
+            if (!dodntscd.first.get(nd).get(id)) {
+                std::cerr << "  dod+ntscd misses NTSCD " << id << " -> "
+                          << nd->getID() << "\n";
+                ok = false;
+            }
+        }
+        for (auto id : dod.first.get(nd)) {
+            if (!dodntscd.first.get(nd).get(id)) {
+                std::cerr << "  dod+ntscd misses DOD " << id << " -> "
+                          << nd->getID() << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
+
+static int checkRegressions(const std::vector<unsigned> &szs, unsigned num) {
+    unsigned failed = 0;
+    unsigned checked = 0;
+    for (const auto &gen : generators) {
+        if (!isSelected(gen.first))
+            continue;
+
+        for (auto size : szs) {
+            for (unsigned seed = 0; seed < num; ++seed) {
+                CDGraph G(gen.first);
+                std::mt19937 rng(seed);
+                gen.second(G, size, rng);
+
+                ++checked;
+                // the checks return the number of failures
+                // as the number of dependencies
+                auto result = runInChild([&G]() { return checkGraph(G); });
+                if (result.status != Status::OK || result.dependencies != 0) {
+                    std::cerr << "FAILED: " << gen.first << " with "
+                              << G.size() << " nodes (seed " << seed
+                              << "): "
+                              << (result.status == Status::OK
+                                          ? "results differ"
+                                          : statusName(result.status))
+                              << "\n";
+                    ++failed;
+                }
+            }
+        }
+    }
+
+    std::cout << "Checked " << checked << " graphs, " << failed
+              << " failed\n";
+    return failed > 0 ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    setupStackTraceOnError(argc, argv);
+    parseSlicerOptions(argc, argv,
+                       /* requireCrit = */ false,
+                       /* inputFileRequired = */ false);
+    if (enable_debug) {
+        DBG_ENABLE();
+    }
+
+    for (const auto &f : families) {
+        bool found = false;
+        for (const auto &gen : generators) {
+            found |= gen.first == f;
+        }
+        if (!found) {
+            llvm::errs() << "Unknown family of graphs: " << f << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<unsigned> szs(sizes.begin(), sizes.end());
+    if (regression) {
+        if (szs.empty())
+            szs = {10, 50, 200};
+        return checkRegressions(szs, seeds > 0 ? seeds : 5);
+    }
+
+    if (szs.empty())
+        szs = {10, 100, 1000, 10000, 100000};
+    return benchmark(szs, seeds > 0 ? seeds : 1);
+}
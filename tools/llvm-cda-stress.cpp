@@ -95,6 +95,13 @@ llvm::cl::opt<unsigned>
         En("edges", llvm::cl::desc("The number of edges (default=1.5*nodes)."),
            llvm::cl::init(0), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<unsigned> backEdgesPerc(
+        "back-edges",
+        llvm::cl::desc("The percentage of edges that can go to a node with "
+                       "a lower ID, the rest goes to nodes with higher IDs "
+                       "(default=100, i.e., random edges)."),
+        llvm::cl::init(100), llvm::cl::cat(SlicingOpts));
+
 void generateRandomGraph(CDGraph &G, unsigned Vnum = 100, unsigned Enum = 0) {
     if (Enum == 0 || Enum > 2 * Vnum)
         Enum = Vnum;
@@ -118,12 +125,34 @@ void generateRandomGraph(CDGraph &G, unsigned Vnum = 100, unsigned Enum = 0) {
         if (nodes[id1]->successors().size() > 1)
             continue;
         auto id2 = ids(rng);
+        if (id2 < id1 && rng() % 100 >= backEdgesPerc) {
+            std::swap(id1, id2);
+            if (nodes[id1]->successors().size() > 1)
+                continue;
+        }
         G.addNodeSuccessor(*nodes[id1], *nodes[id2]);
         // std::cout << id1 << " -> " << id2 << "\n";
         --Enum;
     }
 }
 
+// compare the results of NTSCD computed with and without
+// the fast path for the acyclic part of the graph
+template <typename NTSCDT>
+bool compareAcyclicFastPath(CDGraph &G, const char *name) {
+    NTSCDT fast;
+    NTSCDT full;
+    auto fastres = fast.compute(G, /* acyclicFastPath = */ true);
+    auto fullres = full.compute(G, /* acyclicFastPath = */ false);
+    if (fastres.first != fullres.first || fastres.second != fullres.second) {
+        llvm::errs() << name
+                     << ": the results with and without the acyclic fast "
+                        "path differ\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
     SlicerOptions options = parseSlicerOptions(argc, argv,
@@ -139,6 +168,7 @@ int main(int argc, char *argv[]) {
     generateRandomGraph(G, Vn, En);
 
     clock_t start, end, elapsed;
+    int ret = 0;
 
     if (ntscd) {
         dg::NTSCD ntscd;
@@ -149,6 +179,9 @@ int main(int argc, char *argv[]) {
 
         std::cout << "ntscd: " << static_cast<float>(elapsed) / CLOCKS_PER_SEC
                   << " s (" << elapsed << " ticks)\n";
+
+        if (compare && !compareAcyclicFastPath<dg::NTSCD>(G, "ntscd"))
+            ret = 1;
     }
     if (ntscd2) {
         dg::NTSCD2 ntscd;
@@ -159,6 +192,9 @@ int main(int argc, char *argv[]) {
 
         std::cout << "ntscd: " << static_cast<float>(elapsed) / CLOCKS_PER_SEC
                   << " s (" << elapsed << " ticks)\n";
+
+        if (compare && !compareAcyclicFastPath<dg::NTSCD2>(G, "ntscd2"))
+            ret = 1;
     }
     if (ntscd_ranganath) {
         dg::NTSCDRanganath ntscd;
@@ -218,5 +254,5 @@ int main(int argc, char *argv[]) {
    opts), 0);
     }
     */
-    return 0;
+    return ret;
 }
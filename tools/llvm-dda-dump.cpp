@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <fstream>
@@ -6,6 +8,8 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
@@ -57,6 +61,18 @@ llvm::cl::opt<bool>
 llvm::cl::opt<bool> quiet("q", llvm::cl::desc("No output (for benchmarking)."),
                           llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> stats("statistics",
+                          llvm::cl::desc("Dump statistics (default=false)."),
+                          llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> dda_profile(
+        "dda-profile",
+        llvm::cl::desc("Collect counters and timers of the data dependence "
+                       "analysis for every function and dump them in JSON "
+                       "into the given file."),
+        llvm::cl::value_desc("file"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<bool> dump_c_lines(
         "c-lines",
         llvm::cl::desc("Dump output as C lines (line:column where possible)."
@@ -649,6 +665,12 @@ static void dumpDefs(LLVMDataDependenceAnalysis *DDA, bool todot) {
         if (!graph_only)
             SSA->computeAllDefinitions();
 
+        if (stats) {
+            printf("Created phi nodes: %zu\n", SSA->getNumOfCreatedPhis());
+            printf("Removed trivial phi nodes: %zu\n",
+                   SSA->getNumOfRemovedPhis());
+        }
+
         if (quiet)
             return;
 
@@ -660,6 +682,91 @@ static void dumpDefs(LLVMDataDependenceAnalysis *DDA, bool todot) {
     }
 }
 
+static std::string jsonEscape(const std::string &str) {
+    std::string ret;
+    for (char c : str) {
+        switch (c) {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\b':
+            ret += "\\b";
+            break;
+        case '\f':
+            ret += "\\f";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        case '\r':
+            ret += "\\r";
+            break;
+        case '\t':
+            ret += "\\t";
+            break;
+        default:
+            // the other control characters must be escaped too
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[7];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                ret += buf;
+            } else {
+                ret += c;
+            }
+        }
+    }
+    return ret;
+}
+
+static bool dumpProfile(LLVMDataDependenceAnalysis *DDA,
+                        const std::string &file) {
+    std::ofstream out(file);
+    if (!out.is_open()) {
+        llvm::errs() << "Failed opening the file for the profile: " << file
+                     << "\n";
+        return false;
+    }
+
+    auto *SSA = static_cast<MemorySSATransformation *>(DDA->getDDA()->getImpl());
+
+    // the most expensive subgraphs first
+    std::vector<std::pair<RWSubgraph *, const MemorySSATransformation::Profile *>>
+            profiles;
+    for (auto *subg : DDA->getGraph()->subgraphs()) {
+        if (const auto *profile = SSA->getProfile(subg))
+            profiles.emplace_back(subg, profile);
+    }
+    std::stable_sort(profiles.begin(), profiles.end(),
+                     [](const decltype(profiles)::value_type &a,
+                        const decltype(profiles)::value_type &b) {
+                         return a.second->time > b.second->time;
+                     });
+
+    out << "{\n  \"subgraphs\": [";
+    bool first = true;
+    for (const auto &it : profiles) {
+        const auto *profile = it.second;
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "    {\"name\": \"" << jsonEscape(it.first->getName()) << "\", "
+            << "\"blocks\": " << it.first->size() << ", "
+            << "\"queries\": " << profile->queries << ", "
+            << "\"lvn_scans\": " << profile->lvnScans << ", "
+            << "\"phis\": " << profile->phis << ", "
+            << "\"descents\": " << profile->descents << ", "
+            << "\"caller_searches\": " << profile->callerSearches << ", "
+            << "\"max_definitions\": " << profile->maxDefinitions << ", "
+            << "\"time_ms\": "
+            << std::chrono::duration<double, std::milli>(profile->time).count()
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+    return true;
+}
+
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
     SlicerOptions options = parseSlicerOptions(argc, argv);
@@ -690,6 +797,9 @@ int main(int argc, char *argv[]) {
     tm.stop();
     tm.report("INFO: Pointer analysis took");
 
+    if (!dda_profile.empty())
+        options.dgOptions.DDAOptions.profile = true;
+
     tm.start();
     LLVMDataDependenceAnalysis DDA(M.get(), &PTA, options.dgOptions.DDAOptions);
     if (graph_only) {
@@ -715,5 +825,9 @@ int main(int argc, char *argv[]) {
 
     dumpDefs(&DDA, todot);
 
+    if (!dda_profile.empty() && DDA.getOptions().isSSA() &&
+        !dumpProfile(&DDA, dda_profile))
+        return 1;
+
     return 0;
 }
@@ -136,6 +136,9 @@ int main(int argc, char *argv[]) {
     if (!M)
         return 1;
 
+    // we dump the whole graph, so compute all the control dependencies
+    options.dgOptions.CDOnDemand = false;
+
     llvmdg::LLVMDependenceGraphBuilder builder(M.get(), options.dgOptions);
     auto dg = builder.build();
 
@@ -607,6 +607,9 @@ static void dumpPointerGraph(DGLLVMPointerAnalysis *pta, PTType type) {
 static void dumpStats(DGLLVMPointerAnalysis *pta) {
     const auto &nodes = pta->getNodes();
     printf("Pointer subgraph size: %zu\n", nodes.size() - 1);
+    if (pta->getPTA())
+        printf("Nodes collapsed on cycles: %u\n",
+               pta->getPTA()->getNumOfCollapsedNodes());
 
     size_t nonempty_size = 0; // number of nodes with non-empty pt-set
     size_t maximum = 0;       // maximum pt-set size
@@ -143,6 +143,38 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                            "is per basic block)\n"),
             llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> cdaThreads(
+            "cda-threads",
+            llvm::cl::desc("Compute intraprocedural control dependencies of "
+                           "different\n"
+                           "functions in parallel using N threads "
+                           "(default=1).\n"),
+            llvm::cl::value_desc("N"), llvm::cl::init(1),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> pipelineAnalyses(
+            "pipeline-analyses",
+            llvm::cl::desc("Compute control dependencies concurrently with\n"
+                           "pointer and data dependence analysis if the "
+                           "selected\n"
+                           "control dependence analysis allows it "
+                           "(default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> cdaOnDemand(
+            "cda-on-demand",
+            llvm::cl::desc("Compute control dependencies of a function only\n"
+                           "when the slice reaches the function. Supported\n"
+                           "for standard CD and NTSCD (default=true).\n"),
+            llvm::cl::init(true), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> freezeDG(
+            "freeze-dg",
+            llvm::cl::desc("Store the edges of the dependence graph into\n"
+                           "compact arrays once the dependencies are\n"
+                           "computed (default=true).\n"),
+            llvm::cl::init(true), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<bool> icfgCD(
             "cda-icfg",
             llvm::cl::desc(
@@ -246,6 +278,28 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
             llvm::cl::init(LLVMPointerAnalysisOptions::AnalysisType::fi),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<bool> ptaDiffPropagation(
+            "pta-diff-propagation",
+            llvm::cl::desc("Solve the flow-insensitive PTA using a worklist\n"
+                           "that propagates only newly added pointers\n"
+                           "(default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaCollapseCycles(
+            "pta-collapse-cycles",
+            llvm::cl::desc("Collapse cycles of copy edges in the pointer\n"
+                           "graph during solving. Has an effect only with\n"
+                           "-pta-diff-propagation (default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> ptaCache(
+            "pta-cache",
+            llvm::cl::desc("Store the results of pointer analysis into DIR\n"
+                           "and reuse them when the same module is analyzed\n"
+                           "again with the same options (default=\"\").\n"),
+            llvm::cl::value_desc("DIR"), llvm::cl::init(""),
+            llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMDataDependenceAnalysisOptions::AnalysisType> ddaType(
             "dda", llvm::cl::desc("Choose data dependence analysis to use:"),
             llvm::cl::values(
@@ -262,6 +316,15 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     LLVMDataDependenceAnalysisOptions::AnalysisType::ssa),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> ddaThreads(
+            "dda-threads",
+            llvm::cl::desc("Compute data dependencies of all instructions at "
+                           "once\n"
+                           "using N threads (default=1, compute them on "
+                           "demand).\n"),
+            llvm::cl::value_desc("N"), llvm::cl::init(1),
+            llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<dg::ControlDependenceAnalysisOptions::CDAlgorithm>
             cdAlgorithm(
                     "cda",
@@ -408,23 +471,31 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     dgOptions.entryFunction = entryFunction;
     dgOptions.preserveDbg = preserveDbg;
     dgOptions.threads = threads;
+    dgOptions.pipelined = pipelineAnalyses;
+    dgOptions.CDOnDemand = cdaOnDemand;
+    dgOptions.freezeEdges = freezeDG;
 
     CDAOptions.algorithm = cdAlgorithm;
     CDAOptions.interprocedural = interprocCd;
     CDAOptions._icfg = icfgCD;
     CDAOptions.setNodePerInstruction(cdaPerInstr);
+    CDAOptions.setCDAThreads(cdaThreads);
 
     addAllocationFuns(dgOptions, allocationFuns);
 
     PTAOptions.entryFunction = entryFunction;
     PTAOptions.fieldSensitivity = dg::Offset(ptaFieldSensitivity);
     PTAOptions.analysisType = ptaType;
+    PTAOptions.diffPropagation = ptaDiffPropagation;
+    PTAOptions.collapseCycles = ptaCollapseCycles;
+    PTAOptions.cacheDir = ptaCache;
     PTAOptions.threads = threads;
 
     DDAOptions.threads = threads;
     DDAOptions.entryFunction = entryFunction;
     DDAOptions.undefinedFunsBehavior = undefinedFunsBehavior;
     DDAOptions.analysisType = ddaType;
+    DDAOptions.ddaThreads = ddaThreads;
 
     return options;
 }
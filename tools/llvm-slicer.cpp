@@ -1,6 +1,7 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -63,6 +64,23 @@ llvm::cl::opt<bool> dump_bb_only(
                        " (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<std::string> batch_criteria(
+        "batch-criteria",
+        llvm::cl::desc("Slice the module w.r.t. every line of the file\n"
+                       "separately. A line is a slicing criterion in the\n"
+                       "format of -sc. The dependencies are computed only\n"
+                       "once for all the lines and the slice for the i-th\n"
+                       "line is saved to the output file with suffix .i"),
+        llvm::cl::value_desc("file"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> batch_threads(
+        "batch-threads",
+        llvm::cl::desc("Compute the slices in batch mode in parallel\n"
+                       "using N threads (default=1)."),
+        llvm::cl::value_desc("N"), llvm::cl::init(1),
+        llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<std::string> annotationOpts(
         "annotate",
         llvm::cl::desc(
@@ -133,6 +151,168 @@ static AnnotationOptsT parseAnnotationOptions(const std::string &annot) {
     return opts;
 }
 
+static std::vector<std::string> readCriteriaSets(const std::string &file) {
+    std::vector<std::string> sets;
+    std::ifstream ifs(file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        auto b = line.find_first_not_of(" \t\r");
+        if (b == std::string::npos)
+            continue;
+        auto e = line.find_last_not_of(" \t\r");
+        sets.push_back(line.substr(b, e - b + 1));
+    }
+    return sets;
+}
+
+static std::string batchOutputFile(const SlicerOptions &options, size_t idx) {
+    std::string fl = options.outputFile;
+    if (fl.empty()) {
+        fl = options.inputFile;
+        replace_suffix(fl, ".sliced");
+    }
+    return fl + "." + std::to_string(idx + 1);
+}
+
+// Slice a fresh copy of the input module according to the marks
+// taken from the graph for the original module. Without marks
+// (no reachable slicing criteria), create an empty main.
+static int sliceCopy(const SlicerOptions &options, const SliceMarks *marks,
+                     const std::string &outputFile) {
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> M =
+            parseModule("llvm-slicer", context, options);
+    if (!M)
+        return 1;
+
+    ModuleWriter writer(options, M.get(), outputFile);
+    writer.removeUnusedFromModule();
+
+    ::Slicer slicer(M.get(), options);
+    if (!marks) {
+        if (!slicer.createEmptyMain()) {
+            llvm::errs() << "ERROR: failed creating an empty main\n";
+            return 1;
+        }
+
+        maybe_print_statistics(M.get(), "Statistics after ");
+        return writer.cleanAndSaveModule(should_verify_module);
+    }
+
+    if (!slicer.buildDG()) {
+        errs() << "ERROR: Failed building DG\n";
+        return 1;
+    }
+
+    if (!slicer.applyMarks(*marks)) {
+        errs() << "ERROR: The marks do not match the copy of the module\n";
+        return 1;
+    }
+
+    if (!slicer.slice()) {
+        errs() << "ERROR: Slicing failed\n";
+        return 1;
+    }
+
+    maybe_print_statistics(M.get(), "Statistics after ");
+    return writer.cleanAndSaveModule(should_verify_module);
+}
+
+///
+// Slice the module w.r.t. every set of criteria from the batch file.
+// The dependencies are computed only once and the slices for all sets
+// are computed (concurrently) on that graph. The module itself is sliced
+// w.r.t. the last set. For the other sets, we keep the marks and replay
+// them on a graph built for a fresh copy of the module that is sliced then
+// (building the graph without dependencies is cheap, only the pointer
+// analysis runs again which can be avoided by using -pta-cache).
+static int sliceBatch(const SlicerOptions &options,
+                      std::unique_ptr<llvm::Module> &M) {
+    auto sets = readCriteriaSets(batch_criteria);
+    if (sets.empty()) {
+        llvm::errs() << "No slicing criteria in '" << batch_criteria
+                     << "'\n";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<SliceMarks>> marks(sets.size());
+    size_t copies = sets.size();
+    int ret = 0;
+
+    {
+        ::Slicer slicer(M.get(), options);
+        if (!slicer.buildDG(/* compute_deps = */ true)) {
+            errs() << "ERROR: Failed building DG\n";
+            return 1;
+        }
+
+        // the sets without reachable criteria get an empty main
+        std::vector<std::set<LLVMNode *>> criteria;
+        std::vector<size_t> criteriaSet;
+        for (size_t i = 0; i < sets.size(); ++i) {
+            std::set<LLVMNode *> criteria_nodes;
+            if (!getSlicingCriteriaNodes(
+                        slicer.getDG(), sets[i], options.legacySlicingCriteria,
+                        options.legacySecondarySlicingCriteria, criteria_nodes,
+                        options.criteriaAreNextInstr)) {
+                llvm::errs() << "ERROR: Failed finding slicing criteria: '"
+                             << sets[i] << "'\n";
+                return 1;
+            }
+
+            if (criteria_nodes.empty()) {
+                llvm::errs() << "No reachable slicing criteria: '" << sets[i]
+                             << "'\n";
+                continue;
+            }
+
+            criteria.push_back(std::move(criteria_nodes));
+            criteriaSet.push_back(i);
+        }
+
+        if (options.forwardSlicing) {
+            // forward slices need marking the graph, do them one by one
+            for (size_t j = 0; j < criteria.size(); ++j) {
+                const auto sl_id = static_cast<uint32_t>(j + 1);
+                if (!slicer.mark(criteria[j], sl_id)) {
+                    llvm::errs() << "Finding dependent nodes failed\n";
+                    return 1;
+                }
+                marks[criteriaSet[j]].reset(
+                        new SliceMarks(slicer.getMarks(sl_id)));
+            }
+        } else if (!criteria.empty()) {
+            auto slices = slicer.computeSlices(std::move(criteria),
+                                               batch_threads);
+            for (size_t j = 0; j < slices.size(); ++j)
+                marks[criteriaSet[j]].reset(
+                        new SliceMarks(std::move(slices[j])));
+        }
+
+        // slice the module itself w.r.t. the last set
+        if (marks.back()) {
+            copies = sets.size() - 1;
+            if (!slicer.applyMarks(*marks.back()) || !slicer.slice()) {
+                errs() << "ERROR: Slicing failed\n";
+                return 1;
+            }
+
+            maybe_print_statistics(M.get(), "Statistics after ");
+            ModuleWriter writer(options, M.get(),
+                                batchOutputFile(options, copies));
+            ret |= writer.cleanAndSaveModule(should_verify_module);
+        }
+    }
+
+    // we do not need the original module anymore
+    M.reset();
+
+    for (size_t i = 0; i < copies; ++i)
+        ret |= sliceCopy(options, marks[i].get(), batchOutputFile(options, i));
+
+    return ret;
+}
+
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
 
@@ -145,7 +325,32 @@ int main(int argc, char *argv[]) {
 #endif
 
     SlicerOptions options = parseSlicerOptions(argc, argv,
-                                               /* requireCrit = */ true);
+                                               /* requireCrit = */ false);
+    // the slicer queries only the definitions of uses, so it does not need
+    // the nodes that write only the memory that is never read
+    options.dgOptions.DDAOptions.removeUselessNodes = true;
+
+    if (batch_criteria.empty() && options.slicingCriteria.empty() &&
+        options.legacySlicingCriteria.empty()) {
+        llvm::errs() << "No slicing criteria specified (-sc, -c or "
+                        "-batch-criteria option)\n";
+        return 1;
+    }
+
+    // the lines of the batch file take the place of -sc
+    if (!batch_criteria.empty() && !options.slicingCriteria.empty()) {
+        llvm::errs() << "The -sc option cannot be used with -batch-criteria, "
+                        "put the criteria into the lines of the file\n";
+        return 1;
+    }
+
+    // the graph is dumped and annotated w.r.t. one slice
+    if (!batch_criteria.empty() &&
+        (dump_dg || dump_dg_only || !annotationOpts.empty())) {
+        llvm::errs() << "The -dump-dg, -dump-dg-only and -annotate options "
+                        "cannot be used with -batch-criteria\n";
+        return 1;
+    }
 
     if (enable_debug) {
         DBG_ENABLE();
@@ -156,6 +361,12 @@ int main(int argc, char *argv[]) {
         dump_dg = true;
     }
 
+    // the dumped graph and the annotations should show
+    // all the control dependencies, not only those in the slice
+    if (dump_dg || !annotationOpts.empty()) {
+        options.dgOptions.CDOnDemand = false;
+    }
+
     llvm::LLVMContext context;
     std::unique_ptr<llvm::Module> M =
             parseModule("llvm-slicer", context, options);
@@ -183,6 +394,16 @@ int main(int argc, char *argv[]) {
     /// ---------------
     // slice the code
     /// ---------------
+    if (!batch_criteria.empty()) {
+        if (options.cutoffDiverging) {
+            llvm::errs() << "[llvm-slicer] slicing in batch mode, not cutting "
+                            "off diverging\n";
+            options.cutoffDiverging = false;
+        }
+
+        return sliceBatch(options, M);
+    }
+
     if (options.cutoffDiverging && options.dgOptions.threads) {
         llvm::errs() << "[llvm-slicer] threads are enabled, not cutting off "
                         "diverging\n";